@@ -51,6 +51,8 @@ SimulationMaster::SimulationMaster(hemelb::configuration::CommandLine & options,
   neighbouringDataManager = NULL;
   imagesPerSimulation = options.NumberOfImages();
   steeringSessionId = options.GetSteeringSessionId();
+  collisionCostsFile = options.GetCollisionCostsFile();
+  calibrationFile = options.GetCalibrationFile();
 
   fileManager = new hemelb::io::PathManager(options, IsCurrentProcTheIOProc(), GetProcessorCount());
   simConfig = hemelb::configuration::SimConfig::New(fileManager->GetInputFile());
@@ -147,9 +149,18 @@ void SimulationMaster::Initialise()
   // Use a reader to read in the file.
   hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Loading file and decomposing geometry.");
 
+  hemelb::geometry::decomposition::CollisionCosts collisionCosts;
+  if (!collisionCostsFile.empty())
+  {
+    hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Weighting the decomposition by the collision costs in %s.",
+                                                                        collisionCostsFile.c_str());
+    collisionCosts = hemelb::geometry::decomposition::CollisionCosts::Read(collisionCostsFile);
+  }
+
   hemelb::geometry::GeometryReader reader(hemelb::steering::SteeringComponent::RequiresSeparateSteeringCore(),
                                           latticeType::GetLatticeInfo(),
-                                          timings, ioComms);
+                                          timings, ioComms,
+                                          collisionCostsFile.empty() ? NULL : &collisionCosts);
   hemelb::geometry::Geometry readGeometryData =
       reader.LoadAndDecompose(simConfig->GetDataFilePath());
 
@@ -161,7 +172,8 @@ void SimulationMaster::Initialise()
   neighbouringDataManager =
       new hemelb::geometry::neighbouring::NeighbouringDataManager(*latticeData,
                                                                   latticeData->GetNeighbouringData(),
-                                                                  communicationNet);
+                                                                  communicationNet,
+                                                                  true);
   hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Initialising LBM.");
   latticeBoltzmannModel = new hemelb::lb::LBM<latticeType>(simConfig,
                                                            &communicationNet,
@@ -209,21 +221,23 @@ void SimulationMaster::Initialise()
     network = NULL;
   }
 
-  stabilityTester = new hemelb::lb::StabilityTester<latticeType>(latticeData,
-                                                                 &communicationNet,
-                                                                 simulationState,
-                                                                 timings,
-                                                                 monitoringConfig);
+  stabilityTester =
+      new hemelb::lb::StabilityTester<latticeType, monitoringBroadcastType>(latticeData,
+                                                                           &communicationNet,
+                                                                           simulationState,
+                                                                           latticeBoltzmannModel->GetPropertyCache(),
+                                                                           timings,
+                                                                           monitoringConfig);
   entropyTester = NULL;
 
   if (monitoringConfig->doIncompressibilityCheck)
   {
-    incompressibilityChecker = new hemelb::lb::IncompressibilityChecker<
-        hemelb::net::PhasedBroadcastRegular<> >(latticeData,
-                                                &communicationNet,
-                                                simulationState,
-                                                latticeBoltzmannModel->GetPropertyCache(),
-                                                timings);
+    incompressibilityChecker =
+        new hemelb::lb::IncompressibilityChecker<monitoringBroadcastType>(latticeData,
+                                                                          &communicationNet,
+                                                                          simulationState,
+                                                                          latticeBoltzmannModel->GetPropertyCache(),
+                                                                          timings);
   }
   else
   {
@@ -268,6 +282,10 @@ void SimulationMaster::Initialise()
                                                         *unitConverter);
 
   latticeBoltzmannModel->Initialise(visualisationControl, inletValues, outletValues, unitConverter);
+  if (!calibrationFile.empty())
+  {
+    latticeBoltzmannModel->TimeCollisions();
+  }
   latticeBoltzmannModel->SetInitialConditions(ioComms);
   neighbouringDataManager->ShareNeeds();
   neighbouringDataManager->TransferNonFieldDependentInformation();
@@ -473,6 +491,23 @@ void SimulationMaster::Finalise()
   hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::OnePerCore>("sync points: %lld, bytes sent: %lld",
                                                                         communicationNet.SyncPointsCounted,
                                                                         communicationNet.BytesSent);
+  latticeBoltzmannModel->LogCollisionRangeTimes();
+
+  if (!calibrationFile.empty())
+  {
+    // Total the time and sites of each collision type over all ranks, to get its cost.
+    std::vector<double> seconds;
+    std::vector<hemelb::site_t> sites;
+    latticeBoltzmannModel->GetCollisionTimes(seconds, sites);
+    seconds = ioComms.Reduce(seconds, MPI_SUM, ioComms.GetIORank());
+    sites = ioComms.Reduce(sites, MPI_SUM, ioComms.GetIORank());
+    if (IsCurrentProcTheIOProc())
+    {
+      hemelb::geometry::decomposition::CollisionCosts::FromTimes(seconds, sites).Write(calibrationFile);
+      hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Wrote the measured collision costs to %s.",
+                                                                          calibrationFile.c_str());
+    }
+  }
 
   hemelb::log::Logger::Log<hemelb::log::Info, hemelb::log::Singleton>("Finish running simulation.");
 }
@@ -53,6 +53,12 @@ class SimulationMaster
     /* The next quantities are protected because they are used by MultiscaleSimulationMaster */
     // Set the lattice type via a build parameter
     typedef hemelb::lb::lattices:: HEMELB_LATTICE latticeType;
+    // How the monitoring actors combine their values across processes
+#ifdef HEMELB_USE_COLLECTIVE_MONITORING
+    typedef hemelb::net::CollectiveBroadcast monitoringBroadcastType;
+#else
+    typedef hemelb::net::PhasedBroadcastRegular<> monitoringBroadcastType;
+#endif
     hemelb::geometry::LatticeData* latticeData;
     hemelb::lb::LBM<latticeType>* latticeBoltzmannModel;
     hemelb::geometry::neighbouring::NeighbouringDataManager *neighbouringDataManager;
@@ -95,10 +101,10 @@ class SimulationMaster
 
     /** Struct containing the configuration of various checkers/testers */
     const hemelb::configuration::SimConfig::MonitoringConfig* monitoringConfig;
-    hemelb::lb::StabilityTester<latticeType>* stabilityTester;
+    hemelb::lb::StabilityTester<latticeType, monitoringBroadcastType>* stabilityTester;
     hemelb::lb::EntropyTester<latticeType>* entropyTester;
     /** Actor in charge of checking the maximum density difference across the domain */
-    hemelb::lb::IncompressibilityChecker<hemelb::net::PhasedBroadcastRegular<> >* incompressibilityChecker;
+    hemelb::lb::IncompressibilityChecker<monitoringBroadcastType>* incompressibilityChecker;
 
     hemelb::colloids::ColloidController* colloidController;
     hemelb::net::Net communicationNet;
@@ -114,6 +120,10 @@ class SimulationMaster
 
     unsigned int imagesPerSimulation;
     int steeringSessionId;
+    //! The collision costs to weight the decomposition by, or empty for the built-in weights.
+    std::string collisionCostsFile;
+    //! Where to write the collision costs measured during the run, or empty not to.
+    std::string calibrationFile;
     unsigned int imagesPeriod;
     static const hemelb::LatticeTimeStep FORCE_FLUSH_PERIOD=1000;
 };
@@ -0,0 +1,156 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "benchmarks/Benchmark.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include "Exception.h"
+#include "geometry/DistributionLayout.h"
+#include "geometry/DistributionStorage.h"
+#include "geometry/NeighbourIndices.h"
+#include "geometry/SiteOrdering.h"
+#include "geometry/StreamingPattern.h"
+
+#define HEMELB_BENCHMARKS_QUOTE(x) #x
+#define HEMELB_BENCHMARKS_STRING(x) HEMELB_BENCHMARKS_QUOTE(x)
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    Options::Options() :
+        radius(12), length(64), steps(200), warmupSteps(10), filter(""), jsonPath("")
+    {
+    }
+
+    void Options::Parse(int argc, const char* const * argv)
+    {
+      // The parameters occur in pairs, as for the main executable.
+      if ( (argc % 2) == 0)
+      {
+        throw Exception() << "There should be an odd number of arguments since the parameters occur in pairs.";
+      }
+
+      for (int ii = 1; ii < argc; ii += 2)
+      {
+        const char* const paramName = argv[ii];
+        const char* const paramValue = argv[ii + 1];
+        char* end;
+        if (std::strcmp(paramName, "-radius") == 0)
+        {
+          radius = std::strtol(paramValue, &end, 10);
+        }
+        else if (std::strcmp(paramName, "-length") == 0)
+        {
+          length = std::strtol(paramValue, &end, 10);
+        }
+        else if (std::strcmp(paramName, "-steps") == 0)
+        {
+          steps = std::strtoul(paramValue, &end, 10);
+        }
+        else if (std::strcmp(paramName, "-warmup") == 0)
+        {
+          warmupSteps = std::strtoul(paramValue, &end, 10);
+        }
+        else if (std::strcmp(paramName, "-filter") == 0)
+        {
+          filter = paramValue;
+        }
+        else if (std::strcmp(paramName, "-json") == 0)
+        {
+          jsonPath = paramValue;
+        }
+        else
+        {
+          throw Exception() << "Unknown option: " << paramName;
+        }
+      }
+
+      if (radius < 2 || length < 2 || steps == 0)
+      {
+        throw Exception() << "The tube needs a radius and length of at least 2, and at least one step";
+      }
+    }
+
+    std::string Options::GetUsage()
+    {
+      return "Usage: hemelb_bench [-radius <sites>] [-length <sites>] [-steps <n>] [-warmup <n>]"
+          " [-filter <substring of LATTICE/KERNEL/STREAMER>] [-json <path>]";
+    }
+
+    void WriteTable(std::ostream& out, const std::vector<Result>& results)
+    {
+      out << std::left << std::setw(56) << "case" << std::right << std::setw(10) << "sites" << std::setw(12)
+          << "MLUPS" << std::setw(14) << "bytes/site" << "\n";
+      for (std::vector<Result>::const_iterator it = results.begin(); it != results.end(); ++it)
+      {
+        out << std::left << std::setw(56) << it->GetName() << std::right;
+        if (!it->skipped.empty())
+        {
+          out << "  skipped: " << it->skipped << "\n";
+          continue;
+        }
+        out << std::setw(10) << it->sites << std::setw(12) << std::fixed << std::setprecision(2) << it->mlups
+            << std::setw(14) << std::setprecision(1) << it->bytesPerSiteStep << "\n";
+      }
+    }
+
+    namespace
+    {
+      // Enough for the names and messages written here.
+      std::string Escape(const std::string& value)
+      {
+        std::string escaped;
+        for (std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+        {
+          if (*it == '"' || *it == '\\')
+          {
+            escaped += '\\';
+          }
+          escaped += (*it == '\n') ?
+            ' ' :
+            *it;
+        }
+        return escaped;
+      }
+    }
+
+    void WriteJson(std::ostream& out, const Options& options, const std::vector<Result>& results)
+    {
+      out << "{\n";
+      out << "  \"build\": {\n";
+      out << "    \"distribution_layout\": \"" << HEMELB_BENCHMARKS_STRING(HEMELB_DISTRIBUTION_LAYOUT) << "\",\n";
+      out << "    \"distribution_storage\": \"" << HEMELB_BENCHMARKS_STRING(HEMELB_DISTRIBUTION_STORAGE) << "\",\n";
+      out << "    \"streaming_pattern\": \"" << HEMELB_BENCHMARKS_STRING(HEMELB_STREAMING_PATTERN) << "\",\n";
+      out << "    \"neighbour_indices\": \"" << HEMELB_BENCHMARKS_STRING(HEMELB_NEIGHBOUR_INDICES) << "\",\n";
+      out << "    \"site_ordering\": \"" << HEMELB_BENCHMARKS_STRING(HEMELB_SITE_ORDERING) << "\",\n";
+      out << "    \"simd_width\": " << HEMELB_SIMD_WIDTH << "\n";
+      out << "  },\n";
+      out << "  \"tube\": { \"radius\": " << options.radius << ", \"length\": " << options.length
+          << ", \"steps\": " << options.steps << " },\n";
+      out << "  \"results\": [";
+      for (std::size_t ii = 0; ii < results.size(); ++ii)
+      {
+        const Result& result = results[ii];
+        out << (ii == 0 ?
+          "\n" :
+          ",\n");
+        out << "    { \"lattice\": \"" << result.lattice << "\", \"kernel\": \"" << result.kernel
+            << "\", \"streamer\": \"" << result.streamer << "\"";
+        if (!result.skipped.empty())
+        {
+          out << ", \"skipped\": \"" << Escape(result.skipped) << "\" }";
+          continue;
+        }
+        out << ", \"sites\": " << result.sites << ", \"steps\": " << result.steps << ", \"seconds\": "
+            << result.seconds << ", \"mlups\": " << result.mlups << ", \"bytes_per_site_step\": "
+            << result.bytesPerSiteStep << " }";
+      }
+      out << "\n  ]\n}\n";
+    }
+  }
+}
@@ -0,0 +1,78 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_BENCHMARKS_BENCHMARK_H
+#define HEMELB_BENCHMARKS_BENCHMARK_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "units.h"
+#include "net/IOCommunicator.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    /**
+     * The settings of a benchmark run, from the command line.
+     */
+    struct Options
+    {
+        Options();
+
+        //! Parse the command line; throws Exception on bad arguments.
+        void Parse(int argc, const char* const * argv);
+        static std::string GetUsage();
+
+        site_t radius; //! Of the tube, in lattice units.
+        site_t length; //! Of the tube, in sites.
+        unsigned steps; //! Timed steps per case.
+        unsigned warmupSteps; //! Untimed steps per case.
+        std::string filter; //! Only run cases whose name contains this.
+        std::string jsonPath; //! Where to write the results, if anywhere.
+    };
+
+    /**
+     * The timing of one lattice / kernel / streamer combination.
+     */
+    struct Result
+    {
+        std::string lattice;
+        std::string kernel;
+        std::string streamer;
+        //! Empty if the case ran; otherwise why it didn't.
+        std::string skipped;
+        site_t sites; //! The number of sites the streamer updated each step.
+        unsigned steps;
+        double seconds;
+        //! Million lattice site updates per second.
+        double mlups;
+        //! Modelled memory traffic: distributions read and written, plus the streaming lookup.
+        double bytesPerSiteStep;
+
+        std::string GetName() const
+        {
+          return lattice + "/" + kernel + "/" + streamer;
+        }
+    };
+
+    /**
+     * Run every kernel and streamer combination available for the lattice on a tube, appending
+     * to results. This is instantiated for each lattice in a file of its own, which spreads out
+     * the compile time.
+     */
+    template<class Lattice>
+    void RunBenchmarks(const Options& options, const net::IOCommunicator& comms, std::vector<Result>& results);
+
+    //! Print the results as a table.
+    void WriteTable(std::ostream& out, const std::vector<Result>& results);
+
+    //! Write the results, and the build options they were measured with, as JSON.
+    void WriteJson(std::ostream& out, const Options& options, const std::vector<Result>& results);
+  }
+}
+
+#endif /* HEMELB_BENCHMARKS_BENCHMARK_H */
@@ -0,0 +1,659 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_BENCHMARKS_BENCHMARK_HPP
+#define HEMELB_BENCHMARKS_BENCHMARK_HPP
+
+#include <exception>
+#include <memory>
+#include <type_traits>
+
+#include "benchmarks/Benchmark.h"
+#include "benchmarks/TubeGeometry.h"
+#include "constants.h"
+#include "geometry/LatticeData.h"
+#include "lb/BuildSystemInterface.h"
+#include "lb/LbmParameters.h"
+#include "lb/MacroscopicPropertyCache.h"
+#include "lb/SimulationState.h"
+#include "lb/lattices/Lattices.h"
+#include "lb/iolets/BoundaryValues.h"
+#include "lb/iolets/InOutLetCosine.h"
+#include "lb/iolets/InOutLetParabolicVelocity.h"
+#include "util/UnitConverter.h"
+#include "util/utilityFunctions.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    namespace detail
+    {
+      template<class ... >
+      struct MakeVoid
+      {
+          typedef void Type;
+      };
+
+      /**
+       * Whether Family::Type<Argument> exists, e.g. MRT only has a moment basis for some
+       * lattices.
+       */
+      template<class Family, class Argument, class = void>
+      struct IsAvailable : std::false_type
+      {
+      };
+
+      template<class Family, class Argument>
+      struct IsAvailable<Family, Argument,
+          typename MakeVoid<typename Family::template Type<Argument> >::Type> : std::true_type
+      {
+      };
+
+      /**
+       * The lattices, named as in the HEMELB_LATTICE build option.
+       */
+      template<class Lattice>
+      struct LatticeName;
+
+      template<>
+      struct LatticeName<lb::lattices::D3Q15>
+      {
+          static const char* Get()
+          {
+            return "D3Q15";
+          }
+      };
+
+      template<>
+      struct LatticeName<lb::lattices::D3Q19>
+      {
+          static const char* Get()
+          {
+            return "D3Q19";
+          }
+      };
+
+      template<>
+      struct LatticeName<lb::lattices::D3Q27>
+      {
+          static const char* Get()
+          {
+            return "D3Q27";
+          }
+      };
+
+      /**
+       * The kernels, named as in the HEMELB_KERNEL build option.
+       */
+      struct LBGKKernel
+      {
+          static const char* Name()
+          {
+            return "LBGK";
+          }
+          template<class Lattice>
+          using Type = typename lb::LBGK<Lattice>::Type;
+      };
+
+      struct NNCYKernel
+      {
+          static const char* Name()
+          {
+            return "NNCY";
+          }
+          template<class Lattice>
+          using Type = typename lb::NNCY<Lattice>::Type;
+      };
+
+      struct NNCYMOUSEKernel
+      {
+          static const char* Name()
+          {
+            return "NNCYMOUSE";
+          }
+          template<class Lattice>
+          using Type = typename lb::NNCYMOUSE<Lattice>::Type;
+      };
+
+      struct NNCKernel
+      {
+          static const char* Name()
+          {
+            return "NNC";
+          }
+          template<class Lattice>
+          using Type = typename lb::NNC<Lattice>::Type;
+      };
+
+      struct NNTPLKernel
+      {
+          static const char* Name()
+          {
+            return "NNTPL";
+          }
+          template<class Lattice>
+          using Type = typename lb::NNTPL<Lattice>::Type;
+      };
+
+      struct TRTKernel
+      {
+          static const char* Name()
+          {
+            return "TRT";
+          }
+          template<class Lattice>
+          using Type = typename lb::TRT<Lattice>::Type;
+      };
+
+      struct MRTKernel
+      {
+          static const char* Name()
+          {
+            return "MRT";
+          }
+          template<class Lattice>
+          using Type = typename lb::MRT<Lattice>::Type;
+      };
+
+      struct EntropicAnsumaliKernel
+      {
+          static const char* Name()
+          {
+            return "ENTROPICANSUMALI";
+          }
+          template<class Lattice>
+          using Type = typename lb::EntropicAnsumali<Lattice>::Type;
+      };
+
+      struct EntropicChikKernel
+      {
+          static const char* Name()
+          {
+            return "ENTROPICCHIK";
+          }
+          template<class Lattice>
+          using Type = typename lb::EntropicChik<Lattice>::Type;
+      };
+
+      /**
+       * The streamers, named as in the HEMELB_*_BOUNDARY build options. Each is timed on the
+       * collision types it handles in a simulation: [FirstCollisionType, EndCollisionType) in
+       * the order used by LatticeData (fluid, wall, inlet, outlet, inlet-wall, outlet-wall).
+       */
+      struct SimpleCollideAndStreamStreamer
+      {
+          static const char* Name()
+          {
+            return "SIMPLECOLLIDEANDSTREAM";
+          }
+          template<class Collision>
+          using Type = lb::streamers::SimpleCollideAndStream<Collision>;
+          static const unsigned FirstCollisionType = 0;
+          static const unsigned EndCollisionType = 1;
+          static const bool UsesVelocityIolets = false;
+      };
+
+      template<template<class > class Family>
+      struct WallStreamer
+      {
+          template<class Collision>
+          using Type = typename Family<Collision>::Type;
+          static const unsigned FirstCollisionType = 1;
+          static const unsigned EndCollisionType = 2;
+          static const bool UsesVelocityIolets = false;
+      };
+
+      struct SimpleBounceBackStreamer : WallStreamer<lb::SIMPLEBOUNCEBACK>
+      {
+          static const char* Name()
+          {
+            return "SIMPLEBOUNCEBACK";
+          }
+      };
+
+      struct BFLStreamer : WallStreamer<lb::BFL>
+      {
+          static const char* Name()
+          {
+            return "BFL";
+          }
+      };
+
+      struct GZSStreamer : WallStreamer<lb::GZS>
+      {
+          static const char* Name()
+          {
+            return "GZS";
+          }
+      };
+
+      struct JunkYangStreamer : WallStreamer<lb::JUNKYANG>
+      {
+          static const char* Name()
+          {
+            return "JUNKYANG";
+          }
+      };
+
+      template<template<class > class Family, bool tUsesVelocityIolets>
+      struct IoletStreamer
+      {
+          template<class Collision>
+          using Type = typename Family<Collision>::Type;
+          static const unsigned FirstCollisionType = 2;
+          static const unsigned EndCollisionType = 4;
+          static const bool UsesVelocityIolets = tUsesVelocityIolets;
+      };
+
+      struct NashZerothOrderPressureStreamer : IoletStreamer<lb::NASHZEROTHORDERPRESSUREIOLET, false>
+      {
+          static const char* Name()
+          {
+            return "NASHZEROTHORDERPRESSUREIOLET";
+          }
+      };
+
+      struct LaddIoletStreamer : IoletStreamer<lb::LADDIOLET, true>
+      {
+          static const char* Name()
+          {
+            return "LADDIOLET";
+          }
+      };
+
+      /**
+       * Why a kernel and streamer can't be run together, or NULL if they can.
+       */
+      template<class Kernel, class Streamer>
+      struct Unsupported
+      {
+          static const char* Why()
+          {
+            return NULL;
+          }
+      };
+
+      // GZS collides a made-up wall site, which has no index for the per-site alpha.
+      template<>
+      struct Unsupported<EntropicAnsumaliKernel, GZSStreamer>
+      {
+          static const char* Why()
+          {
+            return "GZS doesn't support the entropic kernels";
+          }
+      };
+
+      template<>
+      struct Unsupported<EntropicChikKernel, GZSStreamer> : Unsupported<EntropicAnsumaliKernel, GZSStreamer>
+      {
+      };
+
+      template<class ... >
+      struct TypeList
+      {
+      };
+
+      typedef TypeList<LBGKKernel, NNCYKernel, NNCYMOUSEKernel, NNCKernel, NNTPLKernel, TRTKernel, MRTKernel,
+          EntropicAnsumaliKernel, EntropicChikKernel> AllKernels;
+      typedef TypeList<SimpleCollideAndStreamStreamer, SimpleBounceBackStreamer, BFLStreamer, GZSStreamer,
+          JunkYangStreamer, NashZerothOrderPressureStreamer, LaddIoletStreamer> AllStreamers;
+
+      /**
+       * A tube of the given lattice, with everything the streamers need to run on it. The
+       * fixture is shared between the cases on one lattice; Reset puts the fluid back at rest.
+       */
+      template<class Lattice>
+      class TubeFixture
+      {
+        public:
+          TubeFixture(const Options& options, const net::IOCommunicator& comms) :
+              voxelSize(1e-4),
+              // Choose the time step to make tau = 0.8.
+              timeStep(0.3 * Cs2 * voxelSize * voxelSize * BLOOD_DENSITY_Kg_per_m3 / BLOOD_VISCOSITY_Pa_s),
+              latticeData(Lattice::GetLatticeInfo(),
+                          MakeTubeGeometry(Lattice::GetLatticeInfo(), options.radius, options.length),
+                          comms),
+              simulationState(timeStep, options.warmupSteps + options.steps),
+              lbmParams(timeStep, voxelSize), unitConverter(timeStep, voxelSize, PhysicalPosition::Zero()),
+              propertyCache(simulationState, latticeData)
+          {
+            const double axis = GetTubeAxisCoordinate(options.radius);
+            const LatticePosition inletCentre(axis, axis, -0.5);
+            const util::Vector3D<Dimensionless> normal(0, 0, 1);
+
+            pressureIolet.SetDensityMean(1.0);
+            pressureIolet.SetDensityAmp(1e-3);
+            pressureIolet.SetPeriod(1000.0);
+            pressureIolet.SetPhase(0.0);
+            pressureIolet.SetPosition(inletCentre);
+            pressureIolet.SetNormal(normal);
+
+            velocityIolet.SetRadius(options.radius);
+            velocityIolet.SetMaxSpeed(0.01);
+            velocityIolet.SetPosition(inletCentre);
+            velocityIolet.SetNormal(normal);
+
+            pressureValues.reset(new lb::iolets::BoundaryValues(geometry::INLET_TYPE,
+                                                                &latticeData,
+                                                                std::vector<lb::iolets::InOutLet*>(1,
+                                                                                                   &pressureIolet),
+                                                                &simulationState,
+                                                                comms,
+                                                                unitConverter));
+            velocityValues.reset(new lb::iolets::BoundaryValues(geometry::INLET_TYPE,
+                                                                &latticeData,
+                                                                std::vector<lb::iolets::InOutLet*>(1,
+                                                                                                   &velocityIolet),
+                                                                &simulationState,
+                                                                comms,
+                                                                unitConverter));
+          }
+
+          /**
+           * Set both distribution arrays to the equilibrium at rest.
+           */
+          void Reset()
+          {
+            for (unsigned copy = 0; copy < 2; ++copy)
+            {
+              for (site_t site = 0; site < latticeData.GetLocalFluidSiteCount(); ++site)
+              {
+                for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+                {
+                  latticeData.SetFNew(latticeData.GetDistributionIndex(site, direction),
+                                      direction,
+                                      Lattice::EQMWEIGHTS[direction]);
+                }
+              }
+              latticeData.SwapOldAndNew();
+            }
+          }
+
+          /**
+           * Get the first site of the collision type; all sites are mid-domain on one rank.
+           */
+          site_t GetFirstSite(unsigned collisionType) const
+          {
+            site_t first = 0;
+            for (unsigned type = 0; type < collisionType; ++type)
+            {
+              first += latticeData.GetMidDomainCollisionCount(type);
+            }
+            return first;
+          }
+
+          /**
+           * Get the parameters for a streamer of the sites of collision types [first, end).
+           */
+          lb::kernels::InitParams GetInitParams(unsigned firstCollisionType, unsigned endCollisionType,
+                                                bool usesVelocityIolets)
+          {
+            const site_t firstSite = GetFirstSite(firstCollisionType);
+            lb::kernels::InitParams initParams;
+            initParams.latDat = &latticeData;
+            initParams.lbmParams = &lbmParams;
+            initParams.neighbouringDataManager = NULL;
+            initParams.boundaryObject = usesVelocityIolets ?
+              velocityValues.get() :
+              pressureValues.get();
+            initParams.siteCount = GetFirstSite(endCollisionType) - firstSite;
+            initParams.siteRanges.push_back(std::make_pair(firstSite, firstSite + initParams.siteCount));
+            return initParams;
+          }
+
+          template<class StreamerType>
+          void StreamAndCollide(StreamerType& streamer, const lb::kernels::InitParams& initParams)
+          {
+            streamer.template StreamAndCollide<false>(initParams.siteRanges[0].first,
+                                                      initParams.siteCount,
+                                                      &lbmParams,
+                                                      &latticeData,
+                                                      propertyCache);
+          }
+
+          template<class StreamerType>
+          void PostStep(StreamerType& streamer, const lb::kernels::InitParams& initParams)
+          {
+            streamer.template PostStep<false>(initParams.siteRanges[0].first,
+                                              initParams.siteCount,
+                                              &lbmParams,
+                                              &latticeData,
+                                              propertyCache);
+          }
+
+          void SwapOldAndNew()
+          {
+            latticeData.SwapOldAndNew();
+          }
+
+          /**
+           * Model the bytes moved per site update: each distribution is read and written once,
+           * and the streaming lookup is read once.
+           */
+          double GetBytesPerSiteStep() const
+          {
+            return 2.0 * Lattice::NUMVECTORS * sizeof(geometry::DistributionStorage::Type)
+                + double(latticeData.GetNeighbourLookupByteCount()) / latticeData.GetLocalFluidSiteCount();
+          }
+
+        private:
+          const PhysicalDistance voxelSize;
+          const PhysicalTime timeStep;
+          geometry::LatticeData latticeData;
+          lb::SimulationState simulationState;
+          lb::LbmParameters lbmParams;
+          util::UnitConverter unitConverter;
+          lb::MacroscopicPropertyCache propertyCache;
+          lb::iolets::InOutLetCosine pressureIolet;
+          lb::iolets::InOutLetParabolicVelocity velocityIolet;
+          std::unique_ptr<lb::iolets::BoundaryValues> pressureValues;
+          std::unique_ptr<lb::iolets::BoundaryValues> velocityValues;
+      };
+
+      /**
+       * The streamers that update the rest of the tube while one is timed, as in a simulation
+       * with simple bounce-back walls and pressure iolets. Without these, the sites next to the
+       * timed ones would never be updated and the flow soon becomes unphysical, which some
+       * kernels (e.g. the non-Newtonian ones) assert on.
+       */
+      template<class Lattice, class Collision>
+      class Surroundings
+      {
+        public:
+          /**
+           * @param fixture
+           * @param timedFirstCollisionType
+           * @param timedEndCollisionType the collision types left to the timed streamer
+           */
+          Surroundings(TubeFixture<Lattice>& fixture, unsigned timedFirstCollisionType,
+                       unsigned timedEndCollisionType) :
+              fixture(fixture), timedFirst(timedFirstCollisionType), timedEnd(timedEndCollisionType),
+                  bulkParams(fixture.GetInitParams(0, 1, false)), wallParams(fixture.GetInitParams(1, 2, false)),
+                  ioletParams(fixture.GetInitParams(2, 4, false)), ioletWallParams(fixture.GetInitParams(4, 6, false)),
+                  bulk(bulkParams), wall(wallParams), iolet(ioletParams), ioletWall(ioletWallParams)
+          {
+          }
+
+          void StreamAndCollide()
+          {
+            if (!IsTimed(0))
+            {
+              fixture.StreamAndCollide(bulk, bulkParams);
+            }
+            if (!IsTimed(1))
+            {
+              fixture.StreamAndCollide(wall, wallParams);
+            }
+            if (!IsTimed(2))
+            {
+              fixture.StreamAndCollide(iolet, ioletParams);
+            }
+            if (!IsTimed(4))
+            {
+              fixture.StreamAndCollide(ioletWall, ioletWallParams);
+            }
+          }
+
+          void PostStep()
+          {
+            if (!IsTimed(0))
+            {
+              fixture.PostStep(bulk, bulkParams);
+            }
+            if (!IsTimed(1))
+            {
+              fixture.PostStep(wall, wallParams);
+            }
+            if (!IsTimed(2))
+            {
+              fixture.PostStep(iolet, ioletParams);
+            }
+            if (!IsTimed(4))
+            {
+              fixture.PostStep(ioletWall, ioletWallParams);
+            }
+          }
+
+        private:
+          bool IsTimed(unsigned collisionType) const
+          {
+            return collisionType >= timedFirst && collisionType < timedEnd;
+          }
+
+          TubeFixture<Lattice>& fixture;
+          const unsigned timedFirst;
+          const unsigned timedEnd;
+          lb::kernels::InitParams bulkParams;
+          lb::kernels::InitParams wallParams;
+          lb::kernels::InitParams ioletParams;
+          lb::kernels::InitParams ioletWallParams;
+          lb::streamers::SimpleCollideAndStream<Collision> bulk;
+          typename lb::SIMPLEBOUNCEBACK<Collision>::Type wall;
+          typename lb::NASHZEROTHORDERPRESSUREIOLET<Collision>::Type iolet;
+          typename lb::NASHZEROTHORDERPRESSURESBB<Collision>::Type ioletWall;
+      };
+
+      template<class Lattice, class Kernel, class Streamer>
+      void RunCase(TubeFixture<Lattice>& fixture, const Options& options, Result& result, std::true_type)
+      {
+        typedef typename Kernel::template Type<Lattice> KernelType;
+        typedef lb::collisions::Normal<KernelType> CollisionType;
+        typedef typename Streamer::template Type<CollisionType> StreamerType;
+
+        lb::kernels::InitParams initParams = fixture.GetInitParams(Streamer::FirstCollisionType,
+                                                                   Streamer::EndCollisionType,
+                                                                   Streamer::UsesVelocityIolets);
+        result.sites = initParams.siteCount;
+        if (result.sites == 0)
+        {
+          result.skipped = "no sites of this type in the tube";
+          return;
+        }
+
+        try
+        {
+          fixture.Reset();
+          StreamerType streamer(initParams);
+          Surroundings<Lattice, CollisionType> surroundings(fixture,
+                                                            Streamer::FirstCollisionType,
+                                                            Streamer::EndCollisionType);
+
+          // Only the timed streamer's calls count, so take the clock around each of them.
+          result.seconds = 0.0;
+          for (unsigned step = 0; step < options.warmupSteps + options.steps; ++step)
+          {
+            const double start = util::myClock();
+            fixture.StreamAndCollide(streamer, initParams);
+            const double streamed = util::myClock();
+            surroundings.StreamAndCollide();
+
+            const double postStart = util::myClock();
+            fixture.PostStep(streamer, initParams);
+            const double end = util::myClock();
+            surroundings.PostStep();
+            fixture.SwapOldAndNew();
+
+            if (step >= options.warmupSteps)
+            {
+              result.seconds += (streamed - start) + (end - postStart);
+            }
+          }
+          result.mlups = result.seconds > 0 ?
+            1e-6 * result.sites * options.steps / result.seconds :
+            0.0;
+        }
+        catch (const std::exception& e)
+        {
+          // E.g. a streamer that isn't available with this build's streaming pattern.
+          result.skipped = e.what();
+        }
+      }
+
+      template<class Lattice, class Kernel, class Streamer>
+      void RunCase(TubeFixture<Lattice>& fixture, const Options& options, Result& result, std::false_type)
+      {
+        result.skipped = "kernel not available on this lattice";
+      }
+
+      template<class Lattice, class Kernel>
+      void RunStreamers(TubeFixture<Lattice>&, const Options&, std::vector<Result>&, TypeList<>)
+      {
+      }
+
+      template<class Lattice, class Kernel, class Streamer, class ... Rest>
+      void RunStreamers(TubeFixture<Lattice>& fixture, const Options& options, std::vector<Result>& results,
+                        TypeList<Streamer, Rest...>)
+      {
+        Result result;
+        result.lattice = LatticeName<Lattice>::Get();
+        result.kernel = Kernel::Name();
+        result.streamer = Streamer::Name();
+        result.sites = 0;
+        result.steps = options.steps;
+        result.seconds = 0.0;
+        result.mlups = 0.0;
+        result.bytesPerSiteStep = fixture.GetBytesPerSiteStep();
+
+        if (result.GetName().find(options.filter) != std::string::npos)
+        {
+          if (Unsupported<Kernel, Streamer>::Why() != NULL)
+          {
+            result.skipped = Unsupported<Kernel, Streamer>::Why();
+          }
+          else
+          {
+            RunCase<Lattice, Kernel, Streamer>(fixture, options, result, IsAvailable<Kernel, Lattice>());
+          }
+          results.push_back(result);
+        }
+
+        RunStreamers<Lattice, Kernel>(fixture, options, results, TypeList<Rest...>());
+      }
+
+      template<class Lattice>
+      void RunKernels(TubeFixture<Lattice>&, const Options&, std::vector<Result>&, TypeList<>)
+      {
+      }
+
+      template<class Lattice, class Kernel, class ... Rest>
+      void RunKernels(TubeFixture<Lattice>& fixture, const Options& options, std::vector<Result>& results,
+                      TypeList<Kernel, Rest...>)
+      {
+        RunStreamers<Lattice, Kernel>(fixture, options, results, AllStreamers());
+        RunKernels(fixture, options, results, TypeList<Rest...>());
+      }
+    }
+
+    template<class Lattice>
+    void RunBenchmarks(const Options& options, const net::IOCommunicator& comms, std::vector<Result>& results)
+    {
+      detail::TubeFixture<Lattice> fixture(options, comms);
+      detail::RunKernels(fixture, options, results, detail::AllKernels());
+    }
+  }
+}
+
+#endif /* HEMELB_BENCHMARKS_BENCHMARK_HPP */
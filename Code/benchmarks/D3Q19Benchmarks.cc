@@ -0,0 +1,14 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "benchmarks/Benchmark.hpp"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    template void RunBenchmarks<lb::lattices::D3Q19>(const Options&, const net::IOCommunicator&, std::vector<Result>&);
+  }
+}
@@ -0,0 +1,108 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "benchmarks/TubeGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    geometry::Geometry MakeTubeGeometry(const lb::lattices::LatticeInfo& latticeInfo,
+                                        site_t radius,
+                                        site_t length,
+                                        site_t blockSize)
+    {
+      using CutType = io::formats::geometry::CutType;
+
+      const double axis = GetTubeAxisCoordinate(radius);
+      const double radiusSquared = double(radius) * radius;
+      const site_t width = 2 * radius + 3;
+      const util::Vector3D<site_t> sites(width, width, length);
+
+      geometry::Geometry tube(util::Vector3D<site_t>( (width + blockSize - 1) / blockSize,
+                                                     (width + blockSize - 1) / blockSize,
+                                                     (length + blockSize - 1) / blockSize),
+                              blockSize);
+
+      auto isFluid = [&](const util::Vector3D<site_t>& coords)
+      {
+        const double dx = coords.x - axis;
+        const double dy = coords.y - axis;
+        return coords.x >= 0 && coords.x < sites.x && coords.y >= 0 && coords.y < sites.y
+            && dx * dx + dy * dy < radiusSquared;
+      };
+
+      for (site_t blockId = 0; blockId < tube.GetBlockCount(); ++blockId)
+      {
+        const util::Vector3D<site_t> blockCoords = tube.GetBlockCoordinatesFromBlockId(blockId);
+        geometry::BlockReadResult& block = tube.Blocks[blockId];
+        bool anyFluid = false;
+
+        for (site_t i = 0; i < blockSize; ++i)
+        {
+          for (site_t j = 0; j < blockSize; ++j)
+          {
+            for (site_t k = 0; k < blockSize; ++k)
+            {
+              const util::Vector3D<site_t> coords = blockCoords * blockSize + util::Vector3D<site_t>(i, j, k);
+              if (coords.z >= length || !isFluid(coords))
+              {
+                continue;
+              }
+              if (!anyFluid)
+              {
+                block.Sites.resize(tube.GetSitesPerBlock(), geometry::GeometrySite(false));
+                anyFluid = true;
+              }
+
+              geometry::GeometrySite& site = block.Sites[tube.GetSiteIdFromSiteCoordinates(i, j, k)];
+              site.isFluid = true;
+              site.targetProcessor = 0;
+
+              const double px = coords.x - axis;
+              const double py = coords.y - axis;
+              for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); ++direction)
+              {
+                const util::Vector3D<int>& vector = latticeInfo.GetVector(direction);
+                const util::Vector3D<site_t> neighbour = coords + util::Vector3D<site_t>(vector);
+                geometry::GeometrySiteLink link;
+
+                if (neighbour.z < 0 || neighbour.z >= length)
+                {
+                  link.type = neighbour.z < 0 ?
+                    CutType::INLET :
+                    CutType::OUTLET;
+                  link.ioletId = 0;
+                  link.distanceToIntersection = 0.5 / std::abs(vector.z);
+                }
+                else if (!isFluid(neighbour))
+                {
+                  // Solve |p + t c|^2 = R^2 in the cross-section for the cut. A neighbour exactly
+                  // on the cylinder is solid and gives t = 1, but the wall streamers need the
+                  // cut strictly inside the link.
+                  const double a = double(vector.x) * vector.x + double(vector.y) * vector.y;
+                  const double b = 2.0 * (px * vector.x + py * vector.y);
+                  const double c = px * px + py * py - radiusSquared;
+                  const double cut = (-b + std::sqrt(b * b - 4.0 * a * c)) / (2.0 * a);
+                  link.type = CutType::WALL;
+                  link.distanceToIntersection = std::min(cut, 0.999);
+
+                  site.wallNormalAvailable = true;
+                  site.wallNormal = util::Vector3D<float>(px, py, 0).GetNormalised();
+                }
+                site.links.push_back(link);
+              }
+            }
+          }
+        }
+      }
+
+      return tube;
+    }
+  }
+}
@@ -0,0 +1,46 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_BENCHMARKS_TUBEGEOMETRY_H
+#define HEMELB_BENCHMARKS_TUBEGEOMETRY_H
+
+#include "units.h"
+#include "geometry/Geometry.h"
+#include "lb/lattices/LatticeInfo.h"
+
+namespace hemelb
+{
+  namespace benchmarks
+  {
+    /**
+     * Make the geometry of a straight tube along the z axis, entirely on rank 0. The wall is a
+     * cylinder of the given radius (in lattice units), with exact cut distances for each link.
+     * The inlet (iolet 0) is half a lattice spacing below z = 0 and the outlet (iolet 0) half a
+     * lattice spacing above z = length - 1.
+     *
+     * @param latticeInfo the lattice to make the links for
+     * @param radius
+     * @param length the number of sites along the axis
+     * @param blockSize
+     * @return
+     */
+    geometry::Geometry MakeTubeGeometry(const lb::lattices::LatticeInfo& latticeInfo,
+                                        site_t radius,
+                                        site_t length,
+                                        site_t blockSize = 8);
+
+    /**
+     * Get the centre of the cross-section of the tube made by MakeTubeGeometry.
+     * @param radius
+     * @return
+     */
+    inline double GetTubeAxisCoordinate(site_t radius)
+    {
+      return radius + 1;
+    }
+  }
+}
+
+#endif /* HEMELB_BENCHMARKS_TUBEGEOMETRY_H */
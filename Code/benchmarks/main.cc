@@ -0,0 +1,60 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <fstream>
+#include <iostream>
+
+#include "benchmarks/Benchmark.h"
+#include "lb/lattices/Lattices.h"
+#include "log/Logger.h"
+#include "net/MpiCommunicator.h"
+#include "net/MpiEnvironment.h"
+#include "net/IOCommunicator.h"
+
+/**
+ * Time the streamers and kernels on a tube, on a single process, and report the site update
+ * rate of each combination. The distribution layout, storage and so on are those the benchmark
+ * was built with, and are recorded in the JSON output.
+ */
+int main(int argc, char *argv[])
+{
+  hemelb::net::MpiEnvironment mpi(argc, argv);
+  hemelb::log::Logger::Init();
+
+  hemelb::net::MpiCommunicator commWorld = hemelb::net::MpiCommunicator::World();
+  hemelb::net::IOCommunicator comms(commWorld);
+  if (comms.Size() != 1)
+  {
+    if (comms.OnIORank())
+    {
+      std::cerr << "hemelb_bench runs on a single process" << std::endl;
+    }
+    return 1;
+  }
+
+  hemelb::benchmarks::Options options;
+  try
+  {
+    options.Parse(argc, argv);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << "\n" << hemelb::benchmarks::Options::GetUsage() << std::endl;
+    return 1;
+  }
+
+  std::vector<hemelb::benchmarks::Result> results;
+  hemelb::benchmarks::RunBenchmarks<hemelb::lb::lattices::D3Q15>(options, comms, results);
+  hemelb::benchmarks::RunBenchmarks<hemelb::lb::lattices::D3Q19>(options, comms, results);
+  hemelb::benchmarks::RunBenchmarks<hemelb::lb::lattices::D3Q27>(options, comms, results);
+
+  hemelb::benchmarks::WriteTable(std::cout, results);
+  if (!options.jsonPath.empty())
+  {
+    std::ofstream json(options.jsonPath.c_str());
+    hemelb::benchmarks::WriteJson(json, options, results);
+  }
+  return 0;
+}
@@ -74,6 +74,7 @@ hemelb_option(HEMELB_VALIDATE_GEOMETRY "Validate geometry" OFF)
 hemelb_option(HEMELB_BUILD_TESTS_ALL "Build all the tests" ON)
 hemelb_option(HEMELB_BUILD_TESTS_UNIT "Build the unit-tests (HEMELB_BUILD_TESTS_ALL takes precedence)" ON)
 hemelb_option(HEMELB_BUILD_TESTS_FUNCTIONAL "Build the functional tests (HEMELB_BUILD_TESTS_ALL takes precedence)" ON)
+hemelb_option(HEMELB_BUILD_BENCHMARKS "Build hemelb_bench, which times each kernel and streamer on a synthetic tube" OFF)
 hemelb_option(HEMELB_USE_ALL_WARNINGS_GNU "Show all compiler warnings on development builds (gnu-style-compilers)" ON)
 hemelb_option(HEMELB_USE_STREAKLINES "Calculate streakline images" OFF)
 hemelb_option(HEMELB_DEPENDENCIES_SET_RPATH "Set runtime RPATH" ON)
@@ -81,7 +82,15 @@ hemelb_option(HEMELB_WAIT_ON_CONNECT "Wait for steering client" OFF)
 hemelb_option(HEMELB_BUILD_MULTISCALE "Build HemeLB Multiscale functionality" OFF)
 hemelb_option(HEMELB_IMAGES_TO_NULL "Write images to null" OFF)
 hemelb_option(HEMELB_USE_SSE3 "Use SSE3 intrinsics" ON)
+hemelb_option(HEMELB_USE_AVX2 "Use AVX2 intrinsics in the batched collision kernels" OFF)
+hemelb_option(HEMELB_USE_OPENMP "Share the collide-and-stream work of each rank between OpenMP threads" OFF)
 hemelb_option(HEMELB_USE_VELOCITY_WEIGHTS_FILE "Use Velocity weights file" OFF)
+hemelb_option(HEMELB_USE_PERSISTENT_HALO "Exchange the halo distributions with persistent requests on a distributed-graph communicator, rather than through the net" OFF)
+hemelb_option(HEMELB_USE_INDEXED_HALO_RECEIVE "With HEMELB_USE_PERSISTENT_HALO and two-lattice streaming, receive the halo straight into place with indexed MPI datatypes" OFF)
+hemelb_option(HEMELB_USE_TOPOLOGY_AWARE_DECOMPOSITION "After ParMETIS has partitioned the sites, give the parts sharing the most links ranks on the same node" OFF)
+hemelb_option(HEMELB_USE_COLLECTIVE_MONITORING "Combine the stability and incompressibility checks with MPI_Iallreduce instead of a broadcast tree" OFF)
+hemelb_option(HEMELB_USE_ASYNC_EXTRACTION "Write property extraction files with double-buffered non-blocking collective writes that complete while the simulation carries on" OFF)
+hemelb_option(HEMELB_USE_AGGREGATED_GEOMETRY_READING "Read the geometry blocks in large contiguous chunks per reading core with collective reads, and overlap sending them on with decompression" OFF)
 hemelb_option(UBUNTU_BUG_WORKAROUND "Work around the faulty HAVE_ISNAN value in Ubuntu 16.04." OFF)
 hemelb_option(HEMELB_SEPARATE_CONCERNS "Communicate for each concern separately" OFF)
 
@@ -121,13 +130,36 @@ hemelb_cachevar(HEMELB_WALL_INLET_BOUNDARY "NASHZEROTHORDERPRESSURESBB"
   STRING "Select the boundary conditions to be used at corners between walls and inlets (NASHZEROTHORDERPRESSURESBB,NASHZEROTHORDERPRESSUREBFL,LADDIOLETSBB,LADDIOLETBFL)")
 hemelb_cachevar(HEMELB_WALL_OUTLET_BOUNDARY "NASHZEROTHORDERPRESSURESBB"
   STRING "Select the boundary conditions to be used at corners between walls and outlets (NASHZEROTHORDERPRESSURESBB,NASHZEROTHORDERPRESSUREBFL,LADDIOLETSBB,LADDIOLETBFL)")
+hemelb_cachevar(HEMELB_DISTRIBUTION_LAYOUT "AOS"
+  STRING "Select the memory layout of the distribution arrays (AOS,SOA,AOSOA)")
+hemelb_cachevar(HEMELB_SIMD_WIDTH 4
+  STRING "Number of sites processed together by vectorised code; also the tile size for the AOSOA layout")
+hemelb_cachevar(HEMELB_STREAMING_PATTERN "TWOLATTICE"
+  STRING "Select how distributions are propagated between time steps (TWOLATTICE,AA)")
+hemelb_cachevar(HEMELB_DISTRIBUTION_STORAGE "DOUBLE"
+  STRING "Select the type the distributions are stored in; collisions are always done in double (DOUBLE,FLOAT,SHIFTEDFLOAT)")
+hemelb_cachevar(HEMELB_NEIGHBOUR_INDICES "WIDE"
+  STRING "Select how the streaming lookup is stored: 64-bit, 32-bit or 16-bit block-relative indices (WIDE,COMPACT,BLOCKRELATIVE)")
+hemelb_cachevar(HEMELB_SITE_ORDERING "NATURAL"
+  STRING "Select the order local sites are numbered in within each block and collision type (NATURAL,MORTON,HILBERT)")
 hemelb_cachevar(HEMELB_POINTPOINT_IMPLEMENTATION Coalesce
-  STRING "Point to point comms implementation, choose 'Coalesce', 'Separated', or 'Immediate'" )
+  STRING "Point to point comms implementation, choose 'Coalesce', 'Separated', 'Immediate', or 'Persistent'" )
 hemelb_cachevar(HEMELB_GATHERS_IMPLEMENTATION Separated
   STRING "Gather comms implementation, choose 'Separated', or 'ViaPointPoint'" )
 hemelb_cachevar(HEMELB_ALLTOALL_IMPLEMENTATION Separated
   STRING "Alltoall comms implementation, choose 'Separated', or 'ViaPointPoint'" )
 
+# In-place streaming only works with the boundaries that write to the site's own slots or the
+# streamed index (see Code/geometry/StreamingPattern.h), so refuse the others up front.
+if (HEMELB_STREAMING_PATTERN STREQUAL "AA")
+  foreach(boundary HEMELB_WALL_BOUNDARY HEMELB_INLET_BOUNDARY HEMELB_OUTLET_BOUNDARY
+      HEMELB_WALL_INLET_BOUNDARY HEMELB_WALL_OUTLET_BOUNDARY)
+    if (${boundary} MATCHES "BFL|GZS|JUNKYANG|VIRTUALSITE")
+      message(FATAL_ERROR "${boundary}=${${boundary}} is not available with HEMELB_STREAMING_PATTERN=AA")
+    endif()
+  endforeach()
+endif()
+
 #
 # Specify the variables requiring forwarding
 #
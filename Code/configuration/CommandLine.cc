@@ -13,8 +13,8 @@ namespace hemelb
   {
 
     CommandLine::CommandLine(int aargc, const char * const * const aargv) :
-      inputFile("input.xml"), outputDir(""), images(10), steeringSessionId(1), debugMode(false), argc(aargc),
-          argv(aargv)
+      inputFile("input.xml"), outputDir(""), images(10), steeringSessionId(1), collisionCostsFile(""),
+          calibrationFile(""), debugMode(false), argc(aargc), argv(aargv)
     {
 
       // There should be an odd number of arguments since the parameters occur in pairs.
@@ -47,6 +47,14 @@ namespace hemelb
           char *dummy;
           steeringSessionId = (unsigned int) (strtoul(paramValue, &dummy, 10));
         }
+        else if (std::strcmp(paramName, "-costs") == 0)
+        {
+          collisionCostsFile = std::string(paramValue);
+        }
+        else if (std::strcmp(paramName, "-calibrate") == 0)
+        {
+          calibrationFile = std::string(paramValue);
+        }
         else if (std::strcmp(paramName, "-debug") == 0)
         {
           debugMode = std::strcmp(paramName, "0") == 0 ? false : true;
@@ -66,6 +74,8 @@ namespace hemelb
       ans.append("-out \t Path to the output folder (default is based on input file, e.g. config_xml_results)\n");
       ans.append("-i \t Number of images to create (default is 10)\n");
       ans.append("-ss \t Steering session identifier (default is 1)\n");
+      ans.append("-costs \t Path to collision costs to weight the domain decomposition by (default is the built-in weights)\n");
+      ans.append("-calibrate \t Path to write the collision costs measured during the run to (default is not to measure them)\n");
       return ans;
     }
   }
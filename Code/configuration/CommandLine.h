@@ -23,6 +23,8 @@ namespace hemelb
      * - -out output folder (empty default, but the hemelb::io::PathManager will guess a value from the input file if not given.)
      * - -i number of images (default 10)
      * - -ss steering session i.d. (default 1)
+     * - -costs collision costs file to weight the decomposition by (default none)
+     * - -calibrate collision costs file to measure and write (default none)
      */
     class CommandLine
     {
@@ -69,6 +71,24 @@ namespace hemelb
           return (steeringSessionId);
         }
 
+        /**
+         * @return The path of the collision costs to weight the domain decomposition by, or
+         * empty to use the built-in weights.
+         */
+        std::string const & GetCollisionCostsFile() const
+        {
+          return collisionCostsFile;
+        }
+
+        /**
+         * @return The path to write the measured collision costs to, or empty if they
+         * shouldn't be measured.
+         */
+        std::string const & GetCalibrationFile() const
+        {
+          return calibrationFile;
+        }
+
         /**
          * @return Whether the user requested a debug mode.
          */
@@ -104,6 +124,8 @@ namespace hemelb
         std::string outputDir; //! local or full path to input file
         unsigned int images; //! images to produce
         int steeringSessionId; //! unique identifier for steering session
+        std::string collisionCostsFile; //! local or full path to collision costs to read
+        std::string calibrationFile; //! local or full path to collision costs to write
         bool debugMode; //! Use debugger
         int argc; //! count of command line arguments, including program name
         const char * const * const argv; //! command line arguments
@@ -342,6 +342,42 @@ namespace hemelb
 
       propertyoutputEl.GetAttributeOrThrow("period", file->frequency);
 
+      // By default every timestep carries the site coordinates, in XDR.
+      const std::string* format = propertyoutputEl.GetAttributeOrNull("format");
+      if (format != nullptr && *format != "xdr")
+      {
+        if (*format == "geometry-once")
+        {
+          file->geometryOnce = true;
+        }
+        else if (*format == "geometry-once-native")
+        {
+          file->geometryOnce = true;
+          file->nativeFields = true;
+        }
+        else
+        {
+          throw Exception() << "Unrecognised property output format '" << *format
+              << "' in element " << propertyoutputEl.GetPath();
+        }
+      }
+
+      const std::string* compression = propertyoutputEl.GetAttributeOrNull("compression");
+      if (compression != nullptr && *compression != "none")
+      {
+        if (*compression != "zlib")
+        {
+          throw Exception() << "Unrecognised property output compression '" << *compression
+              << "' in element " << propertyoutputEl.GetPath();
+        }
+        if (!file->geometryOnce)
+        {
+          throw Exception() << "Property output compression needs a geometry-once format in element "
+              << propertyoutputEl.GetPath();
+        }
+        file->compressFields = true;
+      }
+
       io::xml::Element geometryEl = propertyoutputEl.GetChildOrThrow("geometry");
       const std::string& type = geometryEl.GetAttributeOrThrow("type");
 
@@ -491,6 +527,13 @@ namespace hemelb
       {
         throw Exception() << "Unrecognised field type '" << type << "' in " << fieldEl.GetPath();
       }
+
+      // Optionally, the absolute error allowed in the values written, in the units they're
+      // written in.
+      if (fieldEl.GetAttributeOrNull("tolerance", field.tolerance) && ! (field.tolerance >= 0.))
+      {
+        throw Exception() << "Field tolerance must not be negative in " << fieldEl.GetPath();
+      }
       return field;
     }
 
@@ -653,6 +696,25 @@ namespace hemelb
       newIolet->SetWomersleyNumber(GetDimensionalValueInLatticeUnits<Dimensionless>(womNumEl,
                                                                                     "dimensionless"));
 
+      // Optional further harmonics of the pressure gradient
+      for (io::xml::ChildIterator harmonicPtr = conditionEl.IterChildren("harmonic");
+          !harmonicPtr.AtEnd(); ++harmonicPtr)
+      {
+        unsigned multiple;
+        harmonicPtr->GetAttributeOrThrow("multiple", multiple);
+        const io::xml::Element harmonicAmpEl =
+            harmonicPtr->GetChildOrThrow("pressure_gradient_amplitude");
+        Dimensionless phase = 0.0;
+        if (const io::xml::Element phaseEl = harmonicPtr->GetChildOrNull("phase"))
+        {
+          phase = GetDimensionalValueInLatticeUnits<Dimensionless>(phaseEl, "rad");
+        }
+        newIolet->AddHarmonic(multiple,
+                              GetDimensionalValueInLatticeUnits<LatticePressureGradient>(harmonicAmpEl,
+                                                                                         "mmHg/m"),
+                              phase);
+      }
+
       return newIolet;
     }
 
@@ -698,6 +760,9 @@ namespace hemelb
 
       monitoringConfig.doIncompressibilityCheck = (monEl.GetChildOrNull("incompressibility")
           != io::xml::Element::Missing());
+
+      monitoringConfig.fuseStabilityCheck = (monEl.GetChildOrNull("fused_stability_check")
+          != io::xml::Element::Missing());
     }
 
     void SimConfig::DoIOForSteadyFlowConvergence(const io::xml::Element& convEl)
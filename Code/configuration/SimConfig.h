@@ -70,7 +70,7 @@ namespace hemelb
         {
             MonitoringConfig() :
                 doConvergenceCheck(false), convergenceRelativeTolerance(0), convergenceTerminate(false),
-                    doIncompressibilityCheck(false)
+                    doIncompressibilityCheck(false), fuseStabilityCheck(false)
             {
             }
             bool doConvergenceCheck; ///< Whether to turn on the convergence check or not
@@ -79,6 +79,7 @@ namespace hemelb
             double convergenceRelativeTolerance; ///< Convergence check relative tolerance
             bool convergenceTerminate; ///< Whether to terminate a converged run or not
             bool doIncompressibilityCheck; ///< Whether to turn on the IncompressibilityChecker or not
+            bool fuseStabilityCheck; ///< Whether to do the stability and convergence checks while colliding, which reports convergence a step later
         };
 
 	static SimConfig* New(const std::string& path);
@@ -40,6 +40,15 @@ namespace hemelb
           return false;
         }
 
+        /**
+         * Reads the site with the given index.
+         *
+         * @return
+         */
+        bool ReadAt(site_t index) {
+          return false;
+        }
+
         /**
          * Returns the coordinates of the site.
          * @return
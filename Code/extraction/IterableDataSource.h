@@ -38,6 +38,16 @@ namespace hemelb
          */
         virtual bool ReadNext() = 0;
 
+        /**
+         * Reads the fluid site with the given index, counting from 0 in the order ReadNext
+         * reaches them, so that sites found by an earlier pass can be read again directly.
+         * ReadNext carries on from the site after it. Returns true if values could be obtained.
+         *
+         * @param index
+         * @return
+         */
+        virtual bool ReadAt(site_t index) = 0;
+
         /**
          * Returns the coordinates of the site.
          * @return
@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include "extraction/LbDataSourceIterator.h"
 
 namespace hemelb
@@ -31,6 +32,13 @@ namespace hemelb
       return true;
     }
 
+    bool LbDataSourceIterator::ReadAt(site_t index)
+    {
+      position = index;
+
+      return position < data.GetLocalFluidSiteCount();
+    }
+
     util::Vector3D<site_t> LbDataSourceIterator::GetPosition() const
     {
       return data.GetSite(position).GetGlobalSiteCoords();
@@ -79,7 +87,30 @@ namespace hemelb
 
     const distribn_t* LbDataSourceIterator::GetDistribution() const
     {
-      return data.GetFNew(position * data.GetLatticeInfo().GetNumVectors());
+      // Always copy: depending on the build, the stored values may be scattered, converted from
+      // another type, or both.
+      const Direction numVectors = data.GetLatticeInfo().GetNumVectors();
+      distributionBuffer.resize(numVectors);
+
+      // We are called after the LBM has swapped fOld and fNew, so with two lattices fNew holds
+      // the distributions from the start of the step, which the other properties were
+      // calculated from. With in-place streaming those have been overwritten, so give the ones
+      // from the end of the step, which are now fOld.
+      if (geometry::StreamingPattern::InPlace)
+      {
+        const geometry::Site<const geometry::LatticeData> site = data.GetSite(position);
+        const distribn_t* fOld = site.GetFOld(numVectors);
+        std::copy(fOld, fOld + numVectors, distributionBuffer.begin());
+      }
+      else
+      {
+        for (Direction direction = 0; direction < numVectors; ++direction)
+        {
+          distributionBuffer[direction] = data.GetFNewValue(data.GetDistributionIndex(position, direction),
+                                                            direction);
+        }
+      }
+      return distributionBuffer.data();
     }
 
     void LbDataSourceIterator::Reset()
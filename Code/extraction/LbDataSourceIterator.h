@@ -38,6 +38,15 @@ namespace hemelb
          */
         bool ReadNext();
 
+        /**
+         * Reads the local fluid site with the given contiguous index. Returns true if values
+         * could be obtained.
+         *
+         * @param index
+         * @return
+         */
+        bool ReadAt(site_t index);
+
         /**
          * Returns the coordinates of the site.
          * @return
@@ -167,6 +176,11 @@ namespace hemelb
          * Iteration variable for tracking progress through all the local fluid sites.
          */
         site_t position;
+        /**
+         * Somewhere to gather a site's distribution into if the layout doesn't store it
+         * contiguously.
+         */
+        mutable std::vector<distribn_t> distributionBuffer;
     };
   }
 }
@@ -1,3 +1,7 @@
+#include <cstring>
+#include <fstream>
+#include <zlib.h>
+
 #include "extraction/LocalDistributionInput.h"
 #include "extraction/OutputField.h"
 #include "extraction/LocalPropertyOutput.h"
@@ -29,6 +33,33 @@ namespace hemelb
       // The required xtr field header len
       constexpr uint64_t expectedFieldHeaderLength = 32U;
       constexpr uint64_t totalXtrHeaderLength = fmt::extraction::MainHeaderLength + expectedFieldHeaderLength;
+
+      float ReadLittleEndianFloat(const char* bytes)
+      {
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(bytes);
+        uint32_t bits = uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16
+            | uint32_t(b[3]) << 24;
+        float val;
+        std::memcpy(&val, &bits, sizeof(val));
+        return val;
+      }
+
+      // Inflate a compressed chunk, which must be exactly uncompressedLength long.
+      std::vector<char> InflateChunk(const char* compressed, uLong compressedLength,
+                                     uLongf uncompressedLength)
+      {
+        std::vector<char> uncompressed(uncompressedLength);
+        if (compressedLength == 0 && uncompressedLength == 0)
+          return uncompressed;
+
+        uLongf inflatedLength = uncompressedLength;
+        int ret = uncompress(reinterpret_cast<Bytef*>(uncompressed.data()), &inflatedLength,
+                             reinterpret_cast<const Bytef*>(compressed), compressedLength);
+        if (ret != Z_OK || inflatedLength != uncompressedLength)
+          throw Exception() << "Decompression error for checkpoint: expected " << uncompressedLength
+                            << " B of distributions";
+        return uncompressed;
+      }
     }
 
     void LocalDistributionInput::LoadDistribution(geometry::LatticeData* latDat, boost::optional<LatticeTimeStep>& targetTime)
@@ -48,9 +79,14 @@ namespace hemelb
 
       // Figure out how many checkpoints are in the XTR file and
       // therefore the position to start at.
+      const bool compressed = geometryFlags & fmt::extraction::CompressedFields;
+      const std::size_t offsetRecordLength = comms.Size() + 1;
       auto nTimes = [&](){
+	// Compressed checkpoints have their offsets for each timestep.
+	if (compressed)
+	  return uint64_t(timestepOffsets.size() / offsetRecordLength);
 	uint64_t fileSize = inputFile.GetSize();
-	auto dataSize = fileSize - totalXtrHeaderLength;
+	auto dataSize = fileSize - dataStart;
 	if (dataSize % allCoresWriteLength)
 	  throw Exception() << "Checkpoint file length not consistent with integer number of checkpoints";
 	return dataSize / allCoresWriteLength;
@@ -59,7 +95,10 @@ namespace hemelb
       auto ReadTimeByIndex = [&](uint64_t iTS) {
 	uint64_t ans;
 	std::vector<char> tsbuf(8);
-	inputFile.ReadAt(localStart + iTS*allCoresWriteLength, tsbuf);
+	inputFile.ReadAt(compressed ?
+			   timestepOffsets[iTS * offsetRecordLength] :
+			   localStart + iTS*allCoresWriteLength,
+			 tsbuf);
 	xdr::XdrMemReader dataReader(tsbuf);
 	dataReader.read(ans);
 	return ans;
@@ -94,12 +133,38 @@ namespace hemelb
       comms.Broadcast(timestep, comms.GetIORank());
       comms.Broadcast(iTS, comms.GetIORank());
       log::Logger::Log<log::Info, log::Singleton>("Reading checkpoint from timestep %d with index %d", timestep, iTS);
-      // Read the local part of the checkpoint
-      const auto readLength = localStop - localStart;
-      const auto timeStart = iTS * allCoresWriteLength;
+      if (compressed) {
+	// Each rank reads its chunk of this timestep.
+	std::vector<uint64_t> startsAndStops;
+	if (comms.OnIORank()) {
+	  for (int rank = 0; rank < comms.Size(); ++rank) {
+	    startsAndStops.push_back(timestepOffsets[iTS * offsetRecordLength + rank]);
+	    startsAndStops.push_back(timestepOffsets[iTS * offsetRecordLength + rank + 1]);
+	  }
+	}
+	auto startAndStop = comms.Scatter(startsAndStops, 2, comms.GetIORank());
+	localStart = startAndStop[0];
+	localStop = startAndStop[1];
+      }
 
-      std::vector<char> dataBuffer(readLength);
+      // Read the local part of the checkpoint
+      const auto timeStart = compressed ? 0 : iTS * allCoresWriteLength;
+      std::vector<char> dataBuffer(localStop - localStart);
       inputFile.ReadAt(timeStart + localStart, dataBuffer);
+
+      // Compressed values are after the timestep, and are all this rank's sites' distributions.
+      if (compressed) {
+	const std::size_t prefixLength = comms.OnIORank() ? 8 : 0;
+	if (dataBuffer.size() < prefixLength)
+	  throw Exception() << "Checkpoint chunk too short on rank " << comms.Rank();
+	std::vector<char> values = InflateChunk(dataBuffer.data() + prefixLength,
+						dataBuffer.size() - prefixLength,
+						4 * LatticeType::NUMVECTORS
+						* latDat->GetLocalFluidSiteCount());
+	dataBuffer.resize(prefixLength);
+	dataBuffer.insert(dataBuffer.end(), values.begin(), values.end());
+      }
+      const uint64_t readLength = dataBuffer.size();
       xdr::XdrMemReader dataReader(dataBuffer);
 
       // Read the timestep
@@ -107,16 +172,46 @@ namespace hemelb
 	dataReader.read(timestep);
       }
 
+      // distField.numberOfFloats is read on IO rank and checked to
+      // be equal to LatticeType::NUMVECTORS so we use that instead
+      // of broadcasting and storing.
+      const bool geometryOnce = version == fmt::extraction::GeometryOnceVersionNumber;
+      const uint64_t siteLength = 4 * LatticeType::NUMVECTORS + (geometryOnce ? 0 : 3 * 4);
+      const site_t localSiteCount = (readLength - dataReader.GetPosition()) / siteLength;
+
+      // In the geometry-once format, this rank's coordinates are in the geometry section, in
+      // the same order as the sites in each timestep.
+      std::vector<char> geometryBuffer;
+      if (geometryOnce) {
+	uint64_t sitesBefore = 0;
+	if (compressed) {
+	  // Find it from the sites on the lower ranks, which are checked below to be as written.
+	  auto siteCounts = comms.AllGather(uint64_t(localSiteCount));
+	  for (int rank = 0; rank < comms.Rank(); ++rank)
+	    sitesBefore += siteCounts[rank];
+	} else if (!comms.OnIORank()) {
+	  sitesBefore = (localStart - dataStart - 8) / siteLength;
+	}
+	geometryBuffer.resize(3 * 4 * localSiteCount);
+	inputFile.ReadAt(totalXtrHeaderLength + fmt::extraction::GeometryHeaderLength
+			 + 3 * 4 * sitesBefore, geometryBuffer);
+      }
+      xdr::XdrMemReader geometryReader(geometryBuffer);
+      xdr::XdrMemReader& coordinateReader = geometryOnce ? geometryReader : dataReader;
+
+      const bool littleEndianFields = geometryOnce &&
+	(geometryFlags & fmt::extraction::LittleEndianFields);
+      const char* nextField = dataBuffer.data() + dataReader.GetPosition();
+
       site_t iSite = 0;
-      // while (dataReader.GetPosition() < readLength) {
-      for (; dataReader.GetPosition() < readLength; iSite++) {
+      for (; iSite < localSiteCount; iSite++) {
 	// Read the grid coord and check it's consistent with latDat.
 	{
 	  // Stored as 32 b unsigned
 	  util::Vector3D<uint32_t> tmp;
-	  dataReader.read(tmp.x);
-	  dataReader.read(tmp.y);
-	  dataReader.read(tmp.z);
+	  coordinateReader.read(tmp.x);
+	  coordinateReader.read(tmp.y);
+	  coordinateReader.read(tmp.z);
 
 	  // Convert to canonical type
 	  util::Vector3D<site_t> grid{tmp};
@@ -136,16 +231,18 @@ namespace hemelb
 			      << " but should be read at " << index;
 	}
 
-	distribn_t* f_old_p = latDat->GetFOld(iSite * LatticeType::NUMVECTORS);
-	distribn_t* f_new_p = latDat->GetFNew(iSite * LatticeType::NUMVECTORS);
-	// distField.numberOfFloats is read on IO rank and checked to
-	// be equal to LatticeType::NUMVECTORS so we use that instead
-	// of broadcasting and storing.
 	for (int i = 0; i < LatticeType::NUMVECTORS; i++) {
 	  float field_val;
-	  dataReader.read(field_val);
+	  if (littleEndianFields) {
+	    field_val = ReadLittleEndianFloat(nextField);
+	    nextField += 4;
+	  } else {
+	    dataReader.read(field_val);
+	  }
 	  field_val += distField.offset;
-	  f_new_p[i] = f_old_p[i] = field_val;
+	  const site_t index = latDat->GetDistributionIndex<LatticeType>(iSite, i);
+	  latDat->SetFNew(index, i, field_val);
+	  latDat->SetFOld(index, i, field_val);
 	}
       }
 
@@ -161,7 +258,7 @@ namespace hemelb
 	auto preambleReader = xdr::XdrMemReader(preambleBuf);
 
 	// Read the magic numbers.
-	uint32_t hlbMagicNumber, extMagicNumber, version;
+	uint32_t hlbMagicNumber, extMagicNumber;
 	preambleReader.read(hlbMagicNumber);
 	preambleReader.read(extMagicNumber);
 	preambleReader.read(version);
@@ -183,10 +280,12 @@ namespace hemelb
 	}
 
 	// Check the version number.
-	if (version != fmt::extraction::VersionNumber)
+	if (version != fmt::extraction::VersionNumber
+	    && version != fmt::extraction::GeometryOnceVersionNumber)
 	{
 	  throw Exception() << "Version number incorrect."
 			    << " Supported: " << unsigned(fmt::extraction::VersionNumber)
+			    << " and " << unsigned(fmt::extraction::GeometryOnceVersionNumber)
 			    << " Input: " << version;
 	}
 
@@ -231,8 +330,15 @@ namespace hemelb
 	  throw Exception() << "Checkpoint field distributions contains " << distField.numberOfFloats
 			    << " distributions but this build of HemeLB requires " << LatticeType::NUMVECTORS;
 
+	if (version == fmt::extraction::GeometryOnceVersionNumber) {
+	  auto geometryHeaderBuf = std::vector<char>(fmt::extraction::GeometryHeaderLength);
+	  inputFile.Read(geometryHeaderBuf);
+	  xdr::XdrMemReader(geometryHeaderBuf).read(geometryFlags);
+	}
       }
       comms.Broadcast(distField.offset, comms.GetIORank());
+      comms.Broadcast(version, comms.GetIORank());
+      comms.Broadcast(geometryFlags, comms.GetIORank());
     }
 
     void LocalDistributionInput::ReadOffsets(const std::string& offsetFileName) {
@@ -257,9 +363,13 @@ namespace hemelb
 			    << " Expected: " << unsigned(fmt::offset::MagicNumber)
 			    << " Actual: " << offMagicNumber;
 
-	if (version != fmt::offset::VersionNumber)
+	const bool perTimestep = geometryFlags & fmt::extraction::CompressedFields;
+	const uint32_t expectedVersion = perTimestep ?
+	  uint32_t(fmt::offset::PerTimestepVersionNumber) :
+	  uint32_t(fmt::offset::VersionNumber);
+	if (version != expectedVersion)
 	  throw Exception() << "Version number incorrect."
-			    << " Supported: " << unsigned(fmt::offset::VersionNumber)
+			    << " Supported: " << expectedVersion
 			    << " Input: " << version;
 
 	if (nRanks != comms.Size())
@@ -267,22 +377,40 @@ namespace hemelb
 			    << " Running with: " << comms.Size()
 			    << " Input: " << nRanks;
 
-	// Now read the encoded nProcs+1 values
-	// We are going to duplicate these into a flattened array of shape (nRanks, 2)
-	// [start0, end0, start1, end1, ...]
-	// where end_i == start_i+1 (except for the start finish obvs)
-	offsets.resize(2*nRanks);
-	offsetReader.read(offsets[0]);
-	for (unsigned i = 1; i < nRanks; ++i) {
-	  offsetReader.read(offsets[2*i]);
-	  offsets[2*i - 1] = offsets[2*i];
+	if (perTimestep) {
+	  // Read every timestep's nProcs+1 values, as a flattened array of shape
+	  // (nTimesteps, nRanks+1).
+	  std::ifstream offsetFile(offsetFileName, std::ios::binary | std::ios::ate);
+	  const uint64_t bodyLength = uint64_t(offsetFile.tellg()) - fmt::offset::HeaderLength;
+	  const uint64_t recordLength = (nRanks + 1) * fmt::offset::RecordLength;
+	  if (bodyLength == 0 || bodyLength % recordLength)
+	    throw Exception() << "Offset file has partial or no timesteps";
+	  timestepOffsets.resize(bodyLength / fmt::offset::RecordLength);
+	  for (auto& offset : timestepOffsets)
+	    offsetReader.read(offset);
+	  // The chunks are found once the timestep is.
+	  offsets = std::vector<uint64_t>(2 * nRanks, timestepOffsets[0]);
+	}
+	else {
+	  // Now read the encoded nProcs+1 values
+	  // We are going to duplicate these into a flattened array of shape (nRanks, 2)
+	  // [start0, end0, start1, end1, ...]
+	  // where end_i == start_i+1 (except for the start finish obvs)
+	  offsets.resize(2*nRanks);
+	  offsetReader.read(offsets[0]);
+	  for (unsigned i = 1; i < nRanks; ++i) {
+	    offsetReader.read(offsets[2*i]);
+	    offsets[2*i - 1] = offsets[2*i];
+	  }
+	  offsetReader.read(offsets[2*nRanks-1]);
 	}
-	offsetReader.read(offsets[2*nRanks-1]);
 	// Compute the total length of a record
 	allCoresWriteLength = offsets[2*nRanks-1] - offsets[0];
+	dataStart = offsets[0];
       }
       // Now bcast/scatter from IO rank to all
       comms.Broadcast(allCoresWriteLength, comms.GetIORank());
+      comms.Broadcast(dataStart, comms.GetIORank());
       auto start_finish = comms.Scatter(offsets, 2, comms.GetIORank());
       localStart = start_finish[0];
       localStop = start_finish[1];
@@ -66,6 +66,14 @@ namespace hemelb
         uint64_t localStop;
         uint64_t timestep;
         uint64_t allCoresWriteLength;
+        //! Where the first timestep starts, after the headers (and any geometry section).
+        uint64_t dataStart;
+        //! The extraction format version, and the geometry flags if it's geometry-once.
+        uint32_t version;
+        uint32_t geometryFlags = 0;
+        //! For compressed checkpoints, on the IO rank, the offsets of every rank's chunk of
+        //! every timestep, as in the offset file.
+        std::vector<uint64_t> timestepOffsets;
     };
   }
 }
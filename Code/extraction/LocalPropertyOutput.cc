@@ -5,6 +5,9 @@
 // license in the file LICENSE.
 
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <zlib.h>
 #include "extraction/LocalPropertyOutput.h"
 #include "io/formats/formats.h"
 #include "io/formats/extraction.h"
@@ -42,10 +45,82 @@ namespace hemelb
       return ans;
     }
 
+    namespace
+    {
+      // Writes values in this machine's byte order, for geometry-once files with native fields.
+      class NativeWriter
+      {
+        public:
+          NativeWriter(char* start) :
+              current(start)
+          {
+          }
+
+          template<typename T>
+          NativeWriter& operator<<(const T& value)
+          {
+            std::memcpy(current, &value, sizeof(T));
+            current += sizeof(T);
+            return *this;
+          }
+
+        private:
+          char* current;
+      };
+
+      // Rounds values to the nearest multiple of the largest power of two no more than twice
+      // the tolerance, before writing them. So the values change by at most the tolerance, and
+      // their low bits are zero, which compresses well.
+      template<typename WriterT>
+      class QuantisingWriter
+      {
+        public:
+          QuantisingWriter(WriterT& writer, double tolerance) :
+              writer(writer), quantum(std::exp2(std::floor(std::log2(2. * tolerance))))
+          {
+          }
+
+          QuantisingWriter& operator<<(float value)
+          {
+            writer << float(std::round(value / quantum) * quantum);
+            return *this;
+          }
+
+        private:
+          WriterT& writer;
+          const double quantum;
+      };
+
+      // Deflate the values after the first prefixLength bytes of fields into chunk, which
+      // starts with those bytes uncompressed. If there are no values, nothing is added.
+      void CompressChunk(const std::vector<char>& fields, std::size_t prefixLength,
+                         std::vector<char>& chunk)
+      {
+        const uLong valuesLength = fields.size() - prefixLength;
+        uLongf compressedLength = valuesLength ? compressBound(valuesLength) : 0;
+        chunk.resize(prefixLength + compressedLength);
+        std::copy(fields.begin(), fields.begin() + prefixLength, chunk.begin());
+        if (valuesLength)
+        {
+          int ret = compress2(reinterpret_cast<Bytef*>(chunk.data() + prefixLength),
+                              &compressedLength,
+                              reinterpret_cast<const Bytef*>(fields.data() + prefixLength),
+                              valuesLength,
+                              Z_DEFAULT_COMPRESSION);
+          if (ret != Z_OK)
+          {
+            throw Exception() << "Compression error for extraction output";
+          }
+          chunk.resize(prefixLength + compressedLength);
+        }
+      }
+    }
+
     LocalPropertyOutput::LocalPropertyOutput(IterableDataSource& dataSource,
                                              const PropertyOutputFile* outputSpec,
                                              const net::IOCommunicator& ioComms) :
-      comms(ioComms), dataSource(dataSource), outputSpec(outputSpec)
+      comms(ioComms), dataSource(dataSource), outputSpec(outputSpec),
+          writeRequests(BufferCount, MPI_REQUEST_NULL), nextBuffer(0), writtenTimesteps(0)
     {
       // Open the file as write-only, create it if it doesn't exist, don't create if the file
       // already exists.
@@ -60,22 +135,24 @@ namespace hemelb
       offsetFile = net::MpiFile::Open(comms, offsetFileName,
 				      MPI_MODE_WRONLY | MPI_MODE_CREATE | MPI_MODE_EXCL);
 
-      // Count sites on this task
-      uint64_t siteCount = 0;
+      // Find the selected sites on this task
       dataSource.Reset();
-      while (dataSource.ReadNext())
+      for (site_t index = 0; dataSource.ReadNext(); ++index)
       {
         if (outputSpec->geometry->Include(dataSource, dataSource.GetPosition()))
         {
-          ++siteCount;
+          selectedSites.push_back(index);
         }
       }
+      const uint64_t siteCount = selectedSites.size();
 
       // Calculate how long local writes need to be.
 
       // First get the length per-site
-      // Always have 3 uint32's for the position of a site
-      writeLength = 3 * 4;
+      // Unless they're written once, in the geometry section, have 3 uint32's for the position
+      // of a site
+      const bool geometryOnce = outputSpec->geometryOnce;
+      writeLength = geometryOnce ? 0 : 3 * 4;
 
       // Then get add each field's length
       for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
@@ -103,7 +180,7 @@ namespace hemelb
       uint64_t allSiteCount = comms.Reduce(siteCount, MPI_SUM,
                                            comms.GetIORank());
 
-      unsigned totalHeaderLength = 0;
+      uint64_t totalHeaderLength = 0;
 
       // Write the header information on the IO proc.
       if (comms.OnIORank())
@@ -122,13 +199,19 @@ namespace hemelb
         }
 
         totalHeaderLength = io::formats::extraction::MainHeaderLength + fieldHeaderLength;
+        if (geometryOnce)
+        {
+          totalHeaderLength += io::formats::extraction::GeometryHeaderLength;
+        }
 
 	io::writers::xdr::XdrVectorWriter headerWriter;
 
 	// Encoder for ONLY the main header (note shorter length)
 	headerWriter << uint32_t(io::formats::HemeLbMagicNumber)
 		     << uint32_t(io::formats::extraction::MagicNumber)
-		     << uint32_t(io::formats::extraction::VersionNumber);
+		     << (geometryOnce ?
+                         uint32_t(io::formats::extraction::GeometryOnceVersionNumber) :
+                         uint32_t(io::formats::extraction::VersionNumber));
 	headerWriter << double(dataSource.GetVoxelSize());
 	const util::Vector3D<distribn_t> &origin = dataSource.GetOrigin();
 	headerWriter << double(origin[0]) << double(origin[1]) << double(origin[2]);
@@ -144,11 +227,64 @@ namespace hemelb
 		       << GetOffset(outputSpec->fields[outputNumber].type);
 	}
 
+        // Then the geometry header. Native fields are only flagged if they aren't XDR already.
+        if (geometryOnce)
+        {
+          uint32_t flags = 0;
+          if (outputSpec->nativeFields && io::formats::extraction::IsLittleEndian())
+          {
+            flags |= io::formats::extraction::LittleEndianFields;
+          }
+          if (outputSpec->compressFields)
+          {
+            flags |= io::formats::extraction::CompressedFields;
+          }
+          headerWriter << flags;
+        }
+
 	assert(headerWriter.GetBuf().size() == totalHeaderLength);
         // Write from the buffer
         outputFile.WriteAt(0, headerWriter.GetBuf());
       }
 
+      if (geometryOnce)
+      {
+        // Each core writes its sites' coordinates once, after the headers and in the same order
+        // as in every timestep; the timesteps follow them.
+        uint64_t localGeometryOffsetIntoFile;
+        if (comms.OnIORank())
+        {
+          localGeometryOffsetIntoFile = totalHeaderLength;
+          totalHeaderLength += 3 * 4 * allSiteCount;
+          if (comms.Size() > 1)
+          {
+            comms.Send(localGeometryOffsetIntoFile + 3 * 4 * siteCount, 1, 2);
+          }
+        }
+        else
+        {
+          comms.Receive(localGeometryOffsetIntoFile, comms.Rank() - 1, 2);
+          if (comms.Rank() != (comms.Size() - 1))
+          {
+            comms.Send(localGeometryOffsetIntoFile + 3 * 4 * siteCount, comms.Rank() + 1, 2);
+          }
+        }
+
+        if (siteCount > 0)
+        {
+          std::vector<char> geometryBuffer(3 * 4 * siteCount);
+          auto geometryWriter = io::MakeXdrWriter(geometryBuffer.begin(), geometryBuffer.end());
+          for (site_t index : selectedSites)
+          {
+            dataSource.ReadAt(index);
+            const util::Vector3D<site_t>& position = dataSource.GetPosition();
+            geometryWriter << (uint32_t) position.x << (uint32_t) position.y
+                << (uint32_t) position.z;
+          }
+          outputFile.WriteAt(localGeometryOffsetIntoFile, geometryBuffer);
+        }
+      }
+
       // Calculate where each core should start writing
       if (comms.OnIORank())
       {
@@ -172,15 +308,28 @@ namespace hemelb
         }
       }
 
-      // Create the buffer that we'll write each iteration's data into.
-      buffer.resize(writeLength);
+      // Create the buffers that we'll write each iteration's data into. Compressed data are
+      // encoded into another buffer first, and each timestep starts where the last ended.
+      buffers.resize(BufferCount, std::vector<char>(writeLength));
+      if (outputSpec->compressFields)
+      {
+        uncompressedBuffer.resize(writeLength);
+        timestepOffsetIntoFile = totalHeaderLength;
+        comms.Broadcast(timestepOffsetIntoFile, comms.GetIORank());
+      }
 
       WriteOffsetFile();
     }
 
     LocalPropertyOutput::~LocalPropertyOutput()
     {
+      // The buffers mustn't go before the writes from them are done.
+      Flush();
+    }
 
+    void LocalPropertyOutput::Flush()
+    {
+      HEMELB_MPI_CALL(MPI_Waitall, (BufferCount, writeRequests.data(), MPI_STATUSES_IGNORE));
     }
 
     bool LocalPropertyOutput::ShouldWrite(unsigned long timestepNumber) const
@@ -195,20 +344,39 @@ namespace hemelb
 
     void LocalPropertyOutput::Write(unsigned long timestepNumber)
     {
+#ifdef HEMELB_USE_ASYNC_EXTRACTION
+      // Some MPI libraries only move writes on inside MPI calls, so poke them every step.
+      int allDone;
+      HEMELB_MPI_CALL(MPI_Testall,
+                      (BufferCount, writeRequests.data(), &allDone, MPI_STATUSES_IGNORE));
+#endif
+
       // Don't write if we shouldn't this iteration.
       if (!ShouldWrite(timestepNumber))
       {
         return;
       }
 
-      // Don't write if this core doesn't do anything.
-      if (writeLength <= 0)
+#ifdef HEMELB_USE_ASYNC_EXTRACTION
+      // The write is collective, so every core takes part even if it has nothing to write. But
+      // first, the buffer must be free.
+      std::vector<char>& buffer = buffers[nextBuffer];
+      HEMELB_MPI_CALL(MPI_Wait, (&writeRequests[nextBuffer], MPI_STATUS_IGNORE));
+#else
+      // Don't write if this core doesn't do anything. Compressed timesteps depend on every
+      // core's length, though.
+      if (writeLength <= 0 && !outputSpec->compressFields)
       {
         return;
       }
+      std::vector<char>& buffer = buffers[nextBuffer];
+#endif
+      std::vector<char>& fieldBuffer = outputSpec->compressFields ?
+        uncompressedBuffer :
+        buffer;
 
       // Create the buffer.
-      auto xdrWriter = io::MakeXdrWriter(buffer.begin(), buffer.end());
+      auto xdrWriter = io::MakeXdrWriter(fieldBuffer.begin(), fieldBuffer.end());
 
       // Firstly, the IO proc must write the iteration number.
       if (comms.OnIORank())
@@ -216,92 +384,172 @@ namespace hemelb
         xdrWriter << (uint64_t) timestepNumber;
       }
 
-      dataSource.Reset();
-
-      while (dataSource.ReadNext())
+      if (outputSpec->geometryOnce && outputSpec->nativeFields)
       {
-        const util::Vector3D<site_t>& position = dataSource.GetPosition();
-        if (outputSpec->geometry->Include(dataSource, position))
+        // Only the fields remain, after the iteration number.
+        NativeWriter nativeWriter(fieldBuffer.data() + (comms.OnIORank() ? 8 : 0));
+        for (site_t index : selectedSites)
         {
-          // Write the position
-          xdrWriter << (uint32_t) position.x << (uint32_t) position.y << (uint32_t) position.z;
+          dataSource.ReadAt(index);
+          WriteFields(nativeWriter);
+        }
+      }
+      else
+      {
+        for (site_t index : selectedSites)
+        {
+          dataSource.ReadAt(index);
 
-          // Write for each field.
-          for (unsigned outputNumber = 0; outputNumber < outputSpec->fields.size(); ++outputNumber)
+          // Write the position, unless it's in the geometry section
+          if (!outputSpec->geometryOnce)
           {
-            switch (outputSpec->fields[outputNumber].type)
-            {
-              case OutputField::Pressure:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetPressure()
-                    - REFERENCE_PRESSURE_mmHg);
-                break;
-              case OutputField::Velocity:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetVelocity().x)
-                    << static_cast<WrittenDataType> (dataSource.GetVelocity().y)
-                    << static_cast<WrittenDataType> (dataSource.GetVelocity().z);
-                break;
-                //! @TODO: Work out how to handle the different stresses.
-              case OutputField::VonMisesStress:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetVonMisesStress());
-                break;
-              case OutputField::ShearStress:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetShearStress());
-                break;
-              case OutputField::ShearRate:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetShearRate());
-                break;
-              case OutputField::StressTensor:
-              {
-                util::Matrix3D tensor = dataSource.GetStressTensor();
-                // Only the upper triangular part of the symmetric tensor is stored. Storage is row-wise.
-                xdrWriter << static_cast<WrittenDataType> (tensor[0][0])
-                    << static_cast<WrittenDataType> (tensor[0][1])
-                    << static_cast<WrittenDataType> (tensor[0][2])
-                    << static_cast<WrittenDataType> (tensor[1][1])
-                    << static_cast<WrittenDataType> (tensor[1][2])
-                    << static_cast<WrittenDataType> (tensor[2][2]);
-                break;
-              }
-              case OutputField::Traction:
-                xdrWriter << static_cast<WrittenDataType> (dataSource.GetTraction().x)
-                    << static_cast<WrittenDataType> (dataSource.GetTraction().y)
-                    << static_cast<WrittenDataType> (dataSource.GetTraction().z);
-                break;
-              case OutputField::TangentialProjectionTraction:
-                xdrWriter
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().x)
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().y)
-                    << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().z);
-                break;
-              case OutputField::Distributions:
-                unsigned numComponents;
-                const distribn_t *d_ptr;
-                numComponents = dataSource.GetNumVectors();
-                d_ptr = dataSource.GetDistribution();
-                for (int i = 0; i < numComponents; i++)
-		{
-                  xdrWriter << static_cast<WrittenDataType> (*d_ptr);
-		  d_ptr++;
-		}
-                break;
-              case OutputField::MpiRank:
-                xdrWriter
-		  << static_cast<WrittenDataType> (comms.Rank());
-                break;
-              default:
-                // This should never trip. It only occurs when a new OutputField field is added and no
-                // implementation is provided for its serialisation.
-                assert(false);
-            }
+            const util::Vector3D<site_t>& position = dataSource.GetPosition();
+            xdrWriter << (uint32_t) position.x << (uint32_t) position.y << (uint32_t) position.z;
           }
+
+          WriteFields(xdrWriter);
         }
       }
 
+      if (outputSpec->compressFields)
+      {
+        CompressChunk(fieldBuffer, comms.OnIORank() ? 8 : 0, buffer);
+        PlaceCompressedChunk(buffer.size());
+      }
+
       // Actually do the MPI writing.
-      outputFile.WriteAt(localDataOffsetIntoFile, buffer);
+#ifdef HEMELB_USE_ASYNC_EXTRACTION
+      writeRequests[nextBuffer] = outputFile.IWriteAtAll(localDataOffsetIntoFile, buffer);
+      nextBuffer = (nextBuffer + 1) % BufferCount;
+#else
+      if (!buffer.empty())
+      {
+        outputFile.WriteAt(localDataOffsetIntoFile, buffer);
+      }
+#endif
 
-      // Set the offset to the right place for writing on the next iteration.
-      localDataOffsetIntoFile += allCoresWriteLength;
+      // Set the offset to the right place for writing on the next iteration. Compressed
+      // timesteps vary in length, so are placed as they're written.
+      if (!outputSpec->compressFields)
+      {
+        localDataOffsetIntoFile += allCoresWriteLength;
+      }
+    }
+
+    void LocalPropertyOutput::PlaceCompressedChunk(uint64_t chunkLength)
+    {
+      // Each core's chunk follows the previous core's.
+      const std::vector<uint64_t> chunkLengths = comms.AllGather(chunkLength);
+      std::vector<uint64_t> offsets(1, timestepOffsetIntoFile);
+      for (uint64_t length : chunkLengths)
+      {
+        offsets.push_back(offsets.back() + length);
+      }
+
+      localDataOffsetIntoFile = offsets[comms.Rank()];
+      timestepOffsetIntoFile = offsets.back();
+
+      // Record where the chunks are.
+      if (comms.OnIORank())
+      {
+        io::writers::xdr::XdrVectorWriter offsetWriter;
+        for (uint64_t offset : offsets)
+        {
+          offsetWriter << offset;
+        }
+        offsetFile.WriteAt(io::formats::offset::HeaderLength
+                               + writtenTimesteps * offsets.size()
+                                   * io::formats::offset::RecordLength,
+                           offsetWriter.GetBuf());
+      }
+      ++writtenTimesteps;
+    }
+
+    template<typename WriterT>
+    void LocalPropertyOutput::WriteFields(WriterT& writer)
+    {
+      // Write for each field.
+      for (const OutputField& field : outputSpec->fields)
+      {
+        if (field.tolerance > 0.)
+        {
+          QuantisingWriter<WriterT> quantisingWriter(writer, field.tolerance);
+          WriteField(quantisingWriter, field.type);
+        }
+        else
+        {
+          WriteField(writer, field.type);
+        }
+      }
+    }
+
+    template<typename WriterT>
+    void LocalPropertyOutput::WriteField(WriterT& writer, OutputField::FieldType type)
+    {
+      switch (type)
+      {
+        case OutputField::Pressure:
+          writer << static_cast<WrittenDataType> (dataSource.GetPressure()
+              - REFERENCE_PRESSURE_mmHg);
+          break;
+        case OutputField::Velocity:
+          writer << static_cast<WrittenDataType> (dataSource.GetVelocity().x)
+              << static_cast<WrittenDataType> (dataSource.GetVelocity().y)
+              << static_cast<WrittenDataType> (dataSource.GetVelocity().z);
+          break;
+          //! @TODO: Work out how to handle the different stresses.
+        case OutputField::VonMisesStress:
+          writer << static_cast<WrittenDataType> (dataSource.GetVonMisesStress());
+          break;
+        case OutputField::ShearStress:
+          writer << static_cast<WrittenDataType> (dataSource.GetShearStress());
+          break;
+        case OutputField::ShearRate:
+          writer << static_cast<WrittenDataType> (dataSource.GetShearRate());
+          break;
+        case OutputField::StressTensor:
+        {
+          util::Matrix3D tensor = dataSource.GetStressTensor();
+          // Only the upper triangular part of the symmetric tensor is stored. Storage is row-wise.
+          writer << static_cast<WrittenDataType> (tensor[0][0])
+              << static_cast<WrittenDataType> (tensor[0][1])
+              << static_cast<WrittenDataType> (tensor[0][2])
+              << static_cast<WrittenDataType> (tensor[1][1])
+              << static_cast<WrittenDataType> (tensor[1][2])
+              << static_cast<WrittenDataType> (tensor[2][2]);
+          break;
+        }
+        case OutputField::Traction:
+          writer << static_cast<WrittenDataType> (dataSource.GetTraction().x)
+              << static_cast<WrittenDataType> (dataSource.GetTraction().y)
+              << static_cast<WrittenDataType> (dataSource.GetTraction().z);
+          break;
+        case OutputField::TangentialProjectionTraction:
+          writer
+              << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().x)
+              << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().y)
+              << static_cast<WrittenDataType> (dataSource.GetTangentialProjectionTraction().z);
+          break;
+        case OutputField::Distributions:
+          unsigned numComponents;
+          const distribn_t *d_ptr;
+          numComponents = dataSource.GetNumVectors();
+          d_ptr = dataSource.GetDistribution();
+          for (unsigned i = 0; i < numComponents; i++)
+          {
+            writer << static_cast<WrittenDataType> (*d_ptr);
+            d_ptr++;
+          }
+          break;
+        case OutputField::MpiRank:
+          writer
+		  << static_cast<WrittenDataType> (comms.Rank());
+          break;
+        default:
+          // This should never trip. It only occurs when a new OutputField field is added and no
+          // implementation is provided for its serialisation.
+          assert(false);
+      }
     }
 
     // Write the offset file.
@@ -313,12 +561,18 @@ namespace hemelb
 	auto buf = quick_encode(
 				uint32_t(fmt::HemeLbMagicNumber),
 				uint32_t(fmt::offset::MagicNumber),
-				uint32_t(fmt::offset::VersionNumber),
+				outputSpec->compressFields ?
+				  uint32_t(fmt::offset::PerTimestepVersionNumber) :
+				  uint32_t(fmt::offset::VersionNumber),
 				uint32_t(comms.Size())
 				);
 	assert(buf.size() == fmt::offset::HeaderLength);
 	offsetFile.WriteAt(0, buf);
       }
+      // Compressed outputs record the offsets as each timestep is written.
+      if (outputSpec->compressFields) {
+	return;
+      }
       // Every rank writes its offset
       uint64_t offsetForOffset = comms.Rank() * sizeof(localDataOffsetIntoFile)
 	+ fmt::offset::HeaderLength;
@@ -55,10 +55,19 @@ namespace hemelb
 
         /**
          * Write this core's section of the data file. Only writes if appropriate for the current
-         * iteration number
+         * iteration number.
+         *
+         * With HEMELB_USE_ASYNC_EXTRACTION, the write is only started; it carries on while the
+         * simulation does, into one of BufferCount buffers used in turn. Once all the buffers
+         * are in use, a write first waits for the oldest to finish.
          */
         void Write(unsigned long timestepNumber);
 
+        /**
+         * Wait for any writes still in progress to reach the file.
+         */
+        void Flush();
+
 	/**
 	 * Write the offset file
 	 */
@@ -79,6 +88,22 @@ namespace hemelb
 
       private:
 	typedef hemelb::lb::lattices:: HEMELB_LATTICE latticeType;
+
+        /**
+         * Write the fields of the data source's current site, quantising any with a tolerance.
+         */
+        template<typename WriterT>
+        void WriteFields(WriterT& writer);
+
+        template<typename WriterT>
+        void WriteField(WriterT& writer, OutputField::FieldType type);
+
+        /**
+         * Find where this core's compressed chunk of the current timestep goes, and record
+         * every core's in the offset file.
+         */
+        void PlaceCompressedChunk(uint64_t chunkLength);
+
         const net::IOCommunicator& comms;
 
         /**
@@ -112,9 +137,42 @@ namespace hemelb
         uint64_t allCoresWriteLength;
 
         /**
-         * Buffer to write into before writing to disk.
+         * The indices (as for IterableDataSource::ReadAt) of the local sites in the selection.
+         * The geometry doesn't change, so these are found once rather than on every write.
+         */
+        std::vector<site_t> selectedSites;
+
+#ifdef HEMELB_USE_ASYNC_EXTRACTION
+        static const unsigned BufferCount = 2;
+#else
+        static const unsigned BufferCount = 1;
+#endif
+
+        /**
+         * Buffers to write into before writing to disk, used in turn.
+         */
+        std::vector<std::vector<char> > buffers;
+
+        /**
+         * The write in progress from each buffer, or MPI_REQUEST_NULL.
+         */
+        std::vector<MPI_Request> writeRequests;
+
+        /**
+         * The buffer the next write goes in.
+         */
+        unsigned nextBuffer;
+
+        /**
+         * With compression, the buffer the data are encoded into before being compressed.
+         */
+        std::vector<char> uncompressedBuffer;
+
+        /**
+         * With compression, where the next timestep starts, and how many have been written.
          */
-        std::vector<char> buffer;
+        uint64_t timestepOffsetIntoFile;
+        uint64_t writtenTimesteps;
 
         /**
          * The MPI file to write the offsets into.
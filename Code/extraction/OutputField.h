@@ -30,6 +30,8 @@ namespace hemelb
 
         std::string name;
         FieldType type;
+        //! If positive, the values may be rounded by up to this much, so they compress better.
+        double tolerance = 0.;
     };
   }
 }
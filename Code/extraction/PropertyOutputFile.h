@@ -24,6 +24,12 @@ namespace hemelb
         unsigned long frequency;
         std::unique_ptr<GeometrySelector> geometry;
         std::vector<OutputField> fields;
+        //! Write the site coordinates once, rather than with every timestep (format version 5).
+        bool geometryOnce = false;
+        //! With geometryOnce, write the field values in this machine's byte order, not XDR's.
+        bool nativeFields = false;
+        //! With geometryOnce, zlib compress each core's field values for each timestep.
+        bool compressFields = false;
     };
   }
 }
@@ -0,0 +1,209 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DISTRIBUTIONLAYOUT_H
+#define HEMELB_GEOMETRY_DISTRIBUTIONLAYOUT_H
+
+#include "units.h"
+
+#ifndef HEMELB_SIMD_WIDTH
+#define HEMELB_SIMD_WIDTH 4
+#endif
+
+#ifndef HEMELB_DISTRIBUTION_LAYOUT
+#define HEMELB_DISTRIBUTION_LAYOUT AOS
+#endif
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * The classes in this file map a (local contiguous site index, direction) pair onto a
+     * position in the distribution arrays held by LatticeData. The names of the classes must
+     * correspond to the options given for the CMake HEMELB_DISTRIBUTION_LAYOUT parameter.
+     *
+     * Every layout stores the local distributions in [0, GetLocalDistributionCount()). This is
+     * followed by one 'rubbish' slot (for streaming out of the domain) and then by the
+     * distributions shared with neighbouring processors, so the tail of the arrays looks the
+     * same whatever the layout.
+     *
+     * Layouts in which a site's distributions are not contiguous (IsSiteContiguous == false)
+     * have to be gathered into a scratch buffer before being handed to a kernel.
+     */
+
+    /**
+     * Array of structures: the distributions of each site are contiguous. This is the
+     * historical HemeLB layout.
+     */
+    class AOS
+    {
+      public:
+        static const bool IsSiteContiguous = true;
+        static const site_t SiteGranularity = 1;
+
+        AOS() :
+            numVectors(0), paddedSiteCount(0)
+        {
+        }
+
+        void Initialise(site_t siteCount, Direction numVectorsIn)
+        {
+          numVectors = numVectorsIn;
+          paddedSiteCount = siteCount;
+        }
+
+        inline site_t GetIndex(site_t siteIndex, Direction direction) const
+        {
+          return siteIndex * numVectors + direction;
+        }
+
+        template<typename LatticeType>
+        inline site_t GetIndex(site_t siteIndex, Direction direction) const
+        {
+          return siteIndex * LatticeType::NUMVECTORS + direction;
+        }
+
+        /**
+         * Get the distance between the distributions of the same direction at two consecutive
+         * sites.
+         */
+        inline site_t GetSiteStride() const
+        {
+          return numVectors;
+        }
+
+        inline site_t GetPaddedSiteCount() const
+        {
+          return paddedSiteCount;
+        }
+
+        inline site_t GetLocalDistributionCount() const
+        {
+          return paddedSiteCount * numVectors;
+        }
+
+      private:
+        Direction numVectors;
+        site_t paddedSiteCount;
+    };
+
+    /**
+     * Structure of arrays: the distributions for each direction are contiguous across sites,
+     * so that a collision kernel can load the same direction for neighbouring sites into one
+     * SIMD register. The site count is padded to a whole number of SIMD vectors.
+     */
+    class SOA
+    {
+      public:
+        static const bool IsSiteContiguous = false;
+        static const site_t SiteGranularity = HEMELB_SIMD_WIDTH;
+
+        SOA() :
+            numVectors(0), paddedSiteCount(0)
+        {
+        }
+
+        void Initialise(site_t siteCount, Direction numVectorsIn)
+        {
+          numVectors = numVectorsIn;
+          paddedSiteCount = ( (siteCount + SiteGranularity - 1) / SiteGranularity) * SiteGranularity;
+        }
+
+        inline site_t GetIndex(site_t siteIndex, Direction direction) const
+        {
+          return direction * paddedSiteCount + siteIndex;
+        }
+
+        template<typename LatticeType>
+        inline site_t GetIndex(site_t siteIndex, Direction direction) const
+        {
+          return direction * paddedSiteCount + siteIndex;
+        }
+
+        inline site_t GetSiteStride() const
+        {
+          return 1;
+        }
+
+        inline site_t GetPaddedSiteCount() const
+        {
+          return paddedSiteCount;
+        }
+
+        inline site_t GetLocalDistributionCount() const
+        {
+          return paddedSiteCount * numVectors;
+        }
+
+      private:
+        Direction numVectors;
+        site_t paddedSiteCount;
+    };
+
+    /**
+     * Array of structures of arrays: sites are grouped into tiles of HEMELB_SIMD_WIDTH, and
+     * within a tile the distributions are stored direction by direction. This keeps the SIMD
+     * friendliness of SOA while keeping all the data for a site within a few cache lines.
+     */
+    class AOSOA
+    {
+      public:
+        static const bool IsSiteContiguous = false;
+        static const site_t SiteGranularity = HEMELB_SIMD_WIDTH;
+
+        AOSOA() :
+            numVectors(0), paddedSiteCount(0)
+        {
+        }
+
+        void Initialise(site_t siteCount, Direction numVectorsIn)
+        {
+          numVectors = numVectorsIn;
+          paddedSiteCount = ( (siteCount + SiteGranularity - 1) / SiteGranularity) * SiteGranularity;
+        }
+
+        inline site_t GetIndex(site_t siteIndex, Direction direction) const
+        {
+          return (siteIndex / SiteGranularity) * SiteGranularity * numVectors + direction * SiteGranularity
+              + siteIndex % SiteGranularity;
+        }
+
+        template<typename LatticeType>
+        inline site_t GetIndex(site_t siteIndex, Direction direction) const
+        {
+          return (siteIndex / SiteGranularity) * SiteGranularity * LatticeType::NUMVECTORS
+              + direction * SiteGranularity + siteIndex % SiteGranularity;
+        }
+
+        /**
+         * Consecutive sites are only a unit stride apart within a tile.
+         */
+        inline site_t GetSiteStride() const
+        {
+          return 1;
+        }
+
+        inline site_t GetPaddedSiteCount() const
+        {
+          return paddedSiteCount;
+        }
+
+        inline site_t GetLocalDistributionCount() const
+        {
+          return paddedSiteCount * numVectors;
+        }
+
+      private:
+        Direction numVectors;
+        site_t paddedSiteCount;
+    };
+
+    // Use the layout specified through the build system.
+    typedef HEMELB_DISTRIBUTION_LAYOUT DistributionLayout;
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DISTRIBUTIONLAYOUT_H */
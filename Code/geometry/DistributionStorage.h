@@ -0,0 +1,99 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DISTRIBUTIONSTORAGE_H
+#define HEMELB_GEOMETRY_DISTRIBUTIONSTORAGE_H
+
+#include "units.h"
+
+#ifndef HEMELB_DISTRIBUTION_STORAGE
+#define HEMELB_DISTRIBUTION_STORAGE DOUBLE
+#endif
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * The classes in this file select the type LatticeData keeps the distributions in, and how
+     * they are converted to and from distribn_t. Collisions are always done in distribn_t.
+     * The names of the classes must correspond to the options given for the CMake
+     * HEMELB_DISTRIBUTION_STORAGE parameter.
+     *
+     * Load and Store are passed the lattice weight of the distribution's direction (which is
+     * the same as that of the inverse direction, so it doesn't matter which of the two a
+     * bounced-back or in-place streamed value is filed under).
+     */
+
+    /**
+     * Store the distributions as distribn_t. This is the historical HemeLB behaviour.
+     */
+    class DOUBLE
+    {
+      public:
+        typedef distribn_t Type;
+        //! Whether the stored values can be handed to a kernel without conversion.
+        static const bool IsNative = true;
+
+        inline static distribn_t Load(Type stored, distribn_t weight)
+        {
+          return stored;
+        }
+
+        inline static Type Store(distribn_t value, distribn_t weight)
+        {
+          return value;
+        }
+    };
+
+    /**
+     * Store the distributions as floats, halving the memory traffic and the size of the halo
+     * messages at the cost of about seven significant figures.
+     */
+    class FLOAT
+    {
+      public:
+        typedef float Type;
+        static const bool IsNative = false;
+
+        inline static distribn_t Load(Type stored, distribn_t weight)
+        {
+          return stored;
+        }
+
+        inline static Type Store(distribn_t value, distribn_t weight)
+        {
+          return static_cast<Type>(value);
+        }
+    };
+
+    /**
+     * Store f - w as floats, where w is the distribution at rest at unit density. Near
+     * equilibrium, this leaves the float's precision to the (small) deviation from rest rather
+     * than spending it on the bulk value, so in practice it is much more accurate than FLOAT.
+     */
+    class SHIFTEDFLOAT
+    {
+      public:
+        typedef float Type;
+        static const bool IsNative = false;
+
+        inline static distribn_t Load(Type stored, distribn_t weight)
+        {
+          return weight + stored;
+        }
+
+        inline static Type Store(distribn_t value, distribn_t weight)
+        {
+          return static_cast<Type>(value - weight);
+        }
+    };
+
+    // Use the storage specified through the build system.
+    typedef HEMELB_DISTRIBUTION_STORAGE DistributionStorage;
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DISTRIBUTIONSTORAGE_H */
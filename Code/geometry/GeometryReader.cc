@@ -69,8 +69,10 @@ namespace hemelb
 
     GeometryReader::GeometryReader(const bool reserveSteeringCore,
                                    const lb::lattices::LatticeInfo& latticeInfo,
-                                   reporting::Timers &atimings, const net::IOCommunicator& ioComm) :
-      latticeInfo(latticeInfo), hemeLbComms(ioComm), timings(atimings)
+                                   reporting::Timers &atimings, const net::IOCommunicator& ioComm,
+                                   const decomposition::CollisionCosts* collisionCosts) :
+      latticeInfo(latticeInfo), hemeLbComms(ioComm), timings(atimings),
+          collisionCosts(collisionCosts)
     {
       // This rank should participate in the domain decomposition if
       //  - there's no steering core (then all ranks are involved)
@@ -354,16 +356,31 @@ namespace hemelb
       // Next we spread round the lists of which blocks each core needs access to.
       log::Logger::Log<log::Debug, log::OnePerCore>("Informing reading cores of block needs");
       net::Net net = net::Net(computeComms);
+      const proc_t readingGroupSize = util::NumericalFunctions::min(READING_GROUP_SIZE,
+                                                                    computeComms.Size());
+#ifdef HEMELB_USE_AGGREGATED_GEOMETRY_READING
+      BlockReadingPlan plan(bytesPerCompressedBlock, readingGroupSize, AGGREGATED_READ_CHUNK_BYTES);
       Needs needs(geometry.GetBlockCount(),
                   readBlock,
-                  util::NumericalFunctions::min(READING_GROUP_SIZE, computeComms.Size()),
+                  readingGroupSize,
+                  net,
+                  ShouldValidate(),
+                  plan.GetReaderForEachBlock());
+#else
+      Needs needs(geometry.GetBlockCount(),
+                  readBlock,
+                  readingGroupSize,
                   net,
                   ShouldValidate());
+#endif
 
       timings[hemelb::reporting::Timers::readBlocksPrelim].Stop();
       log::Logger::Log<log::Debug, log::OnePerCore>("Reading blocks");
       timings[hemelb::reporting::Timers::readBlocksAll].Start();
 
+#ifdef HEMELB_USE_AGGREGATED_GEOMETRY_READING
+      ReadInBlocksAggregated(geometry, readBlock, needs, plan);
+#else
       // Set the initial offset to the first block, which will be updated as we progress
       // through the blocks.
       MPI_Offset offset = gmy::PreambleLength
@@ -382,10 +399,204 @@ namespace hemelb
         // Update the offset to be ready for the next block.
         offset += bytesPerCompressedBlock[nextBlockToRead];
       }
+#endif
 
       timings[hemelb::reporting::Timers::readBlocksAll].Stop();
     }
 
+    void GeometryReader::ReadInBlocksAggregated(Geometry& geometry,
+                                                const std::vector<bool>& readBlock,
+                                                const Needs& needs, const BlockReadingPlan& plan)
+    {
+      const proc_t localRank = computeComms.Rank();
+      const proc_t readingGroupSize = util::NumericalFunctions::min(READING_GROUP_SIZE,
+                                                                    computeComms.Size());
+      const MPI_Offset dataStart = gmy::PreambleLength + GetHeaderLength(geometry.GetBlockCount());
+
+      // Whether a block's data comes to this rank: those without fluid sites aren't sent.
+      auto isWantedHere = [&] (site_t block)
+      {
+        return readBlock[block] && fluidSitesOnEachBlock[block] > 0;
+      };
+
+      // Blocks from a previous read that we don't need any more.
+      for (site_t block = 0; block < geometry.GetBlockCount(); ++block)
+      {
+        if (!readBlock[block] && !geometry.Blocks[block].Sites.empty())
+        {
+          geometry.Blocks[block].Sites = std::vector<GeometrySite>(0, GeometrySite(false));
+        }
+      }
+
+      // Everything for one round, which must stay put until it has been parsed.
+      struct Round
+      {
+          unsigned int number;
+          //! This rank's chunk, if it is a reading core.
+          std::vector<char> chunk;
+          MPI_Request readRequest;
+          //! The blocks for each other rank from this rank's chunk.
+          std::map<proc_t, std::vector<char> > sends;
+          //! The blocks from each other reading core's chunk.
+          std::map<proc_t, std::vector<char> > receives;
+          std::vector<MPI_Request> messageRequests;
+      };
+
+      // All ranks take part in each round's collective read, even with nothing to read.
+      auto startRead = [&] (Round& round, unsigned int number)
+      {
+        round.number = number;
+        site_t firstBlock = 0, endBlock = 0;
+        if (localRank < readingGroupSize)
+        {
+          plan.GetChunk(localRank, number, firstBlock, endBlock);
+        }
+        round.chunk.resize(plan.GetBlockOffset(endBlock) - plan.GetBlockOffset(firstBlock));
+        round.readRequest = file.IReadAtAll(dataStart + plan.GetBlockOffset(firstBlock),
+                                            round.chunk);
+      };
+
+      auto startMessages = [&] (Round& round)
+      {
+        for (proc_t reader = 0; reader < readingGroupSize; ++reader)
+        {
+          if (reader == localRank)
+          {
+            continue;
+          }
+          site_t firstBlock, endBlock;
+          plan.GetChunk(reader, round.number, firstBlock, endBlock);
+          unsigned int bytes = 0;
+          for (site_t block = firstBlock; block < endBlock; ++block)
+          {
+            if (isWantedHere(block))
+            {
+              bytes += bytesPerCompressedBlock[block];
+            }
+          }
+          if (bytes > 0)
+          {
+            std::vector<char>& buffer = round.receives[reader];
+            buffer.resize(bytes);
+            round.messageRequests.push_back(MPI_REQUEST_NULL);
+            HEMELB_MPI_CALL(MPI_Irecv,
+                            (buffer.data(), bytes, MPI_CHAR, reader, BLOCK_DATA_TAG, computeComms,
+                             &round.messageRequests.back()));
+          }
+        }
+
+        if (localRank >= readingGroupSize)
+        {
+          return;
+        }
+        // Pack each rank's blocks, in order, into one message.
+        site_t firstBlock, endBlock;
+        plan.GetChunk(localRank, round.number, firstBlock, endBlock);
+        for (site_t block = firstBlock; block < endBlock; ++block)
+        {
+          if (fluidSitesOnEachBlock[block] <= 0)
+          {
+            continue;
+          }
+          const char* blockData = round.chunk.data() + plan.GetBlockOffset(block)
+              - plan.GetBlockOffset(firstBlock);
+          for (proc_t receiver : needs.ProcessorsNeedingBlock(block))
+          {
+            if (receiver != localRank)
+            {
+              std::vector<char>& buffer = round.sends[receiver];
+              buffer.insert(buffer.end(), blockData, blockData + bytesPerCompressedBlock[block]);
+            }
+          }
+        }
+        for (auto& send : round.sends)
+        {
+          round.messageRequests.push_back(MPI_REQUEST_NULL);
+          HEMELB_MPI_CALL(MPI_Isend,
+                          (send.second.data(), send.second.size(), MPI_CHAR, send.first,
+                           BLOCK_DATA_TAG, computeComms, &round.messageRequests.back()));
+        }
+      };
+
+      auto parse = [&] (const Round& round)
+      {
+        timings[hemelb::reporting::Timers::readParse].Start();
+        for (proc_t reader = 0; reader < readingGroupSize; ++reader)
+        {
+          site_t firstBlock, endBlock;
+          plan.GetChunk(reader, round.number, firstBlock, endBlock);
+          if (firstBlock == endBlock)
+          {
+            continue;
+          }
+          // Our own chunk is all there; the others have only the blocks we need, in order.
+          const bool isOwnChunk = reader == localRank;
+          auto received = round.receives.find(reader);
+          const char* data = isOwnChunk ?
+            round.chunk.data() :
+            (received == round.receives.end() ?
+              nullptr :
+              received->second.data());
+          for (site_t block = firstBlock; block < endBlock; ++block)
+          {
+            if (isOwnChunk)
+            {
+              data = round.chunk.data() + plan.GetBlockOffset(block)
+                  - plan.GetBlockOffset(firstBlock);
+            }
+            if (isWantedHere(block))
+            {
+              ParseCompressedBlock(geometry, block, data, bytesPerCompressedBlock[block]);
+              if (!isOwnChunk)
+              {
+                data += bytesPerCompressedBlock[block];
+              }
+            }
+          }
+        }
+        timings[hemelb::reporting::Timers::readParse].Stop();
+      };
+
+      const unsigned int roundCount = plan.GetRoundCount();
+      Round previous, current, next;
+      if (roundCount > 0)
+      {
+        startRead(current, 0);
+      }
+
+      // Each round, pass on the chunk just read and start reading the next while parsing the
+      // blocks from the round before.
+      for (unsigned int round = 0; round <= roundCount; ++round)
+      {
+        if (round < roundCount)
+        {
+          timings[hemelb::reporting::Timers::readBlock].Start();
+          HEMELB_MPI_CALL(MPI_Wait, (&current.readRequest, MPI_STATUS_IGNORE));
+          timings[hemelb::reporting::Timers::readBlock].Stop();
+          startMessages(current);
+        }
+        if (round + 1 < roundCount)
+        {
+          startRead(next, round + 1);
+        }
+        if (round > 0)
+        {
+          parse(previous);
+        }
+        if (round < roundCount)
+        {
+          timings[hemelb::reporting::Timers::readNet].Start();
+          HEMELB_MPI_CALL(MPI_Waitall,
+                          (current.messageRequests.size(), current.messageRequests.data(), MPI_STATUSES_IGNORE));
+          timings[hemelb::reporting::Timers::readNet].Stop();
+        }
+        // Moving the vectors keeps their storage, so the read into next can carry on.
+        previous = std::move(current);
+        current = std::move(next);
+        next = Round();
+      }
+    }
+
     void GeometryReader::ReadInBlock(MPI_Offset offsetSoFar, Geometry& geometry,
                                      const std::vector<proc_t>& procsWantingThisBlock,
                                      const site_t blockNumber, const bool neededOnThisRank)
@@ -436,43 +647,55 @@ namespace hemelb
       timings[hemelb::reporting::Timers::readParse].Start();
       if (neededOnThisRank)
       {
-        // Create an Xdr interpreter.
-        std::vector<char> blockData = DecompressBlockData(compressedBlockData,
-                                                          bytesPerUncompressedBlock[blockNumber]);
-        io::writers::xdr::XdrMemReader lReader(&blockData.front(), blockData.size());
+        ParseCompressedBlock(geometry,
+                             blockNumber,
+                             compressedBlockData.data(),
+                             compressedBlockData.size());
+      }
+      else if (!geometry.Blocks[blockNumber].Sites.empty())
+      {
+        geometry.Blocks[blockNumber].Sites = std::vector<GeometrySite>(0, GeometrySite(false));
+      }
+      timings[hemelb::reporting::Timers::readParse].Stop();
+    }
 
-        ParseBlock(geometry, blockNumber, lReader);
+    void GeometryReader::ParseCompressedBlock(Geometry& geometry, const site_t blockNumber,
+                                              const char* compressed,
+                                              const unsigned int compressedBytes)
+    {
+      // Create an Xdr interpreter.
+      std::vector<char> blockData = DecompressBlockData(compressed,
+                                                        compressedBytes,
+                                                        bytesPerUncompressedBlock[blockNumber]);
+      io::writers::xdr::XdrMemReader lReader(&blockData.front(), blockData.size());
 
-        // If debug-level logging, check that we've read in as many sites as anticipated.
-        if (ShouldValidate())
+      ParseBlock(geometry, blockNumber, lReader);
+
+      // If debug-level logging, check that we've read in as many sites as anticipated.
+      if (ShouldValidate())
+      {
+        // Count the sites read,
+        site_t numSitesRead = 0;
+        for (site_t site = 0; site < geometry.GetSitesPerBlock(); ++site)
         {
-          // Count the sites read,
-          site_t numSitesRead = 0;
-          for (site_t site = 0; site < geometry.GetSitesPerBlock(); ++site)
-          {
-            if (geometry.Blocks[blockNumber].Sites[site].targetProcessor != SITE_OR_BLOCK_SOLID)
-            {
-              ++numSitesRead;
-            }
-          }
-          // Compare with the sites we expected to read.
-          if (numSitesRead != fluidSitesOnEachBlock[blockNumber])
+          if (geometry.Blocks[blockNumber].Sites[site].targetProcessor != SITE_OR_BLOCK_SOLID)
           {
-            log::Logger::Log<log::Error, log::OnePerCore>("Was expecting %i fluid sites on block %i but actually read %i",
-                                                          fluidSitesOnEachBlock[blockNumber],
-                                                          blockNumber,
-                                                          numSitesRead);
+            ++numSitesRead;
           }
         }
+        // Compare with the sites we expected to read.
+        if (numSitesRead != fluidSitesOnEachBlock[blockNumber])
+        {
+          log::Logger::Log<log::Error, log::OnePerCore>("Was expecting %i fluid sites on block %i but actually read %i",
+                                                        fluidSitesOnEachBlock[blockNumber],
+                                                        blockNumber,
+                                                        numSitesRead);
+        }
       }
-      else if (!geometry.Blocks[blockNumber].Sites.empty())
-      {
-        geometry.Blocks[blockNumber].Sites = std::vector<GeometrySite>(0, GeometrySite(false));
-      }
-      timings[hemelb::reporting::Timers::readParse].Stop();
     }
 
-    std::vector<char> GeometryReader::DecompressBlockData(const std::vector<char>& compressed,
+    std::vector<char> GeometryReader::DecompressBlockData(const char* compressed,
+                                                          const unsigned int compressedBytes,
                                                           const unsigned int uncompressedBytes)
     {
       timings[hemelb::reporting::Timers::unzip].Start();
@@ -487,8 +710,8 @@ namespace hemelb
       stream.zalloc = Z_NULL;
       stream.zfree = Z_NULL;
       stream.opaque = Z_NULL;
-      stream.avail_in = compressed.size();
-      stream.next_in = reinterpret_cast<unsigned char*> (const_cast<char*> (&compressed.front()));
+      stream.avail_in = compressedBytes;
+      stream.next_in = reinterpret_cast<unsigned char*> (const_cast<char*> (compressed));
 
       ret = inflateInit(&stream);
       if (ret != Z_OK)
@@ -794,7 +1017,8 @@ namespace hemelb
                                                       geometry,
                                                       latticeInfo,
                                                       procForEachBlock,
-                                                      fluidSitesOnEachBlock);
+                                                      fluidSitesOnEachBlock,
+                                                      collisionCosts);
 
       timings[hemelb::reporting::Timers::reRead].Start();
       log::Logger::Log<log::Debug, log::OnePerCore>("Rereading blocks");
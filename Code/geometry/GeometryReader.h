@@ -20,6 +20,8 @@
 #include "units.h"
 #include "geometry/Geometry.h"
 #include "geometry/needs/Needs.h"
+#include "geometry/needs/BlockReadingPlan.h"
+#include "geometry/decomposition/CollisionCosts.h"
 
 #include "net/MpiFile.h"
 
@@ -33,8 +35,13 @@ namespace hemelb
       public:
         typedef util::Vector3D<site_t> BlockLocation;
 
+        /**
+         * @param collisionCosts measured costs to weight the sites by when optimising the
+         * decomposition, or NULL to use the built-in weights
+         */
         GeometryReader(const bool reserveSteeringCore, const lb::lattices::LatticeInfo&,
-                       reporting::Timers &timings, const net::IOCommunicator& ioComm);
+                       reporting::Timers &timings, const net::IOCommunicator& ioComm,
+                       const decomposition::CollisionCosts* collisionCosts = NULL);
         ~GeometryReader();
 
         Geometry LoadAndDecompose(const std::string& dataFilePath);
@@ -91,15 +98,43 @@ namespace hemelb
                          const site_t blockNumber,
                          const bool neededOnThisRank);
 
+        /**
+         * Read the blocks needed here, with each reading core reading its contiguous run of
+         * blocks (from the plan) a large chunk per round, with a collective read. Each reading
+         * core sends each rank all the blocks it needs from the chunk in one message. The next
+         * chunk is read and this round's messages are in flight while the previous round's
+         * blocks are decompressed and parsed.
+         *
+         * @param geometry [out] The geometry object to populate.
+         * @param readBlock [in] Whether each block is needed on this rank.
+         * @param needs [in] Which ranks need each block read on this rank.
+         * @param plan [in] The chunks each reading core reads, which the needs must agree with.
+         */
+        void ReadInBlocksAggregated(Geometry& geometry, const std::vector<bool>& readBlock,
+                                    const Needs& needs, const BlockReadingPlan& plan);
+
+        /**
+         * Decompress a block, parse it into the geometry and, if validating, check it had
+         * the expected number of fluid sites.
+         * @param geometry
+         * @param blockNumber
+         * @param compressed the compressed block data
+         * @param compressedBytes
+         */
+        void ParseCompressedBlock(Geometry& geometry, const site_t blockNumber,
+                                  const char* compressed, const unsigned int compressedBytes);
+
         /**
          * Decompress the block data. Uses the known number of sites to get an
          * upper bound on the uncompressed data to simplify the code and avoid
          * reallocation.
          * @param compressed
-         * @param sites
+         * @param compressedBytes
+         * @param uncompressedBytes
          * @return
          */
-        std::vector<char> DecompressBlockData(const std::vector<char>& compressed,
+        std::vector<char> DecompressBlockData(const char* compressed,
+                                              const unsigned int compressedBytes,
                                               const unsigned int uncompressedBytes);
 
         void ParseBlock(Geometry& geometry, const site_t block, io::writers::xdr::XdrReader& reader);
@@ -160,6 +195,11 @@ namespace hemelb
         static const proc_t HEADER_READING_RANK = 0;
         //! The number of cores (0-READING_GROUP_SIZE-1) that read files in parallel
         static const proc_t READING_GROUP_SIZE = HEMELB_READING_GROUP_SIZE;
+        //! The most each reading core reads in one round of aggregated reading (unless a
+        //! single block is longer).
+        static const unsigned int AGGREGATED_READ_CHUNK_BYTES = 16 * 1024 * 1024;
+        //! The tag for the block data sent from the reading cores in aggregated reading.
+        static const int BLOCK_DATA_TAG = 1;
 
         //! Info about the connectivity of the lattice.
         const lb::lattices::LatticeInfo& latticeInfo;
@@ -183,6 +223,8 @@ namespace hemelb
 
         //! Timings object for recording the time taken for each step of the domain decomposition.
         hemelb::reporting::Timers &timings;
+        //! The measured cost of each site type, or NULL.
+        const decomposition::CollisionCosts* collisionCosts;
     };
   }
 }
@@ -4,8 +4,10 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include <map>
 #include <limits>
+#include <utility>
 
 #include "log/Logger.h"
 #include "net/IOCommunicator.h"
@@ -19,17 +21,18 @@ namespace hemelb
   namespace geometry
   {
     LatticeData::LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const net::IOCommunicator& comms_) :
-        latticeInfo(latticeInfo), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
+        latticeInfo(latticeInfo), oddStep(false), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_), haloExchange(NULL)
     {
     }
 
     LatticeData::~LatticeData()
     {
+      delete haloExchange;
       delete neighbouringData;
     }
 
     LatticeData::LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const Geometry& readResult, const net::IOCommunicator& comms_) :
-        latticeInfo(latticeInfo), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_)
+        latticeInfo(latticeInfo), oddStep(false), neighbouringData(new neighbouring::NeighbouringLatticeData(latticeInfo)), comms(comms_), haloExchange(NULL)
     {
       SetBasicDetails(readResult.GetBlockDimensions(),
                       readResult.GetBlockSize());
@@ -259,6 +262,23 @@ namespace hemelb
 
       }
 
+      if (!SiteOrdering::IsNatural)
+      {
+        for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; collisionType++)
+        {
+          OrderSites(midDomainBlockNumber[collisionType],
+                     midDomainSiteNumber[collisionType],
+                     midDomainSiteData[collisionType],
+                     midDomainWallNormals[collisionType],
+                     midDomainWallDistance[collisionType]);
+          OrderSites(domainEdgeBlockNumber[collisionType],
+                     domainEdgeSiteNumber[collisionType],
+                     domainEdgeSiteData[collisionType],
+                     domainEdgeWallNormals[collisionType],
+                     domainEdgeWallDistance[collisionType]);
+        }
+      }
+
       PopulateWithReadData(midDomainBlockNumber,
                            midDomainSiteNumber,
                            midDomainSiteData,
@@ -271,6 +291,62 @@ namespace hemelb
                            domainEdgeWallDistance);
     }
 
+    namespace
+    {
+      // Rearrange values, in groups of stride, into the given order of the groups.
+      template<typename T>
+      void Permute(std::vector<T>& values, const std::vector<site_t>& order, site_t stride)
+      {
+        std::vector<T> permuted;
+        permuted.reserve(values.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+          for (site_t offset = 0; offset < stride; ++offset)
+          {
+            permuted.push_back(values[order[i] * stride + offset]);
+          }
+        }
+        values.swap(permuted);
+      }
+    }
+
+    void LatticeData::OrderSites(std::vector<site_t>& blockNumbers,
+                                 std::vector<site_t>& siteNumbers,
+                                 std::vector<SiteData>& siteDataForType,
+                                 std::vector<util::Vector3D<float> >& wallNormals,
+                                 std::vector<float>& wallDistance) const
+    {
+      // Sort by (block key, key within the block), which keeps each block's sites together.
+      const util::Vector3D<site_t> blockExtents(blockSize);
+      std::vector<std::pair<std::pair<std::uint64_t, std::uint64_t>, site_t> > keys(blockNumbers.size());
+      for (std::size_t i = 0; i < blockNumbers.size(); ++i)
+      {
+        keys[i].first.first = GetBlockOrderKey(blockNumbers[i]);
+        keys[i].first.second = SiteOrdering::GetKey(GetSiteCoordsFromSiteId(siteNumbers[i]), blockExtents);
+        keys[i].second = i;
+      }
+      std::sort(keys.begin(), keys.end());
+
+      std::vector<site_t> order(keys.size());
+      for (std::size_t i = 0; i < keys.size(); ++i)
+      {
+        order[i] = keys[i].second;
+      }
+
+      Permute(blockNumbers, order, 1);
+      Permute(siteNumbers, order, 1);
+      Permute(siteDataForType, order, 1);
+      Permute(wallNormals, order, 1);
+      Permute(wallDistance, order, latticeInfo.GetNumVectors() - 1);
+    }
+
+    std::uint64_t LatticeData::GetBlockOrderKey(site_t blockId) const
+    {
+      util::Vector3D<site_t> blockCoords;
+      GetBlockIJK(blockId, blockCoords);
+      return SiteOrdering::GetKey(blockCoords, blockCounts);
+    }
+
     void LatticeData::CollectFluidSiteDistribution()
     {
       hemelb::log::Logger::Log<hemelb::log::Debug, hemelb::log::Singleton>("Gathering lattice info.");
@@ -341,19 +417,28 @@ namespace hemelb
       {
         // Pointing to a few things, but not setting any variables.
         // FirstSharedF points to start of shared_fs.
-        neighbouringProcs[neighbourId].FirstSharedDistribution = GetLocalFluidSiteCount() * latticeInfo.GetNumVectors()
-            + 1 + totalSharedDistributionsSoFar;
+        neighbouringProcs[neighbourId].FirstSharedDistribution = GetRubbishDistributionIndex() + 1
+            + totalSharedDistributionsSoFar;
         totalSharedDistributionsSoFar += neighbouringProcs[neighbourId].SharedDistributionCount;
       }
       InitialiseNeighbourLookup(sharedDistributionLocationForEachProc);
       InitialisePointToPointComms(sharedDistributionLocationForEachProc);
       InitialiseReceiveLookup(sharedDistributionLocationForEachProc);
+#ifdef HEMELB_USE_PERSISTENT_HALO
+      InitialiseHaloExchange();
+#endif
+      neighbourIndices.Finalise();
+      log::Logger::Log<log::Debug, log::OnePerCore>("LatticeData: the neighbour lookup takes %lu bytes\n",
+                                                    (unsigned long) GetNeighbourLookupByteCount());
     }
 
     void LatticeData::InitialiseNeighbourLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc)
     {
       const proc_t localRank = comms.Rank();
-      neighbourIndices.resize(latticeInfo.GetNumVectors() * localFluidSites);
+      // Any padding sites introduced by the distribution layout stream to the rubbish site.
+      neighbourIndices.Initialise(distributionLayout.GetLocalDistributionCount(),
+                                  GetRubbishDistributionIndex(),
+                                  GetRubbishDistributionIndex() + 1 + totalSharedFs);
       for (BlockTraverser blockTraverser(*this); blockTraverser.CurrentLocationValid(); blockTraverser.TraverseOne())
       {
         const Block& map_block_p = blockTraverser.GetCurrentBlockData();
@@ -372,7 +457,7 @@ namespace hemelb
           site_t localIndex = map_block_p.GetLocalContiguousIndexForSite(siteTraverser.GetCurrentIndex());
           // Set neighbour location for the distribution component at the centre of
           // this site.
-          SetNeighbourLocation(localIndex, 0, localIndex * latticeInfo.GetNumVectors() + 0);
+          SetNeighbourLocation(localIndex, 0, GetDistributionIndex(localIndex, 0));
           for (Direction direction = 1; direction < latticeInfo.GetNumVectors(); direction++)
           {
             util::Vector3D<site_t> currentLocationCoords = blockTraverser.GetCurrentLocation() * blockSize
@@ -383,7 +468,7 @@ namespace hemelb
             if (!IsValidLatticeSite(neighbourCoords))
             {
               // Set the neighbour location to the rubbish site.
-              SetNeighbourLocation(localIndex, direction, GetLocalFluidSiteCount() * latticeInfo.GetNumVectors());
+              SetNeighbourLocation(localIndex, direction, GetRubbishDistributionIndex());
               continue;
             }
             // Get the id of the processor which the neighbouring site lies on.
@@ -391,7 +476,7 @@ namespace hemelb
             if (proc_id_p == SITE_OR_BLOCK_SOLID)
             {
               // initialize f_id to the rubbish site.
-              SetNeighbourLocation(localIndex, direction, GetLocalFluidSiteCount() * latticeInfo.GetNumVectors());
+              SetNeighbourLocation(localIndex, direction, GetRubbishDistributionIndex());
               continue;
             }
             else
@@ -405,7 +490,7 @@ namespace hemelb
             {
               // Pointer to the neighbour.
               site_t contigSiteId = GetContiguousSiteId(neighbourCoords);
-              SetNeighbourLocation(localIndex, direction, contigSiteId * latticeInfo.GetNumVectors() + direction);
+              SetNeighbourLocation(localIndex, direction, GetDistributionIndex(contigSiteId, direction));
               continue;
             }
             else
@@ -466,7 +551,7 @@ namespace hemelb
     {
       proc_t localRank = comms.Rank();
       streamingIndicesForReceivedDistributions.resize(totalSharedFs);
-      site_t f_count = GetLocalFluidSiteCount() * latticeInfo.GetNumVectors();
+      site_t f_count = GetRubbishDistributionIndex();
       site_t sharedSitesSeen = 0;
       for (size_t neighbourId = 0; neighbourId < neighbouringProcs.size(); neighbourId++)
       {
@@ -496,8 +581,8 @@ namespace hemelb
           SetNeighbourLocation(contigSiteId, (unsigned int) ( (l)), ++f_count);
           // Set the place where we put the received distribution functions, which is
           // f_new[number of fluid site that sends, inverse direction].
-          streamingIndicesForReceivedDistributions[sharedSitesSeen] = contigSiteId * latticeInfo.GetNumVectors()
-              + latticeInfo.GetInverseIndex(l);
+          streamingIndicesForReceivedDistributions[sharedSitesSeen] =
+              GetDistributionIndex(contigSiteId, latticeInfo.GetInverseIndex(l));
           ++sharedSitesSeen;
         }
 
@@ -658,25 +743,128 @@ namespace hemelb
           it != neighbouringProcs.end(); ++it)
       {
         // Request the receive into the appropriate bit of FOld.
-        net->RequestReceive<distribn_t>(GetFOld( (*it).FirstSharedDistribution),
-                                        (int) ( ( (*it).SharedDistributionCount)),
-                                        (*it).Rank);
+        net->RequestReceive<DistributionStorage::Type>(GetFOld( (*it).FirstSharedDistribution
+                                                           + GetSharedReceiveOffset()),
+                                                       (int) ( ( (*it).SharedDistributionCount)),
+                                                       (*it).Rank);
         // Request the send from the right bit of FNew.
-        net->RequestSend<distribn_t>(GetFNew( (*it).FirstSharedDistribution),
-                                     (int) ( ( (*it).SharedDistributionCount)),
-                                     (*it).Rank);
+        net->RequestSend<DistributionStorage::Type>(GetFNew( (*it).FirstSharedDistribution),
+                                                    (int) ( ( (*it).SharedDistributionCount)),
+                                                    (*it).Rank);
 
       }
     }
 
+    void LatticeData::InitialiseHaloExchange()
+    {
+      std::vector<proc_t> ranks;
+      std::vector<int> counts;
+      for (std::vector<NeighbouringProcessor>::const_iterator it = neighbouringProcs.begin();
+          it != neighbouringProcs.end(); ++it)
+      {
+        ranks.push_back(it->Rank);
+        counts.push_back(it->SharedDistributionCount);
+      }
+
+      // To receive directly, each neighbour's distributions are scattered to where
+      // CopyReceived would have put them.
+      std::vector<MPI_Datatype> receiveTypes;
+      if (HaloReceivedDirectly)
+      {
+        const MPI_Datatype type = net::MpiDataType<DistributionStorage::Type>();
+        site_t sharedSitesSeen = 0;
+        for (std::vector<NeighbouringProcessor>::const_iterator it = neighbouringProcs.begin();
+            it != neighbouringProcs.end(); ++it)
+        {
+          std::vector<MPI_Aint> displacements;
+          for (site_t i = 0; i < it->SharedDistributionCount; ++i)
+          {
+            displacements.push_back(streamingIndicesForReceivedDistributions[sharedSitesSeen++]
+                * sizeof(DistributionStorage::Type));
+          }
+          MPI_Datatype receiveType;
+          HEMELB_MPI_CALL(MPI_Type_create_hindexed_block,
+                          (displacements.size(), 1, displacements.data(), type, &receiveType));
+          HEMELB_MPI_CALL(MPI_Type_commit, (&receiveType));
+          receiveTypes.push_back(receiveType);
+        }
+      }
+
+      // Every rank takes part in creating the graph communicator, even with no neighbours.
+      delete haloExchange;
+      haloExchange = new net::PersistentHaloExchange(comms,
+                                                     ranks,
+                                                     counts,
+                                                     net::MpiDataType<DistributionStorage::Type>(),
+                                                     receiveTypes);
+    }
+
+    void LatticeData::StartHaloReceives()
+    {
+      // Nothing to exchange; the (collective) set up has already been done.
+      if (neighbouringProcs.empty())
+      {
+        return;
+      }
+
+      if (HaloReceivedDirectly)
+      {
+        haloExchange->StartReceives(GetFNew(0));
+      }
+      else
+      {
+        // The neighbours' blocks follow each other, as SendAndReceive assumes too.
+        haloExchange->StartReceives(GetFOld(neighbouringProcs[0].FirstSharedDistribution + GetSharedReceiveOffset()));
+      }
+    }
+
+    void LatticeData::StartHaloSends()
+    {
+      if (neighbouringProcs.empty())
+      {
+        return;
+      }
+      haloExchange->StartSends(GetFNew(neighbouringProcs[0].FirstSharedDistribution));
+    }
+
+    void LatticeData::WaitHalo()
+    {
+      if (neighbouringProcs.empty())
+      {
+        return;
+      }
+      haloExchange->Wait();
+    }
+
     void LatticeData::CopyReceived()
     {
+      if (HaloReceivedDirectly)
+      {
+        return;
+      }
+
       // Copy the distribution functions received from the neighbouring
       // processors into the destination buffer "f_new".
       for (site_t i = 0; i < totalSharedFs; i++)
       {
         *GetFNew(streamingIndicesForReceivedDistributions[i]) = *GetFOld(neighbouringProcs[0].FirstSharedDistribution
-            + i);
+            + GetSharedReceiveOffset() + i);
+      }
+    }
+
+    void LatticeData::FillSharedSendBuffer()
+    {
+      if (!StreamingPattern::InPlace || oddStep)
+      {
+        return;
+      }
+
+      // The distribution sent from a site in direction l is the one the even step wrote to the
+      // site's own slot for the inverse of l. That is the same slot that the distribution
+      // received for this link is copied to, so we can reuse the receive lookup.
+      for (site_t i = 0; i < totalSharedFs; i++)
+      {
+        *GetFNew(neighbouringProcs[0].FirstSharedDistribution + i) = *GetFOld(streamingIndicesForReceivedDistributions[i]);
       }
     }
 
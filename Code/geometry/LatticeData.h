@@ -8,15 +8,22 @@
 #define HEMELB_GEOMETRY_LATTICEDATA_H
 
 #include <cstdio>
+#include <type_traits>
 #include <vector>
 
 #include "net/net.h"
+#include "net/PersistentHaloExchange.h"
 #include "constants.h"
 #include "configuration/SimConfig.h"
 #include "extraction/LocalDistributionInput.h"
 #include "geometry/Block.h"
+#include "geometry/DistributionLayout.h"
+#include "geometry/DistributionStorage.h"
 #include "geometry/GeometryReader.h"
+#include "geometry/NeighbourIndices.h"
+#include "geometry/SiteOrdering.h"
 #include "geometry/NeighbouringProcessor.h"
+#include "geometry/StreamingPattern.h"
 #include "geometry/Site.h"
 #include "geometry/neighbouring/NeighbouringSite.h"
 #include "geometry/SiteData.h"
@@ -47,21 +54,58 @@ namespace hemelb
         template<class LatticeData>
         friend class Site; //! Let the inner classes have access to site-related data that's otherwise private.
 
+        //! Whether a site's current distributions can be used straight from fOld / fNew.
+        static const bool SitesAreContiguous = DistributionLayout::IsSiteContiguous && !StreamingPattern::InPlace
+            && DistributionStorage::IsNative;
+
+        //! Whether the halo is received straight into fNew, leaving CopyReceived nothing to do.
+        //! Not with in-place streaming, where those slots may still be read during the step.
+#if defined(HEMELB_USE_PERSISTENT_HALO) && defined(HEMELB_USE_INDEXED_HALO_RECEIVE)
+        static const bool HaloReceivedDirectly = !StreamingPattern::InPlace;
+#else
+        static const bool HaloReceivedDirectly = false;
+#endif
+
         LatticeData(const lb::lattices::LatticeInfo& latticeInfo, const Geometry& readResult, const net::IOCommunicator& comms);
 
         virtual ~LatticeData();
 
         /**
-         * Swap the fOld and fNew arrays around.
+         * Swap the fOld and fNew arrays around. With in-place streaming there is only one
+         * array, so this just moves on to the other half of the even / odd cycle.
          */
         inline void SwapOldAndNew()
         {
-          oldDistributions.swap(newDistributions);
+          if (StreamingPattern::InPlace)
+          {
+            oddStep = !oddStep;
+          }
+          else
+          {
+            oldDistributions.swap(newDistributions);
+          }
         }
 
         void SendAndReceive(net::Net* net);
         void CopyReceived();
 
+        /**
+         * An alternative to SendAndReceive and the net's dispatch, with persistent requests
+         * that are set up with the lattice. Start the receives before the domain edge is
+         * collided, the sends after FillSharedSendBuffer, and wait before CopyReceived.
+         */
+        void StartHaloReceives();
+        void StartHaloSends();
+        void WaitHalo();
+
+        /**
+         * With in-place streaming, the even step leaves the post-collision distributions bound
+         * for other ranks in their own site's slots rather than in the send buffer, so copy them
+         * across. Must be called after the domain edge sites have been collided and before the
+         * sends happen. Does nothing for two-lattice streaming or on odd steps.
+         */
+        void FillSharedSendBuffer();
+
         /**
          * Get the lattice info object for the current lattice
          * @return
@@ -151,13 +195,17 @@ namespace hemelb
         bool IsValidLatticeSite(const util::Vector3D<site_t>& siteCoords) const;
 
         /**
-         * Get a pointer into the fNew array at the given index
+         * Get a pointer into the fNew array at the given index. The values are stored as
+         * DistributionStorage::Type; use GetFNewValue / SetFNew to read or write them as
+         * distribn_t.
          * @param distributionIndex
          * @return
          */
-        inline distribn_t* GetFNew(site_t distributionIndex)
+        inline DistributionStorage::Type* GetFNew(site_t distributionIndex)
         {
-          return &newDistributions[distributionIndex];
+          return &(StreamingPattern::InPlace ?
+            oldDistributions :
+            newDistributions)[distributionIndex];
         }
 
         /**
@@ -166,9 +214,147 @@ namespace hemelb
          * @param distributionIndex
          * @return
          */
-        inline const distribn_t* GetFNew(site_t siteNumber) const
+        inline const DistributionStorage::Type* GetFNew(site_t siteNumber) const
+        {
+          return &(StreamingPattern::InPlace ?
+            oldDistributions :
+            newDistributions)[siteNumber];
+        }
+
+        /**
+         * Get the value in fNew at the given index, which holds a distribution in the given
+         * direction (or its inverse).
+         * @param distributionIndex
+         * @param direction
+         * @return
+         */
+        inline distribn_t GetFNewValue(site_t distributionIndex, Direction direction) const
+        {
+          return DistributionStorage::Load(*GetFNew(distributionIndex), latticeInfo.GetWeight(direction));
+        }
+
+        /**
+         * Set the value in fNew at the given index to a distribution in the given direction (or
+         * its inverse).
+         * @param distributionIndex
+         * @param direction
+         * @param value
+         */
+        inline void SetFNew(site_t distributionIndex, Direction direction, distribn_t value)
+        {
+          *GetFNew(distributionIndex) = DistributionStorage::Store(value, latticeInfo.GetWeight(direction));
+        }
+
+        /**
+         * Get the layout object that maps (site, direction) pairs onto the distribution arrays.
+         * @return
+         */
+        inline const DistributionLayout& GetDistributionLayout() const
+        {
+          return distributionLayout;
+        }
+
+        /**
+         * Get the position in the fOld / fNew arrays of the distribution for the given site
+         * and direction.
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline site_t GetDistributionIndex(site_t siteIndex, Direction direction) const
+        {
+          return distributionLayout.template GetIndex<LatticeType>(siteIndex, direction);
+        }
+
+        /**
+         * Non-templated version of the above, for when you haven't got a lattice type handy.
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        inline site_t GetDistributionIndex(site_t siteIndex, Direction direction) const
+        {
+          return distributionLayout.GetIndex(siteIndex, direction);
+        }
+
+        /**
+         * Get the index of the 'rubbish site', the slot that distributions streamed out of the
+         * geometry are written to.
+         * @return
+         */
+        inline site_t GetRubbishDistributionIndex() const
+        {
+          return distributionLayout.GetLocalDistributionCount();
+        }
+
+        /**
+         * Get the fNew distributions of a site as a contiguous array. This points straight into
+         * fNew when the layout allows, otherwise the values are gathered into gatherBuffer,
+         * which must have room for LatticeType::NUMVECTORS values.
+         * @param siteIndex
+         * @param gatherBuffer
+         * @return
+         */
+        template<typename LatticeType>
+        inline const distribn_t* GetFNewForSite(site_t siteIndex, distribn_t* gatherBuffer) const
+        {
+          return StreamingPattern::InPlace ?
+            GatherSite<LatticeType>(oldDistributions, siteIndex, gatherBuffer, !oddStep) :
+            GatherSite<LatticeType>(newDistributions, siteIndex, gatherBuffer, false);
+        }
+
+        /**
+         * Get the position in fOld of the current distribution for the given site and
+         * direction. This is GetDistributionIndex, except on the odd steps of in-place
+         * streaming when the distribution is wherever the upstream neighbour streamed it to.
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline site_t GetFOldIndex(site_t siteIndex, Direction direction) const
         {
-          return &newDistributions[siteNumber];
+          if (StreamingPattern::InPlace && oddStep)
+          {
+            return GetUpstreamIndex(siteIndex,
+                                    direction,
+                                    distributionLayout.template GetIndex<LatticeType>(siteIndex,
+                                                                                      LatticeType::INVERSEDIRECTIONS[direction]));
+          }
+          return distributionLayout.template GetIndex<LatticeType>(siteIndex, direction);
+        }
+
+        /**
+         * Non-templated version of the above, for when you haven't got a lattice type handy.
+         * @param siteIndex
+         * @param direction
+         * @return
+         */
+        inline site_t GetFOldIndex(site_t siteIndex, Direction direction) const
+        {
+          return GetCurrentIndex(siteIndex, direction, StreamingPattern::InPlace && oddStep);
+        }
+
+        /**
+         * Copy the fOld distributions of tWidth consecutive sites, starting at firstSiteIndex,
+         * into f, indexed [direction][lane], for the batched collision kernels. With the SOA
+         * layout (and AOSOA, when the batch is a tile) each direction is one contiguous load.
+         * @param firstSiteIndex
+         * @param f
+         */
+        template<typename LatticeType, unsigned tWidth>
+        inline void GetFOldBatch(site_t firstSiteIndex, distribn_t f[][tWidth]) const
+        {
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            for (unsigned lane = 0; lane < tWidth; ++lane)
+            {
+              f[direction][lane] =
+                  DistributionStorage::Load(oldDistributions[GetFOldIndex<LatticeType>(firstSiteIndex + lane, direction)],
+                                            LatticeType::EQMWEIGHTS[direction]);
+            }
+          }
         }
 
         proc_t GetProcIdFromGlobalCoords(const util::Vector3D<site_t>& globalSiteCoords) const;
@@ -213,6 +399,16 @@ namespace hemelb
           return localFluidSites;
         }
 
+        /**
+         * Get the memory taken by the streaming lookup, which depends on the build's choice of
+         * NeighbourIndices.
+         * @return
+         */
+        inline std::size_t GetNeighbourLookupByteCount() const
+        {
+          return neighbourIndices.GetByteCount();
+        }
+
         site_t GetContiguousSiteId(util::Vector3D<site_t> location) const;
 
         /**
@@ -412,9 +608,25 @@ namespace hemelb
 
           }
 
-          oldDistributions.resize(localFluidSites * latticeInfo.GetNumVectors() + 1 + totalSharedFs);
-          newDistributions.resize(localFluidSites * latticeInfo.GetNumVectors() + 1 + totalSharedFs);
+          distributionLayout.Initialise(localFluidSites, latticeInfo.GetNumVectors());
+          if (StreamingPattern::InPlace)
+          {
+            // A single array, with separate send and receive buffers for the shared
+            // distributions (see GetSharedReceiveOffset).
+            oldDistributions.resize(distributionLayout.GetLocalDistributionCount() + 1 + 2 * totalSharedFs);
+          }
+          else
+          {
+            oldDistributions.resize(distributionLayout.GetLocalDistributionCount() + 1 + totalSharedFs);
+            newDistributions.resize(distributionLayout.GetLocalDistributionCount() + 1 + totalSharedFs);
+          }
         }
+        void OrderSites(std::vector<site_t>& blockNumbers,
+                        std::vector<site_t>& siteNumbers,
+                        std::vector<SiteData>& siteDataForType,
+                        std::vector<util::Vector3D<float> >& wallNormals,
+                        std::vector<float>& wallDistance) const;
+        std::uint64_t GetBlockOrderKey(site_t blockId) const;
         void CollectFluidSiteDistribution();
         void CollectGlobalSiteExtrema();
 
@@ -423,6 +635,11 @@ namespace hemelb
         void InitialiseNeighbourLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
         void InitialisePointToPointComms(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
         void InitialiseReceiveLookup(std::vector<std::vector<site_t> >& sharedFLocationForEachProc);
+        /**
+         * Create the persistent halo exchange. This is collective over all ranks, including
+         * any without neighbouring processors (or sites at all).
+         */
+        void InitialiseHaloExchange();
 
         sitedata_t GetSiteData(site_t iSiteI, site_t iSiteJ, site_t iSiteK) const;
 
@@ -437,7 +654,7 @@ namespace hemelb
                                          const unsigned int direction,
                                          const site_t distributionIndex)
         {
-          neighbourIndices[siteIndex * latticeInfo.GetNumVectors() + direction] = distributionIndex;
+          neighbourIndices.Set(distributionLayout.GetIndex(siteIndex, direction), distributionIndex);
         }
 
         void GetBlockIJK(site_t block, util::Vector3D<site_t>& blockCoords) const;
@@ -466,7 +683,7 @@ namespace hemelb
          * @return
          */
         // Method should remain protected, intent is to access this information via Site
-        distribn_t* GetFOld(site_t distributionIndex)
+        DistributionStorage::Type* GetFOld(site_t distributionIndex)
         {
           return &oldDistributions[distributionIndex];
         }
@@ -479,11 +696,160 @@ namespace hemelb
          * @return
          */
         // Method should remain protected, intent is to access this information via Site
-        const distribn_t* GetFOld(site_t distributionIndex) const
+        const DistributionStorage::Type* GetFOld(site_t distributionIndex) const
         {
           return &oldDistributions[distributionIndex];
         }
 
+        /**
+         * Get the value in fOld at the given index; see GetFNewValue.
+         * @param distributionIndex
+         * @param direction
+         * @return
+         */
+        // Method should remain protected, intent is to access this information via Site
+        inline distribn_t GetFOldValue(site_t distributionIndex, Direction direction) const
+        {
+          return DistributionStorage::Load(oldDistributions[distributionIndex], latticeInfo.GetWeight(direction));
+        }
+
+        /**
+         * Set the value in fOld at the given index; see SetFNew.
+         * @param distributionIndex
+         * @param direction
+         * @param value
+         */
+        inline void SetFOld(site_t distributionIndex, Direction direction, distribn_t value)
+        {
+          oldDistributions[distributionIndex] = DistributionStorage::Store(value, latticeInfo.GetWeight(direction));
+        }
+
+        /**
+         * Get the fOld distributions of a site as a contiguous array; see GetFNewForSite.
+         * @param siteIndex
+         * @param gatherBuffer
+         * @return
+         */
+        // Method should remain protected, intent is to access this information via Site
+        template<typename LatticeType>
+        inline const distribn_t* GetFOldForSite(site_t siteIndex, distribn_t* gatherBuffer) const
+        {
+          return GatherSite<LatticeType>(oldDistributions,
+                                         siteIndex,
+                                         gatherBuffer,
+                                         StreamingPattern::InPlace && oddStep);
+        }
+
+        /**
+         * Get a site's distributions as a contiguous array, gathering them into gatherBuffer
+         * if necessary.
+         * @param distributions
+         * @param siteIndex
+         * @param gatherBuffer
+         * @param fromUpstream whether the distributions are laid out as after an even in-place
+         * streaming step, i.e. have to be read from the upstream neighbours.
+         * @return
+         */
+        template<typename LatticeType>
+        inline const distribn_t* GatherSite(const std::vector<DistributionStorage::Type>& distributions,
+                                            site_t siteIndex,
+                                            distribn_t* gatherBuffer,
+                                            bool fromUpstream) const
+        {
+          if (!fromUpstream)
+          {
+            return GatherSite<LatticeType>(distributions,
+                                           siteIndex,
+                                           gatherBuffer,
+                                           std::integral_constant<bool,
+                                               DistributionLayout::IsSiteContiguous && DistributionStorage::IsNative>());
+          }
+
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            gatherBuffer[direction] =
+                DistributionStorage::Load(distributions[GetUpstreamIndex(siteIndex,
+                                                                         direction,
+                                                                         distributionLayout.template GetIndex<LatticeType>(siteIndex,
+                                                                                                                           LatticeType::INVERSEDIRECTIONS[direction]))],
+                                          LatticeType::EQMWEIGHTS[direction]);
+          }
+          return gatherBuffer;
+        }
+
+        /**
+         * GatherSite for when the site's own slots can be used as they are.
+         */
+        template<typename LatticeType>
+        inline const distribn_t* GatherSite(const std::vector<DistributionStorage::Type>& distributions,
+                                            site_t siteIndex,
+                                            distribn_t* gatherBuffer,
+                                            std::true_type) const
+        {
+          return &distributions[distributionLayout.template GetIndex<LatticeType>(siteIndex, 0)];
+        }
+
+        /**
+         * GatherSite for when the site's own slots have to be gathered and / or converted.
+         */
+        template<typename LatticeType>
+        inline const distribn_t* GatherSite(const std::vector<DistributionStorage::Type>& distributions,
+                                            site_t siteIndex,
+                                            distribn_t* gatherBuffer,
+                                            std::false_type) const
+        {
+          for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+          {
+            gatherBuffer[direction] =
+                DistributionStorage::Load(distributions[distributionLayout.template GetIndex<LatticeType>(siteIndex,
+                                                                                                         direction)],
+                                          LatticeType::EQMWEIGHTS[direction]);
+          }
+          return gatherBuffer;
+        }
+
+        /**
+         * For in-place streaming, get where the even step left the distribution arriving at a
+         * site in a given direction: the upstream neighbour's slot for the inverse direction if
+         * that neighbour is a local fluid site, otherwise the site's own slot (where boundary
+         * conditions and received distributions are put).
+         * @param siteIndex
+         * @param direction
+         * @param inverseIndex the index of the site's own distribution in the inverse direction
+         * @return
+         */
+        inline site_t GetUpstreamIndex(site_t siteIndex, Direction direction, site_t inverseIndex) const
+        {
+          const site_t upstreamIndex = neighbourIndices.Get(inverseIndex);
+          return upstreamIndex < GetRubbishDistributionIndex() ?
+            upstreamIndex :
+            distributionLayout.GetIndex(siteIndex, direction);
+        }
+
+        inline site_t GetCurrentIndex(site_t siteIndex, Direction direction, bool fromUpstream) const
+        {
+          if (fromUpstream)
+          {
+            return GetUpstreamIndex(siteIndex,
+                                    direction,
+                                    distributionLayout.GetIndex(siteIndex, latticeInfo.GetInverseIndex(direction)));
+          }
+          return distributionLayout.GetIndex(siteIndex, direction);
+        }
+
+        /**
+         * Offset from the send buffer for the shared distributions to the receive buffer. The
+         * two-lattice scheme sends from fNew and receives into fOld at the same positions; with
+         * in-place streaming the receive buffer follows the send buffer in the single array.
+         * @return
+         */
+        inline site_t GetSharedReceiveOffset() const
+        {
+          return StreamingPattern::InPlace ?
+            totalSharedFs :
+            0;
+        }
+
         /*
          * This returns the index of the distribution to stream to.
          *
@@ -494,7 +860,14 @@ namespace hemelb
         template<typename LatticeType>
         site_t GetStreamedIndex(site_t iSiteIndex, unsigned int iDirectionIndex) const
         {
-          return neighbourIndices[iSiteIndex * LatticeType::NUMVECTORS + iDirectionIndex];
+          // On even in-place steps everything goes to the site's own slot for the inverse
+          // direction, where the downstream neighbour will pick it up on the odd step.
+          if (StreamingPattern::InPlace && !oddStep)
+          {
+            return distributionLayout.template GetIndex<LatticeType>(iSiteIndex,
+                                                                     LatticeType::INVERSEDIRECTIONS[iDirectionIndex]);
+          }
+          return neighbourIndices.Get(distributionLayout.template GetIndex<LatticeType>(iSiteIndex, iDirectionIndex));
         }
 
         /**
@@ -568,8 +941,10 @@ namespace hemelb
         site_t midDomainProcCollisions[COLLISION_TYPES]; //! Number of fluid sites with all fluid neighbours on this rank, for each collision type.
         site_t domainEdgeProcCollisions[COLLISION_TYPES]; //! Number of fluid sites with at least one fluid neighbour on another rank, for each collision type.
         site_t localFluidSites; //! The number of local fluid sites.
-        std::vector<distribn_t> oldDistributions; //! The distribution values for the previous time step.
-        std::vector<distribn_t> newDistributions; //! The distribution values for the next time step.
+        DistributionLayout distributionLayout; //! Maps sites and directions onto the distribution arrays.
+        std::vector<DistributionStorage::Type> oldDistributions; //! The distribution values for the previous time step.
+        std::vector<DistributionStorage::Type> newDistributions; //! The distribution values for the next time step (unused for in-place streaming).
+        bool oddStep; //! For in-place streaming, whether we are on the odd step of the even / odd cycle.
         std::vector<Block> blocks; //! Data where local fluid sites are stored contiguously.
 
         std::vector<distribn_t> distanceToWall; //! Hold the distance to the wall for each fluid site.
@@ -579,10 +954,11 @@ namespace hemelb
         std::vector<site_t> fluidSitesOnEachProcessor; //! Array containing numbers of fluid sites on each processor.
         site_t totalFluidSites; //! The total number of fluid sites in the geometry.
         util::Vector3D<site_t> globalSiteMins, globalSiteMaxes; //! The minimal and maximal coordinates of any fluid sites.
-        std::vector<site_t> neighbourIndices; //! Data about neighbouring fluid sites.
+        NeighbourIndices neighbourIndices; //! Where each local distribution streams to.
         std::vector<site_t> streamingIndicesForReceivedDistributions; //! The indices to stream to for distributions received from other processors.
         neighbouring::NeighbouringLatticeData *neighbouringData;
         const net::IOCommunicator& comms;
+        net::PersistentHaloExchange* haloExchange; //! Created with the neighbour lookups, if used.
     };
   }
 }
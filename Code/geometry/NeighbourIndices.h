@@ -0,0 +1,228 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_NEIGHBOURINDICES_H
+#define HEMELB_GEOMETRY_NEIGHBOURINDICES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "units.h"
+#include "Exception.h"
+
+#ifndef HEMELB_NEIGHBOUR_INDICES
+#define HEMELB_NEIGHBOUR_INDICES WIDE
+#endif
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * The classes in this file hold the streaming lookup of LatticeData: for each slot of the
+     * local distribution arrays, the index of the slot its post-collision value streams to.
+     * The names of the classes must correspond to the options given for the CMake
+     * HEMELB_NEIGHBOUR_INDICES parameter.
+     *
+     * The targets are either local slots, the rubbish slot or the shared send buffer, which
+     * follows the rubbish slot. Every class is filled by Initialise and Set, and Finalise must
+     * be called once all the entries are set and before any are read with Get.
+     */
+
+    /**
+     * One site_t per slot. This is the historical HemeLB lookup.
+     */
+    class WIDE
+    {
+      public:
+        void Initialise(site_t slotCount, site_t rubbishIndex, site_t targetCount)
+        {
+          indices.assign(slotCount, rubbishIndex);
+        }
+
+        inline void Set(site_t slot, site_t target)
+        {
+          indices[slot] = target;
+        }
+
+        void Finalise()
+        {
+        }
+
+        inline site_t Get(site_t slot) const
+        {
+          return indices[slot];
+        }
+
+        std::size_t GetByteCount() const
+        {
+          return indices.size() * sizeof(site_t);
+        }
+
+      private:
+        std::vector<site_t> indices;
+    };
+
+    /**
+     * One 32-bit unsigned integer per slot, which halves the size of the lookup. This limits a
+     * single rank to 2^32 distributions, i.e. over 200 million D3Q19 sites.
+     */
+    class COMPACT
+    {
+      public:
+        typedef std::uint32_t Index;
+
+        void Initialise(site_t slotCount, site_t rubbishIndex, site_t targetCount)
+        {
+          if (targetCount > site_t(std::numeric_limits<Index>::max()))
+          {
+            throw Exception() << "Too many distributions (" << targetCount
+                << ") on this rank for the COMPACT neighbour indices";
+          }
+          indices.assign(slotCount, Index(rubbishIndex));
+        }
+
+        inline void Set(site_t slot, site_t target)
+        {
+          indices[slot] = Index(target);
+        }
+
+        void Finalise()
+        {
+        }
+
+        inline site_t Get(site_t slot) const
+        {
+          return indices[slot];
+        }
+
+        std::size_t GetByteCount() const
+        {
+          return indices.size() * sizeof(Index);
+        }
+
+      private:
+        std::vector<Index> indices;
+    };
+
+    /**
+     * One 16-bit offset per slot, relative to the slot itself. Sites are numbered block by
+     * block, so links between two sites in the same block (and many between neighbouring
+     * blocks) fit in the offset. Links to the rubbish slot get a code of their own; the rest
+     * (the ones crossing to distant blocks and to the send buffer) are marked as escaped and
+     * kept in a table sorted by slot, which is searched for them.
+     *
+     * This cuts the lookup to a quarter of the WIDE one, at the price of a well-predicted
+     * branch per link and a binary search for the links at block borders.
+     */
+    class BLOCKRELATIVE
+    {
+      public:
+        typedef std::int16_t Offset;
+
+        static const Offset RubbishCode = std::numeric_limits<Offset>::min();
+        static const Offset EscapedCode = RubbishCode + 1;
+
+        BLOCKRELATIVE() :
+            rubbishIndex(0)
+        {
+        }
+
+        void Initialise(site_t slotCount, site_t rubbishIndexIn, site_t targetCount)
+        {
+          rubbishIndex = rubbishIndexIn;
+          offsets.assign(slotCount, Offset(RubbishCode));
+          escapedTargets.clear();
+        }
+
+        inline void Set(site_t slot, site_t target)
+        {
+          const site_t offset = target - slot;
+          if (target == rubbishIndex)
+          {
+            offsets[slot] = RubbishCode;
+          }
+          else if (offset > EscapedCode && offset <= std::numeric_limits<Offset>::max())
+          {
+            offsets[slot] = Offset(offset);
+          }
+          else
+          {
+            offsets[slot] = EscapedCode;
+            escapedTargets.push_back(std::make_pair(slot, target));
+          }
+        }
+
+        /**
+         * Sort the escaped links, keeping only the last value set for each slot that is still
+         * escaped.
+         */
+        void Finalise()
+        {
+          std::stable_sort(escapedTargets.begin(), escapedTargets.end(), CompareSlots);
+
+          std::vector<std::pair<site_t, site_t> > kept;
+          for (std::size_t i = 0; i < escapedTargets.size(); ++i)
+          {
+            const bool lastForSlot = i + 1 == escapedTargets.size()
+                || escapedTargets[i + 1].first != escapedTargets[i].first;
+            if (lastForSlot && offsets[escapedTargets[i].first] == EscapedCode)
+            {
+              kept.push_back(escapedTargets[i]);
+            }
+          }
+          escapedTargets.swap(kept);
+        }
+
+        inline site_t Get(site_t slot) const
+        {
+          const Offset offset = offsets[slot];
+          if (offset > EscapedCode)
+          {
+            return slot + offset;
+          }
+          if (offset == RubbishCode)
+          {
+            return rubbishIndex;
+          }
+          return std::lower_bound(escapedTargets.begin(),
+                                  escapedTargets.end(),
+                                  std::make_pair(slot, site_t(0)),
+                                  CompareSlots)->second;
+        }
+
+        std::size_t GetByteCount() const
+        {
+          return offsets.size() * sizeof(Offset) + escapedTargets.size() * sizeof(std::pair<site_t, site_t>);
+        }
+
+        /**
+         * The number of links that didn't fit in an offset.
+         * @return
+         */
+        site_t GetEscapedCount() const
+        {
+          return escapedTargets.size();
+        }
+
+      private:
+        static bool CompareSlots(const std::pair<site_t, site_t>& a, const std::pair<site_t, site_t>& b)
+        {
+          return a.first < b.first;
+        }
+
+        site_t rubbishIndex;
+        std::vector<Offset> offsets;
+        std::vector<std::pair<site_t, site_t> > escapedTargets;
+    };
+
+    // Use the lookup specified through the build system.
+    typedef HEMELB_NEIGHBOUR_INDICES NeighbourIndices;
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_NEIGHBOURINDICES_H */
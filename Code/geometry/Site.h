@@ -7,7 +7,9 @@
 #ifndef HEMELB_GEOMETRY_SITE_H
 #define HEMELB_GEOMETRY_SITE_H
 
+#include <type_traits>
 #include "units.h"
+#include "geometry/DistributionLayout.h"
 #include "geometry/SiteData.h"
 #include "util/Vector3D.h"
 
@@ -15,6 +17,30 @@ namespace hemelb
 {
   namespace geometry
   {
+    /**
+     * Scratch space for a Site to gather its distributions into when they aren't stored
+     * contiguously (see LatticeData::SitesAreContiguous). Empty when they are.
+     */
+    template<bool SitesAreContiguous>
+    struct SiteGatherBuffer
+    {
+        inline distribn_t* Get() const
+        {
+          return NULL;
+        }
+    };
+
+    template<>
+    struct SiteGatherBuffer<false>
+    {
+        // Large enough for the biggest lattice we support (D3Q27).
+        mutable distribn_t f[27];
+
+        inline distribn_t* Get() const
+        {
+          return f;
+        }
+    };
 
     template<class DataSource>
     class Site
@@ -103,16 +129,35 @@ namespace hemelb
           return latticeData.template GetStreamedIndex<LatticeType>(index, direction);
         }
 
+        /**
+         * Get the fOld distributions of this site. With a layout that doesn't keep a site's
+         * distributions contiguous, this is a gathered copy that lives as long as this Site.
+         *
+         * @return
+         */
         template<typename LatticeType>
         inline const distribn_t* GetFOld() const
         {
-          return latticeData.GetFOld(index * LatticeType::NUMVECTORS);
+          return latticeData.template GetFOldForSite<LatticeType>(index, gatherBuffer.Get());
         }
 
         // Non-templated version of GetFOld, for when you haven't got a lattice type handy
         inline const distribn_t* GetFOld(int numvectors) const
         {
-          return latticeData.GetFOld(index * numvectors);
+          return GetFOld(numvectors, std::integral_constant<bool, DataSourceType::SitesAreContiguous>());
+        }
+
+        /**
+         * Get the index in the distribution arrays of this site's distribution in the given
+         * direction.
+         *
+         * @param direction
+         * @return
+         */
+        template<typename LatticeType>
+        inline site_t GetDistributionIndex(Direction direction) const
+        {
+          return latticeData.template GetDistributionIndex<LatticeType>(index, direction);
         }
 
         inline const SiteData& GetSiteData() const
@@ -131,8 +176,26 @@ namespace hemelb
         }
 
       protected:
+        typedef typename std::remove_const<DataSource>::type DataSourceType;
+
+        inline const distribn_t* GetFOld(int numvectors, std::true_type) const
+        {
+          return latticeData.GetFOld(index * numvectors);
+        }
+
+        inline const distribn_t* GetFOld(int numvectors, std::false_type) const
+        {
+          for (int direction = 0; direction < numvectors; ++direction)
+          {
+            gatherBuffer.Get()[direction] = latticeData.GetFOldValue(latticeData.GetFOldIndex(index, direction),
+                                                                     direction);
+          }
+          return gatherBuffer.Get();
+        }
+
         site_t index;
         DataSource & latticeData;
+        SiteGatherBuffer<DataSourceType::SitesAreContiguous> gatherBuffer;
     };
   }
 }
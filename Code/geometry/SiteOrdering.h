@@ -0,0 +1,163 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_SITEORDERING_H
+#define HEMELB_GEOMETRY_SITEORDERING_H
+
+#include <cstdint>
+#include "units.h"
+#include "util/Vector3D.h"
+
+#ifndef HEMELB_SITE_ORDERING
+#define HEMELB_SITE_ORDERING NATURAL
+#endif
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * The classes in this file select the order in which LatticeData numbers the local sites of
+     * each collision type. The names of the classes must correspond to the options given for
+     * the CMake HEMELB_SITE_ORDERING parameter.
+     *
+     * Sites are always kept together by block, so that each block's sites of a collision type
+     * form one contiguous range: blocks are put in order of the key of their block coordinates
+     * and the sites within a block in order of the key of their coordinates within the block.
+     * GetKey maps coordinates in [0, extents) onto a key, and IsNatural says whether this is
+     * the order of the block and site ids (in which case there is nothing to sort).
+     */
+
+    /**
+     * Block id then site id order, i.e. x-major lexicographic. This is the historical HemeLB
+     * numbering.
+     */
+    class NATURAL
+    {
+      public:
+        static const bool IsNatural = true;
+
+        static std::uint64_t GetKey(const util::Vector3D<site_t>& coords, const util::Vector3D<site_t>& extents)
+        {
+          return (std::uint64_t(coords.x) * extents.y + coords.y) * extents.z + coords.z;
+        }
+    };
+
+    namespace detail
+    {
+      /**
+       * The number of bits needed to hold any coordinate in [0, extents).
+       */
+      inline unsigned GetBitsPerAxis(const util::Vector3D<site_t>& extents)
+      {
+        site_t largest = extents.x;
+        if (extents.y > largest)
+        {
+          largest = extents.y;
+        }
+        if (extents.z > largest)
+        {
+          largest = extents.z;
+        }
+        unsigned bits = 1;
+        while ( (site_t(1) << bits) < largest)
+        {
+          ++bits;
+        }
+        return bits;
+      }
+
+      /**
+       * Interleave the bits of three coordinates, most significant first, x before y before z.
+       */
+      inline std::uint64_t Interleave(const std::uint32_t coords[3], unsigned bits)
+      {
+        std::uint64_t key = 0;
+        for (int bit = int(bits) - 1; bit >= 0; --bit)
+        {
+          for (unsigned axis = 0; axis < 3; ++axis)
+          {
+            key = (key << 1) | ( (coords[axis] >> bit) & 1u);
+          }
+        }
+        return key;
+      }
+    }
+
+    /**
+     * Morton (Z-order) curve: cheap to compute, and every aligned power-of-two sub-cube is a
+     * contiguous range of keys.
+     */
+    class MORTON
+    {
+      public:
+        static const bool IsNatural = false;
+
+        static std::uint64_t GetKey(const util::Vector3D<site_t>& coords, const util::Vector3D<site_t>& extents)
+        {
+          const std::uint32_t axes[3] = { std::uint32_t(coords.x), std::uint32_t(coords.y), std::uint32_t(coords.z) };
+          return detail::Interleave(axes, detail::GetBitsPerAxis(extents));
+        }
+    };
+
+    /**
+     * Hilbert curve, using Skilling's transpose algorithm (AIP Conf. Proc. 707, 381 (2004)).
+     * Consecutive keys are always face neighbours, so it has better locality than MORTON.
+     */
+    class HILBERT
+    {
+      public:
+        static const bool IsNatural = false;
+
+        static std::uint64_t GetKey(const util::Vector3D<site_t>& coords, const util::Vector3D<site_t>& extents)
+        {
+          const unsigned bits = detail::GetBitsPerAxis(extents);
+          std::uint32_t axes[3] = { std::uint32_t(coords.x), std::uint32_t(coords.y), std::uint32_t(coords.z) };
+
+          // Inverse undo.
+          for (std::uint32_t q = std::uint32_t(1) << (bits - 1); q > 1; q >>= 1)
+          {
+            const std::uint32_t p = q - 1;
+            for (unsigned axis = 0; axis < 3; ++axis)
+            {
+              if (axes[axis] & q)
+              {
+                axes[0] ^= p;
+              }
+              else
+              {
+                const std::uint32_t t = (axes[0] ^ axes[axis]) & p;
+                axes[0] ^= t;
+                axes[axis] ^= t;
+              }
+            }
+          }
+
+          // Gray encode.
+          axes[1] ^= axes[0];
+          axes[2] ^= axes[1];
+          std::uint32_t t = 0;
+          for (std::uint32_t q = std::uint32_t(1) << (bits - 1); q > 1; q >>= 1)
+          {
+            if (axes[2] & q)
+            {
+              t ^= q - 1;
+            }
+          }
+          for (unsigned axis = 0; axis < 3; ++axis)
+          {
+            axes[axis] ^= t;
+          }
+
+          return detail::Interleave(axes, bits);
+        }
+    };
+
+    // Use the ordering specified through the build system.
+    typedef HEMELB_SITE_ORDERING SiteOrdering;
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_SITEORDERING_H */
@@ -0,0 +1,61 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_STREAMINGPATTERN_H
+#define HEMELB_GEOMETRY_STREAMINGPATTERN_H
+
+#ifndef HEMELB_STREAMING_PATTERN
+#define HEMELB_STREAMING_PATTERN TWOLATTICE
+#endif
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * The classes in this file select how LatticeData stores the distributions between time
+     * steps. The names of the classes must correspond to the options given for the CMake
+     * HEMELB_STREAMING_PATTERN parameter.
+     */
+
+    /**
+     * Two full copies of the distributions: collide from fOld, stream into fNew, then swap
+     * them over at the end of the time step.
+     */
+    class TWOLATTICE
+    {
+      public:
+        static const bool InPlace = false;
+    };
+
+    /**
+     * The AA pattern (Bailey et al., 2009): a single copy of the distributions, updated in
+     * place, which halves the memory needed for them. Time steps alternate between
+     *  - even steps, in which each site reads its distributions from its own slots and writes
+     *    the post-collision value in direction i to its own slot for the inverse of i, and
+     *  - odd steps, in which each site reads the distribution in direction i from its upstream
+     *    neighbour's slot for the inverse of i, and writes the post-collision value in
+     *    direction i to its downstream neighbour's slot for i (the usual streamed index).
+     * Links without a local upstream fluid neighbour (walls, iolets and other ranks) read their
+     * own slot on odd steps, which is where the even step's boundary condition or the halo
+     * exchange put the value.
+     *
+     * LatticeData hides this from most code: GetStreamedIndex, GetFOldForSite and
+     * GetFNewForSite all take the step parity into account and fNew is the same array as fOld.
+     * Only the streamer delegates that write to the site's own inverse slot or to the streamed
+     * index are supported (simple bounce-back, Nash and Ladd iolets).
+     */
+    class AA
+    {
+      public:
+        static const bool InPlace = true;
+    };
+
+    // Use the pattern specified through the build system.
+    typedef HEMELB_STREAMING_PATTERN StreamingPattern;
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_STREAMINGPATTERN_H */
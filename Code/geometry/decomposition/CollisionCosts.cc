@@ -0,0 +1,110 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "geometry/decomposition/CollisionCosts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "Exception.h"
+#include "geometry/decomposition/DecompositionWeights.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      const unsigned CollisionCosts::CollisionTypeCount;
+      const int CollisionCosts::FluidWeight;
+
+      CollisionCosts::CollisionCosts() :
+          costs(CollisionTypeCount), sites(CollisionTypeCount, 0)
+      {
+        for (unsigned type = 0; type < CollisionTypeCount; ++type)
+        {
+          costs[type] = double(hemelbSiteWeights[type]) / double(hemelbSiteWeights[0]);
+        }
+      }
+
+      CollisionCosts CollisionCosts::FromTimes(const std::vector<double>& seconds,
+                                               const std::vector<site_t>& sites)
+      {
+        if (sites[0] == 0 || seconds[0] <= 0.0)
+        {
+          throw Exception() << "Can't measure collision costs without any bulk fluid sites";
+        }
+
+        CollisionCosts measured;
+        const double fluidSecondsPerSite = seconds[0] / sites[0];
+        for (unsigned type = 0; type < CollisionTypeCount; ++type)
+        {
+          if (sites[type] > 0 && seconds[type] > 0.0)
+          {
+            measured.costs[type] = seconds[type] / sites[type] / fluidSecondsPerSite;
+            measured.sites[type] = sites[type];
+          }
+        }
+        return measured;
+      }
+
+      CollisionCosts CollisionCosts::Read(const std::string& path)
+      {
+        std::ifstream file(path.c_str());
+        if (!file)
+        {
+          throw Exception() << "Unable to open collision costs file " << path;
+        }
+
+        CollisionCosts read;
+        std::string line;
+        while (std::getline(file, line))
+        {
+          if (line.empty() || line[0] == '#')
+          {
+            continue;
+          }
+          std::istringstream fields(line);
+          unsigned type;
+          double cost;
+          site_t sites = 0;
+          if (! (fields >> type >> cost) || type >= CollisionTypeCount || ! (cost > 0.0))
+          {
+            throw Exception() << "Bad line in collision costs file " << path << ": " << line;
+          }
+          fields >> sites;
+          read.costs[type] = cost;
+          read.sites[type] = sites;
+        }
+        return read;
+      }
+
+      void CollisionCosts::Write(const std::string& path) const
+      {
+        std::ofstream file(path.c_str());
+        file << "# Cost of each collision type relative to a bulk fluid site\n";
+        file << "# type cost sites\n";
+        for (unsigned type = 0; type < CollisionTypeCount; ++type)
+        {
+          if (sites[type] > 0)
+          {
+            file << type << " " << costs[type] << " " << sites[type] << "\n";
+          }
+        }
+        if (!file)
+        {
+          throw Exception() << "Unable to write collision costs file " << path;
+        }
+      }
+
+      int CollisionCosts::GetWeight(unsigned collisionType) const
+      {
+        return std::max(1, int(std::lround(FluidWeight * costs[collisionType])));
+      }
+    }
+  }
+}
@@ -0,0 +1,74 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_COLLISIONCOSTS_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_COLLISIONCOSTS_H
+
+#include <string>
+#include <vector>
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * The cost of updating a site of each collision type (bulk fluid, wall, inlet, outlet,
+       * wall/inlet and wall/outlet, as in LatticeData), relative to a bulk fluid site.
+       *
+       * By default these are the guesses in DecompositionWeights.h. A calibration run measures
+       * them for the streamers and kernel actually built, and writes them to a profile:
+       *
+       *   # comment lines
+       *   <collision type> <relative cost> <sites measured>
+       *
+       * with a line for each type that had any sites. Reading the profile back replaces the
+       * guesses for those types.
+       */
+      class CollisionCosts
+      {
+        public:
+          static const unsigned CollisionTypeCount = 6;
+
+          //! The weight of a bulk fluid site in GetWeight: the resolution of the other weights.
+          static const int FluidWeight = 16;
+
+          /**
+           * The built-in guesses.
+           */
+          CollisionCosts();
+
+          /**
+           * Costs from the total time spent on, and the number of sites of, each type.
+           */
+          static CollisionCosts FromTimes(const std::vector<double>& seconds,
+                                          const std::vector<site_t>& sites);
+
+          static CollisionCosts Read(const std::string& path);
+
+          void Write(const std::string& path) const;
+
+          double GetCost(unsigned collisionType) const
+          {
+            return costs[collisionType];
+          }
+
+          /**
+           * @return the cost as a positive integer vertex weight, for ParMETIS
+           */
+          int GetWeight(unsigned collisionType) const;
+
+        private:
+          std::vector<double> costs;
+          //! The number of sites each cost was measured on, or 0 if it's a guess.
+          std::vector<site_t> sites;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_COLLISIONCOSTS_H */
@@ -0,0 +1,108 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "geometry/decomposition/NodePlacement.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      NodePlacement::NodePlacement(const std::vector<std::vector<proc_t> >& ranksOnEachNode) :
+          ranksOnEachNode(ranksOnEachNode)
+      {
+        for (std::size_t node = 0; node < ranksOnEachNode.size(); ++node)
+        {
+          for (proc_t rank : ranksOnEachNode[node])
+          {
+            if (std::size_t(rank) >= nodeForEachRank.size())
+            {
+              nodeForEachRank.resize(rank + 1);
+            }
+            nodeForEachRank[rank] = node;
+          }
+        }
+        links.resize(nodeForEachRank.size());
+      }
+
+      void NodePlacement::AddLinks(proc_t part, proc_t otherPart, site_t count)
+      {
+        links[part][otherPart] += count;
+        links[otherPart][part] += count;
+      }
+
+      std::vector<proc_t> NodePlacement::Place() const
+      {
+        std::vector<proc_t> rankForEachPart(links.size(), -1);
+        proc_t firstUnplaced = 0;
+
+        for (const std::vector<proc_t>& ranks : ranksOnEachNode)
+        {
+          // The unplaced parts linked to those on this node, with how many links they have
+          // to them.
+          std::map<proc_t, site_t> candidates;
+
+          for (proc_t rank : ranks)
+          {
+            proc_t part;
+            if (candidates.empty())
+            {
+              // Seed the node (or, if it's cut off, carry on) from the lowest unplaced part.
+              while (rankForEachPart[firstUnplaced] >= 0)
+              {
+                ++firstUnplaced;
+              }
+              part = firstUnplaced;
+            }
+            else
+            {
+              std::map<proc_t, site_t>::iterator best = candidates.begin();
+              for (std::map<proc_t, site_t>::iterator candidate = candidates.begin();
+                  candidate != candidates.end(); ++candidate)
+              {
+                if (candidate->second > best->second)
+                {
+                  best = candidate;
+                }
+              }
+              part = best->first;
+              candidates.erase(best);
+            }
+
+            rankForEachPart[part] = rank;
+            for (const std::pair<const proc_t, site_t>& link : links[part])
+            {
+              if (rankForEachPart[link.first] < 0)
+              {
+                candidates[link.first] += link.second;
+              }
+            }
+          }
+        }
+        return rankForEachPart;
+      }
+
+      site_t NodePlacement::CountLinksBetweenNodes(const std::vector<proc_t>& rankForEachPart) const
+      {
+        site_t count = 0;
+        for (proc_t part = 0; part < proc_t(links.size()); ++part)
+        {
+          for (const std::pair<const proc_t, site_t>& link : links[part])
+          {
+            // Each pair appears from both ends, so only count it from the lower.
+            if (part < link.first
+                && nodeForEachRank[rankForEachPart[part]]
+                    != nodeForEachRank[rankForEachPart[link.first]])
+            {
+              count += link.second;
+            }
+          }
+        }
+        return count;
+      }
+    }
+  }
+}
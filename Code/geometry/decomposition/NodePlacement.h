@@ -0,0 +1,65 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_DECOMPOSITION_NODEPLACEMENT_H
+#define HEMELB_GEOMETRY_DECOMPOSITION_NODEPLACEMENT_H
+
+#include <map>
+#include <vector>
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    namespace decomposition
+    {
+      /**
+       * Chooses the rank for each part of a partition, given how many lattice links each pair
+       * of parts share, so that the parts sharing the most links go on the same node and their
+       * halo exchanges stay off the network.
+       *
+       * This is the upper level of a two-level partition: the parts (one per rank) are grouped
+       * onto nodes, each node taking as many as it has ranks, by growing each node's group from
+       * a seed part, always adding the unplaced part with the most links into the group. The
+       * group's parts then go to the node's ranks in the order they were added.
+       */
+      class NodePlacement
+      {
+        public:
+          /**
+           * @param ranksOnEachNode the ranks on each node; between them they must be 0 to the
+           * number of parts - 1
+           */
+          NodePlacement(const std::vector<std::vector<proc_t> >& ranksOnEachNode);
+
+          /**
+           * Record links between two different parts. Links may be added in several goes, and
+           * either way round.
+           */
+          void AddLinks(proc_t part, proc_t otherPart, site_t count);
+
+          /**
+           * @return the rank for each part
+           */
+          std::vector<proc_t> Place() const;
+
+          /**
+           * @return the number of links that would cross between nodes with the parts on the
+           * given ranks
+           */
+          site_t CountLinksBetweenNodes(const std::vector<proc_t>& rankForEachPart) const;
+
+        private:
+          std::vector<std::vector<proc_t> > ranksOnEachNode;
+          std::vector<std::size_t> nodeForEachRank;
+          //! The number of links from each part to each part it shares any with.
+          std::vector<std::map<proc_t, site_t> > links;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_GEOMETRY_DECOMPOSITION_NODEPLACEMENT_H */
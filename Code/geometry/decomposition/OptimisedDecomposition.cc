@@ -3,9 +3,11 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 
+#include <algorithm>
 #include "geometry/ParmetisHeader.h"
 #include "geometry/decomposition/OptimisedDecomposition.h"
 #include "geometry/decomposition/DecompositionWeights.h"
+#include "geometry/decomposition/NodePlacement.h"
 #include "lb/lattices/D3Q27.h"
 #include "log/Logger.h"
 #include "net/net.h"
@@ -19,9 +21,10 @@ namespace hemelb
       OptimisedDecomposition::OptimisedDecomposition(
           reporting::Timers& timers, net::MpiCommunicator& comms, const Geometry& geometry,
           const lb::lattices::LatticeInfo& latticeInfo, const std::vector<proc_t>& procForEachBlock,
-          const std::vector<site_t>& fluidSitesOnEachBlock) :
+          const std::vector<site_t>& fluidSitesOnEachBlock, const CollisionCosts* collisionCosts) :
           timers(timers), comms(comms), geometry(geometry), latticeInfo(latticeInfo),
-              procForEachBlock(procForEachBlock), fluidSitesPerBlock(fluidSitesOnEachBlock)
+              procForEachBlock(procForEachBlock), fluidSitesPerBlock(fluidSitesOnEachBlock),
+              collisionCosts(collisionCosts)
       {
         timers[hemelb::reporting::Timers::InitialGeometryRead].Start(); //overall dbg timing
 
@@ -185,6 +188,135 @@ namespace hemelb
                 << "This means/implies that ParMETIS cannot properly decompose the system, and no properly load-balanced parallel simulation can be started.";
           }
         }
+
+#ifdef HEMELB_USE_TOPOLOGY_AWARE_DECOMPOSITION
+        PlacePartsOnNodes(localVertexCount);
+#endif
+      }
+
+      void OptimisedDecomposition::PlacePartsOnNodes(idx_t localVertexCount)
+      {
+        // Find the ranks on each node, labelling the nodes by their lowest rank.
+        net::MpiCommunicator node = comms.SplitShared();
+        const proc_t nodeLabel = node.AllReduce(comms.Rank(), MPI_MIN);
+        const std::vector<proc_t> labelForEachRank = comms.AllGather(nodeLabel);
+
+        std::map<proc_t, std::vector<proc_t> > ranksOnEachLabel;
+        for (proc_t rank = 0; rank < comms.Size(); ++rank)
+        {
+          ranksOnEachLabel[labelForEachRank[rank]].push_back(rank);
+        }
+        std::vector<std::vector<proc_t> > ranksOnEachNode;
+        for (const std::pair<const proc_t, std::vector<proc_t> >& ranks : ranksOnEachLabel)
+        {
+          ranksOnEachNode.push_back(ranks.second);
+        }
+
+        if (ranksOnEachNode.size() == 1 || proc_t(ranksOnEachNode.size()) == comms.Size())
+        {
+          log::Logger::Log<log::Debug, log::Singleton>("Not placing parts on nodes: every rank shares a node, or none do.");
+          return;
+        }
+
+        // Ask the ranks holding the far ends of our sites' adjacencies which parts those
+        // sites are in.
+        const proc_t rank = comms.Rank();
+        const idx_t firstLocalVertex = vtxDistribn[rank];
+        std::map<int, std::vector<idx_t> > verticesNeeded;
+        for (idx_t vertex : localAdjacencies)
+        {
+          if (vertex < firstLocalVertex || vertex >= vtxDistribn[rank + 1])
+          {
+            const proc_t owner = std::upper_bound(vtxDistribn.begin(), vtxDistribn.end(), vertex)
+                - vtxDistribn.begin() - 1;
+            verticesNeeded[owner].push_back(vertex);
+          }
+        }
+        for (std::pair<const int, std::vector<idx_t> >& vertices : verticesNeeded)
+        {
+          std::sort(vertices.second.begin(), vertices.second.end());
+          vertices.second.erase(std::unique(vertices.second.begin(), vertices.second.end()),
+                                vertices.second.end());
+        }
+
+        const std::map<int, std::vector<idx_t> > verticesRequested =
+            comms.SparseExchange(verticesNeeded, VERTICES_NEEDED_TAG);
+        std::map<int, std::vector<idx_t> > partsToSend;
+        for (const std::pair<const int, std::vector<idx_t> >& vertices : verticesRequested)
+        {
+          std::vector<idx_t>& parts = partsToSend[vertices.first];
+          for (idx_t vertex : vertices.second)
+          {
+            parts.push_back(partitionVector[vertex - firstLocalVertex]);
+          }
+        }
+        std::map<int, std::vector<idx_t> > partsReceived = comms.SparseExchange(partsToSend,
+                                                                                PARTS_OF_VERTICES_TAG);
+
+        std::map<idx_t, idx_t> remotePartForEachVertex;
+        for (const std::pair<const int, std::vector<idx_t> >& vertices : verticesNeeded)
+        {
+          const std::vector<idx_t>& parts = partsReceived[vertices.first];
+          for (std::size_t i = 0; i < vertices.second.size(); ++i)
+          {
+            remotePartForEachVertex[vertices.second[i]] = parts[i];
+          }
+        }
+
+        // Count the links between each pair of different parts, and gather them on one rank.
+        std::map<std::pair<idx_t, idx_t>, idx_t> linksBetweenParts;
+        for (idx_t localVertex = 0; localVertex < localVertexCount; ++localVertex)
+        {
+          const idx_t part = partitionVector[localVertex];
+          for (idx_t adjacency = adjacenciesPerVertex[localVertex];
+              adjacency < adjacenciesPerVertex[localVertex + 1]; ++adjacency)
+          {
+            const idx_t vertex = localAdjacencies[adjacency];
+            const idx_t otherPart = (vertex >= firstLocalVertex && vertex < vtxDistribn[rank + 1]) ?
+              partitionVector[vertex - firstLocalVertex] :
+              remotePartForEachVertex[vertex];
+            if (otherPart != part)
+            {
+              ++linksBetweenParts[std::make_pair(std::min(part, otherPart),
+                                                 std::max(part, otherPart))];
+            }
+          }
+        }
+        std::vector<idx_t> localLinks;
+        for (const std::pair<const std::pair<idx_t, idx_t>, idx_t>& links : linksBetweenParts)
+        {
+          localLinks.push_back(links.first.first);
+          localLinks.push_back(links.first.second);
+          localLinks.push_back(links.second);
+        }
+        const std::vector<idx_t> allLinks = comms.GatherV(localLinks, 0);
+
+        std::vector<proc_t> rankForEachPart(comms.Size());
+        if (rank == 0)
+        {
+          NodePlacement placement(ranksOnEachNode);
+          for (std::size_t i = 0; i < allLinks.size(); i += 3)
+          {
+            placement.AddLinks(allLinks[i], allLinks[i + 1], allLinks[i + 2]);
+          }
+          rankForEachPart = placement.Place();
+
+          std::vector<proc_t> unplaced(comms.Size());
+          for (proc_t part = 0; part < comms.Size(); ++part)
+          {
+            unplaced[part] = part;
+          }
+          log::Logger::Log<log::Info, log::Singleton>("Placing parts on %d nodes: %ld links between nodes, down from %ld.",
+                                                      (int) ranksOnEachNode.size(),
+                                                      (long) placement.CountLinksBetweenNodes(rankForEachPart),
+                                                      (long) placement.CountLinksBetweenNodes(unplaced));
+        }
+        comms.Broadcast(rankForEachPart, 0);
+
+        for (idx_t& part : partitionVector)
+        {
+          part = rankForEachPart[part];
+        }
       }
 
       void OptimisedDecomposition::PopulateVertexWeightData(idx_t localVertexCount)
@@ -193,6 +325,14 @@ namespace hemelb
         int FluidSiteCounter = 0, WallSiteCounter = 0, IOSiteCounter = 0, WallIOSiteCounter = 0;
         int localweight = 1;
 
+        int siteWeights[CollisionCosts::CollisionTypeCount];
+        for (unsigned type = 0; type < CollisionCosts::CollisionTypeCount; ++type)
+        {
+          siteWeights[type] = collisionCosts ?
+            collisionCosts->GetWeight(type) :
+            hemelbSiteWeights[type];
+        }
+
         // For each block (counting up by lowest site id)...
         for (site_t blockI = 0; blockI < geometry.GetBlockDimensions().x; blockI++)
         {
@@ -245,32 +385,32 @@ namespace hemelb
                     switch (siteData.GetCollisionType())
                     {
                       case FLUID:
-                        localweight = hemelbSiteWeights[0];
+                        localweight = siteWeights[0];
                         ++FluidSiteCounter;
                         break;
 
                       case WALL:
-                        localweight = hemelbSiteWeights[1];
+                        localweight = siteWeights[1];
                         ++WallSiteCounter;
                         break;
 
                       case INLET:
-                        localweight = hemelbSiteWeights[2];
+                        localweight = siteWeights[2];
                         ++IOSiteCounter;
                         break;
 
                       case OUTLET:
-                        localweight = hemelbSiteWeights[3];
+                        localweight = siteWeights[3];
                         ++IOSiteCounter;
                         break;
 
                       case (INLET | WALL):
-                        localweight = hemelbSiteWeights[4];
+                        localweight = siteWeights[4];
                         ++WallIOSiteCounter;
                         break;
 
                       case (OUTLET | WALL):
-                        localweight = hemelbSiteWeights[5];
+                        localweight = siteWeights[5];
                         ++WallIOSiteCounter;
                         break;
                     }
@@ -291,9 +431,9 @@ namespace hemelb
           }
         }
 
-        int TotalCoreWeight = ( (FluidSiteCounter * hemelbSiteWeights[0])
-            + (WallSiteCounter * hemelbSiteWeights[1]) + (IOSiteCounter * hemelbSiteWeights[2])
-            + (WallIOSiteCounter * hemelbSiteWeights[4])) / hemelbSiteWeights[0];
+        int TotalCoreWeight = ( (FluidSiteCounter * siteWeights[0])
+            + (WallSiteCounter * siteWeights[1]) + (IOSiteCounter * siteWeights[2])
+            + (WallIOSiteCounter * siteWeights[4])) / siteWeights[0];
         int TotalSites = FluidSiteCounter + WallSiteCounter + WallIOSiteCounter;
 
         log::Logger::Log<log::Debug, log::OnePerCore>("There are %u Bulk Flow Sites, %u Wall Sites, %u IO Sites, %u WallIO Sites on core %u. Total: %u (Weighted %u Points)",
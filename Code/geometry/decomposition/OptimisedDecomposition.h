@@ -16,6 +16,7 @@
 #include "net/MpiCommunicator.h"
 #include "geometry/SiteData.h"
 #include "geometry/GeometryBlock.h"
+#include "geometry/decomposition/CollisionCosts.h"
 
 namespace hemelb
 {
@@ -30,7 +31,8 @@ namespace hemelb
                                  const Geometry& geometry,
                                  const lb::lattices::LatticeInfo& latticeInfo,
                                  const std::vector<proc_t>& procForEachBlock,
-                                 const std::vector<site_t>& fluidSitesPerBlock);
+                                 const std::vector<site_t>& fluidSitesPerBlock,
+                                 const CollisionCosts* collisionCosts = NULL);
 
           /**
            * Returns a vector with the number of moves coming from each core
@@ -54,7 +56,8 @@ namespace hemelb
           typedef util::Vector3D<site_t> BlockLocation;
           /**
            * Populates the vector of vertex weights with different values for each local site type.
-           * This allows ParMETIS to more efficiently decompose the system.
+           * This allows ParMETIS to more efficiently decompose the system. The weights are the
+           * measured collision costs, if there are any, or else the built-in guesses.
            *
            * @return
            */
@@ -88,6 +91,15 @@ namespace hemelb
            */
           void CallParmetis(idx_t localVertexCount);
 
+          /**
+           * Renumber the parts ParMetis has made so that the ones sharing the most links are
+           * given ranks on the same node. ParMetis treats every rank as equally far from every
+           * other, so without this its neighbouring parts are spread over the nodes arbitrarily.
+           *
+           * @param localVertexCount [in] The number of local fluid sites
+           */
+          void PlacePartsOnNodes(idx_t localVertexCount);
+
           /**
            * Populate the list of moves from each proc that we need locally, using the
            * partition vector.
@@ -206,12 +218,17 @@ namespace hemelb
                              std::map<proc_t, std::vector<site_t> > blockIdsXRequiresFromMe,
                              std::map<site_t, std::vector<idx_t> > moveDataForEachBlock);
 
+          //! The tags for the sparse exchanges of the parts of neighbouring vertices.
+          static const int VERTICES_NEEDED_TAG = 44;
+          static const int PARTS_OF_VERTICES_TAG = 45;
+
           reporting::Timers& timers; //! Timers for reporting.
           net::MpiCommunicator& comms; //! Communicator
           const Geometry& geometry; //! The geometry being optimised.
           const lb::lattices::LatticeInfo& latticeInfo; //! The lattice info to optimise for.
           const std::vector<proc_t>& procForEachBlock; //! The processor assigned to each block at the moment
           const std::vector<site_t>& fluidSitesPerBlock; //! The number of fluid sites on each block.
+          const CollisionCosts* collisionCosts; //! The measured cost of each site type, or NULL.
           std::vector<idx_t> vtxDistribn; //! The vertex distribution across participating cores.
           std::vector<idx_t> firstSiteIndexPerBlock; //! The global contiguous index of the first fluid site on each block.
           std::vector<idx_t> adjacenciesPerVertex; //! The number of adjacencies for each local fluid site
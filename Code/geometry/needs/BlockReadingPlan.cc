@@ -0,0 +1,89 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+
+#include "geometry/needs/BlockReadingPlan.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    BlockReadingPlan::BlockReadingPlan(const std::vector<unsigned int>& bytesPerCompressedBlock,
+                                       proc_t readerCount, uint64_t maxChunkBytes) :
+        readerForEachBlock(bytesPerCompressedBlock.size()),
+            blockOffsets(bytesPerCompressedBlock.size() + 1, 0),
+            chunkStartsForEachReader(readerCount), roundCount(0)
+    {
+      const site_t blockCount = bytesPerCompressedBlock.size();
+      for (site_t block = 0; block < blockCount; ++block)
+      {
+        blockOffsets[block + 1] = blockOffsets[block] + bytesPerCompressedBlock[block];
+      }
+      const uint64_t totalBytes = blockOffsets[blockCount];
+
+      // Each block goes to the reader whose equal share of the bytes it starts in (any empty
+      // blocks at the very end go to the last reader).
+      for (site_t block = 0; block < blockCount; ++block)
+      {
+        readerForEachBlock[block] = totalBytes == 0 ?
+          0 :
+          std::min(readerCount - 1, proc_t(blockOffsets[block] * readerCount / totalBytes));
+      }
+
+      // Split each reader's run into chunks. A chunk always has at least one non-empty block,
+      // however long; empty blocks join the chunk before them.
+      site_t block = 0;
+      for (proc_t reader = 0; reader < readerCount; ++reader)
+      {
+        std::vector<site_t>& chunkStarts = chunkStartsForEachReader[reader];
+        const site_t firstBlock = block;
+        uint64_t chunkStartOffset = blockOffsets[block];
+        chunkStarts.push_back(block);
+
+        for (; block < blockCount && readerForEachBlock[block] == reader; ++block)
+        {
+          if (bytesPerCompressedBlock[block] > 0
+              && blockOffsets[block + 1] - chunkStartOffset > maxChunkBytes
+              && blockOffsets[block] > chunkStartOffset)
+          {
+            chunkStarts.push_back(block);
+            chunkStartOffset = blockOffsets[block];
+          }
+        }
+
+        if (block == firstBlock)
+        {
+          // No blocks at all for this reader.
+          chunkStarts.clear();
+        }
+        else
+        {
+          chunkStarts.push_back(block);
+        }
+
+        if (!chunkStarts.empty())
+        {
+          roundCount = std::max(roundCount, (unsigned int) (chunkStarts.size() - 1));
+        }
+      }
+    }
+
+    void BlockReadingPlan::GetChunk(proc_t reader, unsigned int round, site_t& firstBlock,
+                                    site_t& endBlock) const
+    {
+      const std::vector<site_t>& chunkStarts = chunkStartsForEachReader[reader];
+      if (round + 1 < chunkStarts.size())
+      {
+        firstBlock = chunkStarts[round];
+        endBlock = chunkStarts[round + 1];
+      }
+      else
+      {
+        firstBlock = endBlock = 0;
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_GEOMETRY_NEEDS_BLOCKREADINGPLAN_H
+#define HEMELB_GEOMETRY_NEEDS_BLOCKREADINGPLAN_H
+
+#include <cstdint>
+#include <vector>
+#include "units.h"
+
+namespace hemelb
+{
+  namespace geometry
+  {
+    /**
+     * Shares the blocks of a geometry file out between the reading cores so that each reads
+     * one contiguous run of blocks, with about the same number of compressed bytes as the
+     * others, and splits each run into chunks of at most a given size. The cores read one chunk
+     * each per round, so a round can be a single collective read.
+     *
+     * Every rank constructs the same plan from the header data.
+     */
+    class BlockReadingPlan
+    {
+      public:
+        /**
+         * @param bytesPerCompressedBlock the length of each block in the file
+         * @param readerCount the number of reading cores (ranks 0 to readerCount - 1)
+         * @param maxChunkBytes the most to read in one chunk, unless a single block is longer
+         */
+        BlockReadingPlan(const std::vector<unsigned int>& bytesPerCompressedBlock,
+                         proc_t readerCount, uint64_t maxChunkBytes);
+
+        /**
+         * @return the reading core for each block
+         */
+        const std::vector<proc_t>& GetReaderForEachBlock() const
+        {
+          return readerForEachBlock;
+        }
+
+        /**
+         * @return the number of rounds needed for every reader to read all its chunks
+         */
+        unsigned int GetRoundCount() const
+        {
+          return roundCount;
+        }
+
+        /**
+         * The blocks read by a reader in a round; the range is empty if it has no chunk left.
+         * @param reader
+         * @param round
+         * @param firstBlock [out] the first block of the chunk
+         * @param endBlock [out] one past the last block of the chunk
+         */
+        void GetChunk(proc_t reader, unsigned int round, site_t& firstBlock,
+                      site_t& endBlock) const;
+
+        /**
+         * @param block a block, or the block count for the end of the last block
+         * @return where the block starts, relative to the start of the first block
+         */
+        uint64_t GetBlockOffset(site_t block) const
+        {
+          return blockOffsets[block];
+        }
+
+      private:
+        std::vector<proc_t> readerForEachBlock;
+        //! The offset of each block, and the total length at the end.
+        std::vector<uint64_t> blockOffsets;
+        //! For each reader, the first block of each of its chunks followed by its end block.
+        std::vector<std::vector<site_t> > chunkStartsForEachReader;
+        unsigned int roundCount;
+    };
+  }
+}
+#endif // HEMELB_GEOMETRY_NEEDS_BLOCKREADINGPLAN_H
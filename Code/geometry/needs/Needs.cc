@@ -16,8 +16,10 @@ namespace hemelb
                  const std::vector<bool>& readBlock,
                  const proc_t readingGroupSize,
                  net::InterfaceDelegationNet & net,
-                 bool shouldValidate_) :
-        procsWantingBlocksBuffer(blockCount), communicator(net.GetCommunicator()), readingGroupSize(readingGroupSize), shouldValidate(shouldValidate_)
+                 bool shouldValidate_,
+                 const std::vector<proc_t>& readingCoreForEachBlock) :
+        procsWantingBlocksBuffer(blockCount), communicator(net.GetCommunicator()), readingGroupSize(readingGroupSize),
+            readingCoreForEachBlock(readingCoreForEachBlock), shouldValidate(shouldValidate_)
     {
       // Compile the blocks needed here into an array of indices, instead of an array of bools
       std::vector<std::vector<site_t> > blocksNeededHere(readingGroupSize);
@@ -122,6 +124,10 @@ namespace hemelb
 
     proc_t Needs::GetReadingCoreForBlock(const site_t blockNumber) const
     {
+      if (!readingCoreForEachBlock.empty())
+      {
+        return readingCoreForEachBlock[blockNumber];
+      }
       return proc_t(blockNumber % readingGroupSize);
     }
   } //namespace
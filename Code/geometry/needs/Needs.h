@@ -29,12 +29,15 @@ namespace hemelb
          * @param readBlock Which cores need which blocks, as an array of booleans.
          * @param readingGroupSize Number sof cores to use for reading blocks
          * @param net Instance of Net communication class to use.
+         * @param readingCoreForEachBlock The reading core for each block, or empty to share the
+         * blocks round-robin between the reading cores.
          */
        Needs(const site_t blockCount,
                           const std::vector<bool>& readBlock,
                           const proc_t readingGroupSize,
                           net::InterfaceDelegationNet &net,
-                          bool shouldValidate); // Temporarily during the refactor, constructed just to abstract the block sharing bit
+                          bool shouldValidate,
+                          const std::vector<proc_t>& readingCoreForEachBlock = std::vector<proc_t>()); // Temporarily during the refactor, constructed just to abstract the block sharing bit
 
         /***
          * Which processors need a given block?
@@ -58,6 +61,7 @@ namespace hemelb
         std::vector<std::vector<proc_t> > procsWantingBlocksBuffer;
         const net::MpiCommunicator & communicator;
         const proc_t readingGroupSize;
+        const std::vector<proc_t> readingCoreForEachBlock;
         bool shouldValidate;
         void Validate(const site_t blockCount, const std::vector<bool>& readBlock);
     };
@@ -19,10 +19,9 @@ namespace hemelb
 
       NeighbouringDataManager::NeighbouringDataManager(
           const LatticeData & localLatticeData, NeighbouringLatticeData & neighbouringLatticeData,
-          net::InterfaceDelegationNet & net) :
+          net::InterfaceDelegationNet & net, bool shareNeedsSparsely) :
           localLatticeData(localLatticeData), neighbouringLatticeData(neighbouringLatticeData),
-              net(net), needsEachProcHasFromMe(net.Size()),
-              needsHaveBeenShared(false)
+              net(net), needsHaveBeenShared(false), shareNeedsSparsely(shareNeedsSparsely)
       {
       }
       void NeighbouringDataManager::RegisterNeededSite(site_t globalId,
@@ -65,11 +64,13 @@ namespace hemelb
                              source);
           net.RequestReceiveR(site.GetWallNormal(), source);
         }
-        for (proc_t other = 0; other < net.Size(); other++)
+        for (std::map<proc_t, std::vector<site_t> >::iterator needsOfProc =
+            needsEachProcHasFromMe.begin(); needsOfProc != needsEachProcHasFromMe.end();
+            ++needsOfProc)
         {
-          for (std::vector<site_t>::iterator needOnProcFromMe =
-              needsEachProcHasFromMe[other].begin();
-              needOnProcFromMe != needsEachProcHasFromMe[other].end(); needOnProcFromMe++)
+          const proc_t other = needsOfProc->first;
+          for (std::vector<site_t>::iterator needOnProcFromMe = needsOfProc->second.begin();
+              needOnProcFromMe != needsOfProc->second.end(); needOnProcFromMe++)
           {
             site_t localContiguousId =
                 localLatticeData.GetLocalContiguousIdFromGlobalNoncontiguousId(*needOnProcFromMe);
@@ -118,20 +119,47 @@ namespace hemelb
                              source);
 
         }
-        for (proc_t other = 0; other < net.Size(); other++)
+        const Direction numVectors = localLatticeData.GetLatticeInfo().GetNumVectors();
+
+        // If a site's distributions aren't kept together, we send a gathered copy instead. This
+        // also covers in-place streaming, where fOld is overwritten before the send happens.
+        // Size the buffer up front so the pointers we hand out stay valid.
+        if (!LatticeData::SitesAreContiguous)
+        {
+          site_t sendCount = 0;
+          for (std::map<proc_t, std::vector<site_t> >::iterator needsOfProc =
+              needsEachProcHasFromMe.begin(); needsOfProc != needsEachProcHasFromMe.end();
+              ++needsOfProc)
+          {
+            sendCount += needsOfProc->second.size();
+          }
+          sendGatherBuffer.resize(sendCount * numVectors);
+        }
+
+        site_t sendsSoFar = 0;
+        for (std::map<proc_t, std::vector<site_t> >::iterator needsOfProc =
+            needsEachProcHasFromMe.begin(); needsOfProc != needsEachProcHasFromMe.end();
+            ++needsOfProc)
         {
-          for (std::vector<site_t>::iterator needOnProcFromMe =
-              needsEachProcHasFromMe[other].begin();
-              needOnProcFromMe != needsEachProcHasFromMe[other].end(); needOnProcFromMe++)
+          const proc_t other = needsOfProc->first;
+          for (std::vector<site_t>::iterator needOnProcFromMe = needsOfProc->second.begin();
+              needOnProcFromMe != needsOfProc->second.end(); needOnProcFromMe++)
           {
             site_t localContiguousId =
                 localLatticeData.GetLocalContiguousIdFromGlobalNoncontiguousId(*needOnProcFromMe);
             Site<LatticeData> site =
                 const_cast<LatticeData&>(localLatticeData).GetSite(localContiguousId);
+            const distribn_t* fOld = site.GetFOld(numVectors);
+            if (!LatticeData::SitesAreContiguous)
+            {
+              distribn_t* gathered = &sendGatherBuffer[sendsSoFar * numVectors];
+              std::copy(fOld, fOld + numVectors, gathered);
+              fOld = gathered;
+            }
+            ++sendsSoFar;
+
             // have to cast away the const, because no respect for const-ness for sends in MPI
-            net.RequestSend(const_cast<distribn_t*>(site.GetFOld(localLatticeData.GetLatticeInfo().GetNumVectors())),
-                            localLatticeData.GetLatticeInfo().GetNumVectors(),
-                            other);
+            net.RequestSend(const_cast<distribn_t*>(fOld), numVectors, other);
 
           }
         }
@@ -144,14 +172,28 @@ namespace hemelb
         //  return; //TODO: Fix!
         
         // build a table of which procs needs can be achieved from which proc
-        std::vector<std::vector<site_t> > needsIHaveFromEachProc(net.Size());
-        std::vector<int> countOfNeedsIHaveFromEachProc(net.Size(), 0);
+        std::map<proc_t, std::vector<site_t> > needsIHaveFromEachProc;
         for (std::vector<site_t>::iterator localNeed = neededSites.begin();
             localNeed != neededSites.end(); localNeed++)
         {
           needsIHaveFromEachProc[ProcForSite(*localNeed)].push_back(*localNeed);
-          countOfNeedsIHaveFromEachProc[ProcForSite(*localNeed)]++;
+        }
 
+        if (shareNeedsSparsely)
+        {
+          // Each proc only hears from the procs needing something from it.
+          needsEachProcHasFromMe = net.GetCommunicator().SparseExchange(needsIHaveFromEachProc,
+                                                                        SHARENEEDSTAG);
+          needsHaveBeenShared = true;
+          return;
+        }
+
+        std::vector<int> countOfNeedsIHaveFromEachProc(net.Size(), 0);
+        for (std::map<proc_t, std::vector<site_t> >::iterator needsOfProc =
+            needsIHaveFromEachProc.begin(); needsOfProc != needsIHaveFromEachProc.end();
+            ++needsOfProc)
+        {
+          countOfNeedsIHaveFromEachProc[needsOfProc->first] = needsOfProc->second.size();
         }
 
         // every proc must send to all procs, how many it needs from that proc
@@ -162,15 +204,21 @@ namespace hemelb
         net.RequestAllToAllReceive(countOfNeedsOnEachProcFromMe);
         net.Dispatch();
 
+        needsEachProcHasFromMe.clear();
         const int netSize = net.Size(); // avoid calling e.g. MPI_Comm_size many times; it is not inlined
         for (proc_t other = 0; other < netSize; other++)
         {
-
           // now, for every proc, which I need something from,send the ids of those
-          net.RequestSendV(needsIHaveFromEachProc[other], other);
+          if (countOfNeedsIHaveFromEachProc[other] > 0)
+          {
+            net.RequestSendV(needsIHaveFromEachProc[other], other);
+          }
           // and, for every proc, which needs something from me, receive those ids
-          needsEachProcHasFromMe[other].resize(countOfNeedsOnEachProcFromMe[other]);
-          net.RequestReceiveV(needsEachProcHasFromMe[other], other);
+          if (countOfNeedsOnEachProcFromMe[other] > 0)
+          {
+            needsEachProcHasFromMe[other].resize(countOfNeedsOnEachProcFromMe[other]);
+            net.RequestReceiveV(needsEachProcHasFromMe[other], other);
+          }
           // In principle, this bit could have been implemented as a separate GatherV onto every proc
           // However, in practice, we expect the needs to be basically local
           // so using point-to-point will be more efficient.
@@ -27,9 +27,15 @@ namespace hemelb
       class NeighbouringDataManager : public net::IteratedAction
       {
         public:
+          /**
+           * @param shareNeedsSparsely whether ShareNeeds should contact only the processes
+           * that needs are shared with, by MpiCommunicator::SparseExchange, rather than doing
+           * an all-to-all of counts. This needs a real MPI communicator under the net.
+           */
           NeighbouringDataManager(const LatticeData & localLatticeData,
                                   NeighbouringLatticeData & neighbouringLatticeData,
-                                  net::InterfaceDelegationNet & net);
+                                  net::InterfaceDelegationNet & net,
+                                  bool shareNeedsSparsely = false);
           // Initially, the required site information will not be used -- we just transfer everything.
           // This considerably simplifies matters.
           // Nevertheless, we provide the interface here in its final form
@@ -56,9 +62,15 @@ namespace hemelb
           net::InterfaceDelegationNet & net;
 
           std::vector<site_t> neededSites;
-          std::vector<std::vector<site_t> > needsEachProcHasFromMe;
+          //! Only has entries for the processes needing something.
+          std::map<proc_t, std::vector<site_t> > needsEachProcHasFromMe;
+          std::vector<distribn_t> sendGatherBuffer; //! Gathered copies of sent fOlds, for layouts that need it.
 
           bool needsHaveBeenShared;
+          bool shareNeedsSparsely;
+
+          //! Tag for the messages of the sparse exchange, distinct from the net's.
+          static const int SHARENEEDSTAG = 20;
 
       };
 
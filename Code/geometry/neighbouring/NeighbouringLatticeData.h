@@ -28,6 +28,9 @@ namespace hemelb
         public:
           friend class Site<NeighbouringLatticeData> ; //! Let the inner classes have access to site-related data that's otherwise private.
 
+          //! Each neighbouring site's distribution is stored contiguously, whatever the local layout.
+          static const bool SitesAreContiguous = true;
+
           NeighbouringLatticeData(const lb::lattices::LatticeInfo& latticeInfo);
           virtual ~NeighbouringLatticeData()
           {
@@ -77,6 +80,24 @@ namespace hemelb
            */
           const distribn_t* GetFOld(site_t distributionIndex) const;
 
+          /**
+           * For compatibility with lattice data. Neighbouring sites are always stored
+           * contiguously so this never needs the gather buffer.
+           * @param globalIndex
+           * @param gatherBuffer
+           * @return
+           */
+          template<typename LatticeType>
+          const distribn_t* GetFOldForSite(site_t globalIndex, distribn_t* gatherBuffer) const
+          {
+            return GetFOld(globalIndex * LatticeType::NUMVECTORS);
+          }
+
+          site_t GetFOldIndex(site_t globalIndex, Direction direction) const
+          {
+            return globalIndex * latticeInfo.GetNumVectors() + direction;
+          }
+
           /*
            * This is not defined for Neighbouring Data.
            * Data streamed across boundaries is handled by the existing mechanism.
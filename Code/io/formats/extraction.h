@@ -7,6 +7,9 @@
 #ifndef HEMELB_IO_FORMATS_EXTRACTION_H
 #define HEMELB_IO_FORMATS_EXTRACTION_H
 
+#include <cstdint>
+#include <string>
+
 namespace hemelb
 {
   namespace io
@@ -32,6 +35,47 @@ namespace hemelb
           VersionNumber = 4
         };
 
+        /**
+         * The version number of the geometry-once variant of the format. This has the same main
+         * and field headers, followed by a geometry header (see GeometryHeaderLength) and the
+         * uint x 3 grid coordinates of every site, once, in the order the sites appear in each
+         * timestep. A timestep is then only the uhyper timestep number and the field values.
+         */
+        enum
+        {
+          GeometryOnceVersionNumber = 5
+        };
+
+        /**
+         * The length of the geometry header in the geometry-once variant. Made up of:
+         * uint - Flags, from GeometryFlags
+         */
+        enum
+        {
+          GeometryHeaderLength = 4
+        };
+
+        enum GeometryFlags
+        {
+          //! The field values are little-endian floats, rather than XDR (big-endian) ones.
+          LittleEndianFields = 0x1,
+          /**
+           * Each core's field values for a timestep are a separate zlib stream (after the
+           * timestep number, for the first core), so the timesteps vary in length. Where each
+           * core's chunk starts is in the offset file, which has the per-timestep version.
+           */
+          CompressedFields = 0x2
+        };
+
+        /**
+         * @return whether this machine stores floats little-endian
+         */
+        inline bool IsLittleEndian()
+        {
+          const uint32_t one = 1;
+          return *reinterpret_cast<const unsigned char*>(&one) == 1;
+        }
+
         /**
          * The length of the main header. Made up of:
          * uint - HemeLbMagicNumber
@@ -7,6 +7,10 @@
 #ifndef HEMELB_IO_FORMATS_OFFSET_H
 #define HEMELB_IO_FORMATS_OFFSET_H
 
+#include <cstdint>
+#include <string>
+#include "Exception.h"
+
 namespace hemelb
 {
   namespace io
@@ -32,6 +36,15 @@ namespace hemelb
           VersionNumber = 1
         };
 
+        /**
+         * The version number of offset files for compressed extraction files, whose body has a
+         * record, as below, for every timestep.
+         */
+        enum
+        {
+          PerTimestepVersionNumber = 2
+        };
+
 	// Header contains:
 	// - HemeLb magic - uint32
 	// - Offset magic - uint32
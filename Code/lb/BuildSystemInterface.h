@@ -119,7 +119,8 @@ namespace hemelb
 
     /**
      * The following classes have names corresponding to the options given in the build system for
-     * HEMELB_WALL_BOUNDARY
+     * HEMELB_WALL_BOUNDARY. These and the wall-iolet classes below say whether the boundary works
+     * with in-place streaming (see geometry::StreamingPattern).
      */
     /**
      * The Bouzidi-Firdaous-Lallemand interpolation-based boundary condition.
@@ -129,6 +130,7 @@ namespace hemelb
     {
       public:
         typedef typename streamers::BouzidiFirdaousLallemand<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = false;
     };
     /**
      * The Guo Zheng and Shi mode-extrapolation boundary condition.
@@ -138,6 +140,7 @@ namespace hemelb
     {
       public:
         typedef typename streamers::GuoZhengShi<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = false;
     };
     /**
      * The simple bounce back boundary condition.
@@ -147,6 +150,7 @@ namespace hemelb
     {
       public:
         typedef typename streamers::SimpleBounceBack<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = true;
     };
     /**
      * The Junk & Yang 2005 boundary condition.
@@ -156,6 +160,7 @@ namespace hemelb
     {
       public:
         typedef typename streamers::JunkYang<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = false;
     };
 
     /**
@@ -194,6 +199,7 @@ namespace hemelb
     {
       public:
         typedef typename streamers::NashZerothOrderPressureIoletSBB<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = true;
     };
 
     /**
@@ -203,6 +209,7 @@ namespace hemelb
     struct LADDIOLETSBB
     {
         typedef typename streamers::LaddIoletSBB<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = true;
     };
 
     /**
@@ -213,6 +220,7 @@ namespace hemelb
     {
       public:
         typedef typename streamers::NashZerothOrderPressureIoletBFL<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = false;
     };
 
     /**
@@ -222,6 +230,7 @@ namespace hemelb
     struct LADDIOLETBFL
     {
         typedef typename streamers::LaddIoletBFL<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = false;
     };
     /**
      * Nash in/outlet + GZS
@@ -231,6 +240,7 @@ namespace hemelb
     {
       public:
         typedef typename streamers::NashZerothOrderPressureIoletGZS<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = false;
     };
 
     /**
@@ -240,6 +250,7 @@ namespace hemelb
     struct LADDIOLETGZS
     {
         typedef typename streamers::LaddIoletGZS<Collision>::Type Type;
+        static const bool SupportsInPlaceStreaming = false;
     };
 
     /**
@@ -249,6 +260,7 @@ namespace hemelb
     struct VIRTUALSITEIOLETSBB
     {
         typedef typename streamers::VirtualSiteIolet<Collision> Type;
+        static const bool SupportsInPlaceStreaming = false;
     };
   }
 }
@@ -0,0 +1,85 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "lb/CollisionSchedule.h"
+#include "constants.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    CollisionRanges GetDomainEdgeCollisionRanges(const geometry::LatticeData& latticeData)
+    {
+      CollisionRanges ranges;
+      site_t offset = latticeData.GetMidDomainSiteCount();
+      for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; ++collisionType)
+      {
+        const site_t count = latticeData.GetDomainEdgeCollisionCount(collisionType);
+        ranges.push_back(CollisionRange(collisionType, offset, count));
+        offset += count;
+      }
+      return ranges;
+    }
+
+    CollisionRanges GetMidDomainCollisionRanges(const geometry::LatticeData& latticeData)
+    {
+      CollisionRanges ranges;
+      site_t offset = 0;
+      for (unsigned collisionType = 0; collisionType < COLLISION_TYPES; ++collisionType)
+      {
+        const site_t count = latticeData.GetMidDomainCollisionCount(collisionType);
+        ranges.push_back(CollisionRange(collisionType, offset, count));
+        offset += count;
+      }
+      return ranges;
+    }
+
+    void MergeCollisionRanges(CollisionRanges& ranges)
+    {
+      CollisionRanges merged;
+      for (const CollisionRange& range : ranges)
+      {
+        if (range.count == 0)
+        {
+          continue;
+        }
+        if (!merged.empty() && merged.back().collision == range.collision
+            && merged.back().first + merged.back().count == range.first)
+        {
+          merged.back().count += range.count;
+          merged.back().seconds += range.seconds;
+        }
+        else
+        {
+          merged.push_back(range);
+        }
+      }
+      ranges.swap(merged);
+    }
+
+    void SplitCollisionRanges(CollisionRanges& ranges, site_t maxCount, site_t granularity)
+    {
+      CollisionRanges split;
+      for (const CollisionRange& range : ranges)
+      {
+        site_t first = range.first;
+        const site_t end = range.first + range.count;
+        while (end - first > maxCount)
+        {
+          // Cut at the last multiple of the granularity that keeps the piece within maxCount.
+          site_t cut = ( (first + maxCount) / granularity) * granularity;
+          if (cut <= first)
+          {
+            cut = first + maxCount;
+          }
+          split.push_back(CollisionRange(range.collision, first, cut - first));
+          first = cut;
+        }
+        split.push_back(CollisionRange(range.collision, first, end - first));
+      }
+      ranges.swap(split);
+    }
+  }
+}
@@ -0,0 +1,216 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_COLLISIONSCHEDULE_H
+#define HEMELB_LB_COLLISIONSCHEDULE_H
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "units.h"
+#include "geometry/LatticeData.h"
+#include "util/utilityFunctions.h"
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * A contiguous range of sites, all updated by the same collision of a CollisionSchedule.
+     */
+    struct CollisionRange
+    {
+        CollisionRange(unsigned collision, site_t first, site_t count) :
+            collision(collision), first(first), count(count), seconds(0.0)
+        {
+        }
+
+        //! The index of the collision in the schedule, i.e. the LatticeData collision type.
+        unsigned collision;
+        site_t first;
+        site_t count;
+        //! The total time spent on this range, if the schedule is timed.
+        double seconds;
+    };
+
+    /**
+     * An ordered list of ranges, e.g. all the work for one phase of a time step. The ranges can
+     * be put in any order, so long as the caller respects whatever dependencies there are
+     * between phases.
+     */
+    typedef std::vector<CollisionRange> CollisionRanges;
+
+    /**
+     * The ranges of domain edge sites, one per collision type, in the order of the types.
+     */
+    CollisionRanges GetDomainEdgeCollisionRanges(const geometry::LatticeData& latticeData);
+
+    /**
+     * The ranges of mid-domain sites, one per collision type, in the order of the types.
+     */
+    CollisionRanges GetMidDomainCollisionRanges(const geometry::LatticeData& latticeData);
+
+    /**
+     * Remove empty ranges and join each range onto the one before it, if that is of the same
+     * collision and ends where it starts.
+     */
+    void MergeCollisionRanges(CollisionRanges& ranges);
+
+    /**
+     * Split ranges of more than maxCount sites into pieces of at most maxCount sites. The
+     * cuts are made on multiples of granularity (which should divide maxCount), so a range is
+     * never cut inside a tile of the distribution layout.
+     */
+    void SplitCollisionRanges(CollisionRanges& ranges, site_t maxCount, site_t granularity);
+
+    /**
+     * Call rangeFunctor(first, count) on pieces of [firstIndex, firstIndex + siteCount) that
+     * between them cover it once. When built with OpenMP and threaded is set, there is a piece
+     * per thread, each run on its own thread, with the cuts made on multiples of granularity.
+     * Otherwise the whole range is one piece, run on the calling thread.
+     *
+     * An exception thrown from a piece can't leave the parallel region, so the first one is
+     * caught there and rethrown to the caller once all the threads have finished.
+     */
+    template<typename RangeFunctor>
+    void ForEachThreadSiteRange(const site_t firstIndex, const site_t siteCount, const bool threaded,
+                                const site_t granularity, RangeFunctor&& rangeFunctor)
+    {
+#ifdef HEMELB_USE_OPENMP
+      if (threaded)
+      {
+        std::exception_ptr error;
+#pragma omp parallel
+        {
+          const site_t threadCount = omp_get_num_threads();
+          const site_t thread = omp_get_thread_num();
+          auto boundary = [&](site_t t)
+          {
+            if (t == threadCount)
+            {
+              return firstIndex + siteCount;
+            }
+            site_t cut = ( (firstIndex + (siteCount * t) / threadCount) / granularity) * granularity;
+            return std::max(firstIndex, cut);
+          };
+          const site_t begin = boundary(thread);
+          const site_t end = boundary(thread + 1);
+          if (end > begin)
+          {
+            try
+            {
+              rangeFunctor(begin, end - begin);
+            }
+            catch (...)
+            {
+#pragma omp critical(hemelbForEachThreadSiteRange)
+              if (!error)
+              {
+                error = std::current_exception();
+              }
+            }
+          }
+        }
+        if (error)
+        {
+          std::rethrow_exception(error);
+        }
+        return;
+      }
+#endif
+      rangeFunctor(firstIndex, siteCount);
+    }
+
+    /**
+     * Holds one streamer for each collision type and runs lists of ranges through them.
+     *
+     * Each range is dispatched through a table with an entry per collision, built at compile
+     * time for each kind of visitor, so running a list costs one indirect call per range
+     * rather than a chain of tests. The visitor is called as visitor(collision, range) with the
+     * streamer for range.collision; it decides what to do with it (stream and collide, post
+     * step, ...), so that any choice such as whether to ray trace can be made once for the
+     * whole list.
+     *
+     * If timed, the time spent in each range is added to its seconds.
+     */
+    template<class ... Collisions>
+    class CollisionSchedule
+    {
+      public:
+        static const unsigned CollisionCount = sizeof...(Collisions);
+
+        /**
+         * Takes ownership of the streamers, which must be given in collision type order.
+         */
+        CollisionSchedule(Collisions* ... collisions) :
+            collisions(std::unique_ptr<Collisions>(collisions)...), timed(false)
+        {
+        }
+
+        template<unsigned Index>
+        typename std::tuple_element<Index, std::tuple<Collisions...> >::type& Get()
+        {
+          return *std::get<Index>(collisions);
+        }
+
+        void SetTimed(bool isTimed)
+        {
+          timed = isTimed;
+        }
+
+        bool IsTimed() const
+        {
+          return timed;
+        }
+
+        template<class Visitor>
+        void Run(CollisionRanges& ranges, Visitor&& visitor)
+        {
+          typedef void (*Dispatcher)(CollisionSchedule&, Visitor&, const CollisionRange&);
+          static const std::array<Dispatcher, CollisionCount> table =
+              MakeTable<Visitor, Dispatcher>(std::make_index_sequence<CollisionCount>());
+
+          for (CollisionRange& range : ranges)
+          {
+            if (timed)
+            {
+              const double start = util::myClock();
+              table[range.collision](*this, visitor, range);
+              range.seconds += util::myClock() - start;
+            }
+            else
+            {
+              table[range.collision](*this, visitor, range);
+            }
+          }
+        }
+
+      private:
+        template<class Visitor, unsigned Index>
+        static void Dispatch(CollisionSchedule& schedule, Visitor& visitor, const CollisionRange& range)
+        {
+          visitor(schedule.template Get<Index>(), range);
+        }
+
+        template<class Visitor, class Dispatcher, std::size_t ... Indices>
+        static std::array<Dispatcher, CollisionCount> MakeTable(std::index_sequence<Indices...>)
+        {
+          return { { &Dispatch<Visitor, Indices>... } };
+        }
+
+        std::tuple<std::unique_ptr<Collisions>...> collisions;
+        bool timed;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_COLLISIONSCHEDULE_H */
@@ -10,6 +10,7 @@
 #include "geometry/LatticeData.h"
 #include "lb/MacroscopicPropertyCache.h"
 #include "net/PhasedBroadcastRegular.h"
+#include "net/CollectiveBroadcast.h"
 #include "reporting/Reportable.h"
 #include <cfloat>
 
@@ -218,6 +219,16 @@ namespace hemelb
          */
         void Effect();
 
+        /**
+         * For a collective broadcast, the density trackers are combined by CombineDensityTrackers.
+         */
+        net::CollectiveBroadcast::Reduction GetReduction();
+
+        /**
+         * An MPI operation doing UpdateDensityTracker on serialised density trackers.
+         */
+        static void CombineDensityTrackers(void* in, void* inOut, int* count, MPI_Datatype* type);
+
       private:
 
         /**
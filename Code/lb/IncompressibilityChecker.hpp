@@ -231,6 +231,31 @@ namespace hemelb
       globalDensityTracker = &downwardsDensityTracker;
     }
 
+    template<class BroadcastPolicy>
+    net::CollectiveBroadcast::Reduction IncompressibilityChecker<BroadcastPolicy>::GetReduction()
+    {
+      net::CollectiveBroadcast::Reduction reduction;
+      reduction.upwards = upwardsDensityTracker.GetDensitiesArray();
+      reduction.downwards = downwardsDensityTracker.GetDensitiesArray();
+      reduction.count = DensityTracker::DENSITY_TRACKER_SIZE;
+      reduction.type = net::MpiDataType<distribn_t>();
+      reduction.function = &CombineDensityTrackers;
+      return reduction;
+    }
+
+    template<class BroadcastPolicy>
+    void IncompressibilityChecker<BroadcastPolicy>::CombineDensityTrackers(void* in, void* inOut,
+                                                                           int* count, MPI_Datatype* type)
+    {
+      distribn_t* inDensities = static_cast<distribn_t*>(in);
+      distribn_t* inOutDensities = static_cast<distribn_t*>(inOut);
+      for (int offset = 0; offset < *count; offset += DensityTracker::DENSITY_TRACKER_SIZE)
+      {
+        DensityTracker combined(inOutDensities + offset);
+        combined.UpdateDensityTracker(DensityTracker(inDensities + offset));
+      }
+    }
+
     template<class BroadcastPolicy>
     bool IncompressibilityChecker<BroadcastPolicy>::AreDensitiesAvailable() const
     {
@@ -24,11 +24,11 @@ namespace hemelb {
 
     protected:
       // Allow access for derived classes (this is a friend of LatticeData)
-      inline distribn_t* GetFOld(geometry::LatticeData* ld, site_t i) const {
-	return ld->GetFOld(i);
+      inline void SetFOld(geometry::LatticeData* ld, site_t i, Direction d, distribn_t value) const {
+	ld->SetFOld(i, d, value);
       }
-      inline distribn_t* GetFNew(geometry::LatticeData* ld, site_t i) const {
-	return ld->GetFNew(i);
+      inline void SetFNew(geometry::LatticeData* ld, site_t i, Direction d, distribn_t value) const {
+	ld->SetFNew(i, d, value);
       }
 
       mutable boost::optional<LatticeTimeStep> initial_time;
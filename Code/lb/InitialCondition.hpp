@@ -32,11 +32,10 @@ namespace hemelb {
       LatticeType::CalculateFeq(density, mom_x, mom_y, mom_z, f_eq);
       
       for (site_t i = 0; i < latDat->GetLocalFluidSiteCount(); i++) {
-	distribn_t* f_old_p = this->GetFOld(latDat, i * LatticeType::NUMVECTORS);
-	distribn_t* f_new_p = this->GetFNew(latDat, i * LatticeType::NUMVECTORS);
-	
 	for (unsigned int l = 0; l < LatticeType::NUMVECTORS; l++) {
-	  f_new_p[l] = f_old_p[l] = f_eq[l];
+	  const site_t index = latDat->GetDistributionIndex<LatticeType>(i, l);
+	  this->SetFNew(latDat, index, l, f_eq[l]);
+	  this->SetFOld(latDat, index, l, f_eq[l]);
 	}
       }
     }
@@ -21,6 +21,7 @@ namespace hemelb
       tractionCache(simState, latticeData.GetLocalFluidSiteCount()),
       tangentialProjectionTractionCache(simState, latticeData.GetLocalFluidSiteCount()),
       velDistributionsCache(simState, latticeData.GetLocalFluidSiteCount()),
+      stabilityAccumulator(latticeData.GetLocalFluidSiteCount()),
       siteCount(latticeData.GetLocalFluidSiteCount())
     {
       ResetRequirements();
@@ -39,6 +40,15 @@ namespace hemelb
       velDistributionsCache.UnsetRefreshFlag();
     }
 
+    bool MacroscopicPropertyCache::RequiresRefresh() const
+    {
+      return densityCache.RequiresRefresh() || velocityCache.RequiresRefresh()
+          || vonMisesStressCache.RequiresRefresh() || wallShearStressMagnitudeCache.RequiresRefresh()
+          || shearRateCache.RequiresRefresh() || stressTensorCache.RequiresRefresh()
+          || tractionCache.RequiresRefresh() || tangentialProjectionTractionCache.RequiresRefresh()
+          || stabilityAccumulator.IsRequired();
+    }
+
     site_t MacroscopicPropertyCache::GetSiteCount() const
     {
       return siteCount;
@@ -10,6 +10,7 @@
 #include <vector>
 #include "geometry/LatticeData.h"
 #include "lb/SimulationState.h"
+#include "lb/StabilityAccumulator.h"
 #include "units.h"
 #include "util/RefreshableCache.hpp"
 
@@ -37,6 +38,13 @@ namespace hemelb
          */
         void ResetRequirements();
 
+        /**
+         * Whether the streamers have to put anything in the cache, or in the stability
+         * accumulator, during this step's sweep.
+         * @return
+         */
+        bool RequiresRefresh() const;
+
         /**
          * Returns the number of sites cached.
          * @return
@@ -88,6 +96,11 @@ namespace hemelb
          */
         util::RefreshableCache<util::Vector3D<LatticeStress> > velDistributionsCache;
 
+        /**
+         * The stability and convergence tests done during the collision sweep, if any.
+         */
+        StabilityAccumulator stabilityAccumulator;
+
       private:
         /**
          * The state of the simulation, including the number of timesteps passed.
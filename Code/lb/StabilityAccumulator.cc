@@ -0,0 +1,67 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "lb/StabilityAccumulator.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    StabilityAccumulator::StabilityAccumulator(site_t siteCount) :
+        siteCount(siteCount)
+    {
+#ifdef HEMELB_USE_OPENMP
+      slots.resize(omp_get_max_threads());
+#else
+      slots.resize(1);
+#endif
+      Reset();
+    }
+
+    void StabilityAccumulator::Reset()
+    {
+      checkStability = false;
+      compareVelocity = false;
+      recordVelocity = false;
+      for (Slot& slot : slots)
+      {
+        slot.maxVelocityChange = 0.0;
+        slot.unstable = false;
+      }
+    }
+
+    void StabilityAccumulator::RequestVelocityRecord()
+    {
+      // Only allocated if the convergence check is in use.
+      recordedVelocities.resize(siteCount);
+      recordVelocity = true;
+    }
+
+    bool StabilityAccumulator::IsUnstable() const
+    {
+      for (const Slot& slot : slots)
+      {
+        if (slot.unstable)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    distribn_t StabilityAccumulator::GetMaxVelocityChange() const
+    {
+      distribn_t maxChange = 0.0;
+      for (const Slot& slot : slots)
+      {
+        if (! (slot.maxVelocityChange <= maxChange))
+        {
+          maxChange = slot.maxVelocityChange;
+        }
+      }
+      return maxChange;
+    }
+  }
+}
@@ -0,0 +1,137 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_STABILITYACCUMULATOR_H
+#define HEMELB_LB_STABILITYACCUMULATOR_H
+
+#include <vector>
+#include "units.h"
+#include "util/Vector3D.h"
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace hemelb
+{
+  namespace lb
+  {
+    /**
+     * Does the stability and convergence tests of StabilityTester on each site as it is collided,
+     * rather than in a separate pass over the distributions afterwards.
+     *
+     * Tests are requested for the coming sweep over the lattice; the streamers then pass every
+     * site's hydrodynamic variables to Accumulate (via UpdateMinsAndMaxes). Each OpenMP thread
+     * reduces into its own slot and the slots are combined when the results are read.
+     *
+     * The stability test is of the post-collision distributions, which are what gets streamed.
+     * The convergence test compares the velocity of each site with the one recorded in the
+     * previous sweep, so recording must be requested for the sweep before the comparison.
+     */
+    class StabilityAccumulator
+    {
+      public:
+        StabilityAccumulator(site_t siteCount);
+
+        /**
+         * Clear the requests and the results, ready for the next sweep.
+         */
+        void Reset();
+
+        void RequestStabilityCheck()
+        {
+          checkStability = true;
+        }
+
+        void RequestVelocityComparison()
+        {
+          compareVelocity = true;
+        }
+
+        void RequestVelocityRecord();
+
+        bool IsRequired() const
+        {
+          return checkStability || compareVelocity || recordVelocity;
+        }
+
+        template<class LatticeType, class HydroVarsType>
+        void Accumulate(site_t siteIndex, const HydroVarsType& hydroVars)
+        {
+          Slot& slot = slots[GetThreadIndex()];
+
+          if (checkStability && !slot.unstable)
+          {
+            const distribn_t* f = hydroVars.GetFPostCollision().f;
+            for (unsigned l = 0; l < LatticeType::NUMVECTORS; ++l)
+            {
+              // Testing value > 0.0 also catches NaNs.
+              if (! (f[l] > 0.0))
+              {
+                slot.unstable = true;
+                break;
+              }
+            }
+          }
+
+          if (compareVelocity || recordVelocity)
+          {
+            const util::Vector3D<distribn_t> velocity = hydroVars.momentum / hydroVars.density;
+            if (compareVelocity)
+            {
+              const distribn_t change = (velocity - recordedVelocities[siteIndex]).GetMagnitude();
+              // Written so that a NaN change counts as the largest.
+              if (! (change <= slot.maxVelocityChange))
+              {
+                slot.maxVelocityChange = change;
+              }
+            }
+            if (recordVelocity)
+            {
+              recordedVelocities[siteIndex] = velocity;
+            }
+          }
+        }
+
+        /**
+         * Whether any site checked in the sweep had a distribution that wasn't positive.
+         */
+        bool IsUnstable() const;
+
+        /**
+         * The largest change in a site's velocity since the recorded sweep.
+         */
+        distribn_t GetMaxVelocityChange() const;
+
+      private:
+        /**
+         * One thread's results, padded so that threads don't write to the same cache line.
+         */
+        struct Slot
+        {
+            distribn_t maxVelocityChange;
+            bool unstable;
+            char padding[64 - sizeof(distribn_t) - sizeof(bool)];
+        };
+
+        static unsigned GetThreadIndex()
+        {
+#ifdef HEMELB_USE_OPENMP
+          return omp_get_thread_num();
+#else
+          return 0;
+#endif
+        }
+
+        site_t siteCount;
+        bool checkStability;
+        bool compareVelocity;
+        bool recordVelocity;
+        std::vector<Slot> slots;
+        std::vector<util::Vector3D<distribn_t> > recordedVelocities;
+    };
+  }
+}
+
+#endif /* HEMELB_LB_STABILITYACCUMULATOR_H */
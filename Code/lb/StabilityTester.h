@@ -8,7 +8,9 @@
 #define HEMELB_LB_STABILITYTESTER_H
 
 #include "net/PhasedBroadcastRegular.h"
+#include "net/CollectiveBroadcast.h"
 #include "geometry/LatticeData.h"
+#include "lb/MacroscopicPropertyCache.h"
 
 namespace hemelb
 {
@@ -25,17 +27,41 @@ namespace hemelb
      * can't overlap. We go down the tree to pass the overall stability to all nodes, and we go up
      * the tree to compose the local stability for all nodes to discover whether the simulation as
      * a whole is stable.
+     *
+     * If the monitoring config asks for the check to be fused, the distributions are tested by
+     * the streamers as they collide each site (see StabilityAccumulator) instead of by a
+     * separate pass over the lattice here. The test is then of the post-collision distributions
+     * rather than the streamed ones. The convergence criterion is unchanged: every site's
+     * velocity must change by at most the tolerance times the reference value over a step.
+     * But it is applied to the velocities before and after the previous step rather than this
+     * one, as the sweep only sees the distributions before they are collided, so convergence is
+     * reported one step later than without fusing (see StabilityTesterTests). The convergence
+     * check also becomes available with in-place streaming.
+     *
+     * The BroadcastPolicy may instead be net::CollectiveBroadcast, in which case the
+     * stabilities are combined by a reduction, once per round trip of the tree, rather than
+     * passed through the tree.
      */
-    template<class LatticeType>
-    class StabilityTester : public net::PhasedBroadcastRegular<>
+    template<class LatticeType, class BroadcastPolicy = net::PhasedBroadcastRegular<> >
+    class StabilityTester : public BroadcastPolicy
     {
       public:
         StabilityTester(const geometry::LatticeData * iLatDat, net::Net* net,
-                        SimulationState* simState, reporting::Timers& timings,
+                        SimulationState* simState, MacroscopicPropertyCache& propertyCache,
+                        reporting::Timers& timings,
                         const hemelb::configuration::SimConfig::MonitoringConfig* testerConfig) :
-            net::PhasedBroadcastRegular<>(net, simState, SPREADFACTOR), mLatDat(iLatDat),
-                mSimState(simState), timings(timings), testerConfig(testerConfig)
+            BroadcastPolicy(net, simState, SPREADFACTOR), mLatDat(iLatDat),
+                mSimState(simState), timings(timings), accumulator(propertyCache.stabilityAccumulator),
+                testerConfig(testerConfig), velocitiesRecorded(false), velocitiesCompared(false)
         {
+          // With in-place streaming fOld and fNew are the same array, so there is nothing to
+          // compare against, unless the velocities are recorded during the sweep.
+          if (geometry::StreamingPattern::InPlace && testerConfig->doConvergenceCheck
+              && !testerConfig->fuseStabilityCheck)
+          {
+            throw Exception() << "The convergence check is only available with in-place streaming"
+                << " if the stability check is fused";
+          }
           Reset();
         }
 
@@ -55,6 +81,37 @@ namespace hemelb
           }
         }
 
+        /**
+         * Ask the streamers for this step's part of a fused check, before they collide.
+         */
+        void RequestComms()
+        {
+          BroadcastPolicy::RequestComms();
+
+          if (testerConfig->fuseStabilityCheck)
+          {
+            const bool recordedLastStep = velocitiesRecorded;
+            accumulator.Reset();
+            velocitiesRecorded = false;
+
+            const LatticeTimeStep step = mSimState->Get0IndexedTimeStep();
+            if (this->SendsToParentOnStep(step))
+            {
+              accumulator.RequestStabilityCheck();
+              if (testerConfig->doConvergenceCheck && recordedLastStep)
+              {
+                accumulator.RequestVelocityComparison();
+              }
+            }
+            if (testerConfig->doConvergenceCheck && this->SendsToParentOnStep(step + 1))
+            {
+              accumulator.RequestVelocityRecord();
+              velocitiesRecorded = true;
+            }
+            velocitiesCompared = testerConfig->doConvergenceCheck && recordedLastStep;
+          }
+        }
+
       protected:
         /**
          * Override the methods from the base class to propagate data from the root, and
@@ -62,22 +119,22 @@ namespace hemelb
          */
         void ProgressFromChildren(unsigned long splayNumber)
         {
-          ReceiveFromChildren<int>(mChildrensStability, 1);
+          this->template ReceiveFromChildren<int>(mChildrensStability, 1);
         }
 
         void ProgressFromParent(unsigned long splayNumber)
         {
-          ReceiveFromParent<int>(&mDownwardsStability, 1);
+          this->template ReceiveFromParent<int>(&mDownwardsStability, 1);
         }
 
         void ProgressToChildren(unsigned long splayNumber)
         {
-          SendToChildren<int>(&mDownwardsStability, 1);
+          this->template SendToChildren<int>(&mDownwardsStability, 1);
         }
 
         void ProgressToParent(unsigned long splayNumber)
         {
-          SendToParent<int>(&mUpwardsStability, 1);
+          this->template SendToParent<int>(&mUpwardsStability, 1);
         }
 
         /**
@@ -93,15 +150,35 @@ namespace hemelb
 
           // No need to bother testing out local lattice points if we're going to be
           // sending up a 'Unstable' value anyway.
-          if (mUpwardsStability != Unstable)
+          if (mUpwardsStability != Unstable && testerConfig->fuseStabilityCheck)
+          {
+            // The streamers have done the work already.
+            if (accumulator.IsUnstable())
+            {
+              mUpwardsStability = Unstable;
+            }
+            else
+            {
+              // Without a comparison (e.g. on the first step) we can't say it has converged.
+              const bool converged = velocitiesCompared
+                  && accumulator.GetMaxVelocityChange() / testerConfig->convergenceReferenceValue
+                      <= testerConfig->convergenceRelativeTolerance;
+              mUpwardsStability = (testerConfig->doConvergenceCheck && converged) ?
+                StableAndConverged :
+                Stable;
+            }
+          }
+          else if (mUpwardsStability != Unstable)
           {
             bool unconvergedSitePresent = false;
 
             for (site_t i = 0; i < mLatDat->GetLocalFluidSiteCount(); i++)
             {
+              // With in-place streaming the site's distributions may be in one another's slots,
+              // depending on the parity of the step, but this looks at all of them.
               for (unsigned int l = 0; l < LatticeType::NUMVECTORS; l++)
               {
-                distribn_t value = *mLatDat->GetFNew(i * LatticeType::NUMVECTORS + l);
+                distribn_t value = mLatDat->GetFNewValue(mLatDat->GetDistributionIndex<LatticeType>(i, l), l);
 
                 // Note that by testing for value > 0.0, we also catch stray NaNs.
                 if (! (value > 0.0))
@@ -118,8 +195,9 @@ namespace hemelb
 
               if (testerConfig->doConvergenceCheck)
               {
+                distribn_t fNewBuffer[LatticeType::NUMVECTORS];
                 distribn_t relativeDifference =
-                    ComputeRelativeDifference(mLatDat->GetFNew(i * LatticeType::NUMVECTORS),
+                    ComputeRelativeDifference(mLatDat->GetFNewForSite<LatticeType>(i, fNewBuffer),
                                               mLatDat->GetSite(i).GetFOld<LatticeType>());
 
                 if (relativeDifference > testerConfig->convergenceRelativeTolerance)
@@ -254,7 +332,7 @@ namespace hemelb
               // With the current configuration the root node of the tree won't own any fluid sites. Its
               // state only depends on children nodes not on local state.
               if (anyConverged
-                  && (mUpwardsStability == StableAndConverged || GetParent() == NOPARENT))
+                  && (mUpwardsStability == StableAndConverged || this->GetParent() == BroadcastPolicy::NOPARENT))
               {
                 mUpwardsStability = StableAndConverged;
               }
@@ -269,6 +347,39 @@ namespace hemelb
           timings[hemelb::reporting::Timers::monitoring].Stop();
         }
 
+        /**
+         * For a collective broadcast, the stabilities are combined by CombineStabilities.
+         */
+        net::CollectiveBroadcast::Reduction GetReduction()
+        {
+          net::CollectiveBroadcast::Reduction reduction;
+          reduction.upwards = &mUpwardsStability;
+          reduction.downwards = &mDownwardsStability;
+          reduction.count = 1;
+          reduction.type = MPI_INT;
+          reduction.function = &CombineStabilities;
+          return reduction;
+        }
+
+        /**
+         * An MPI operation combining stabilities as PostReceiveFromChildren does: unstable
+         * anywhere is unstable, converged only if converged everywhere, and processes with
+         * nothing to say are ignored.
+         */
+        static void CombineStabilities(void* in, void* inOut, int* count, MPI_Datatype* type)
+        {
+          const int* stabilities = static_cast<const int*>(in);
+          int* combined = static_cast<int*>(inOut);
+          for (int ii = 0; ii < *count; ++ii)
+          {
+            if (combined[ii] == UndefinedStability
+                || (stabilities[ii] != UndefinedStability && stabilities[ii] < combined[ii]))
+            {
+              combined[ii] = stabilities[ii];
+            }
+          }
+        }
+
         /**
          * Apply the stability value sent by the root node to the simulation logic.
          */
@@ -305,8 +416,16 @@ namespace hemelb
         /** Timing object. */
         reporting::Timers& timings;
 
+        /** Where the streamers do the fused check. */
+        StabilityAccumulator& accumulator;
+
         /** Object containing the user-provided configuration for this class */
         const hemelb::configuration::SimConfig::MonitoringConfig* testerConfig;
+
+        /** Whether the velocities are being recorded in this step's sweep, for the next. */
+        bool velocitiesRecorded;
+        /** Whether this step's sweep compares the velocities. */
+        bool velocitiesCompared;
     };
   }
 }
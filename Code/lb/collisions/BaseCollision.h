@@ -19,6 +19,8 @@ namespace hemelb
     {
       template<typename>
       struct HydroVars;
+      template<typename>
+      struct HydroVarsBatch;
     }
     namespace collisions
     {
@@ -28,6 +30,10 @@ namespace hemelb
        *  - CalculatePreCollision(CHydroVars&, site_t)
        *  - Collide(const LbmParameters*, unsigned int, CHydroVars&)
        *  - Reset(InitParams*)
+       *  - SupportsBatch, and if it is true CalculatePreCollisionBatch(CHydroVarsBatch&) and
+       *      CollideBatch(const LbmParameters*, CHydroVarsBatch&) for several sites at once,
+       *      and CopyLaneTo(const CHydroVarsBatch&, unsigned, CHydroVars&) to get one of them
+       *      back as a single-site HydroVars.
        *
        * The following must be implemented must be collisions (which derive from this class
        * using the CRTP).
@@ -41,6 +47,11 @@ namespace hemelb
       {
         public:
           typedef KernelImpl CKernel;
+          typedef kernels::HydroVarsBatch<typename KernelImpl::LatticeType> CHydroVarsBatch;
+
+          // Collisions that depend on more than the kernel (e.g. imposing a boundary
+          // velocity) are always done one site at a time.
+          static const bool SupportsBatch = false;
 
           inline void CalculatePreCollision(kernels::HydroVars<KernelImpl>& hydroVars,
                                             const geometry::Site<geometry::LatticeData>& site)
@@ -54,6 +65,23 @@ namespace hemelb
             static_cast<CollisionImpl*>(this)->DoCollide(lbmParams, hydroVars);
           }
 
+          inline void CalculatePreCollisionBatch(CHydroVarsBatch& hydroVars)
+          {
+            static_cast<CollisionImpl*>(this)->DoCalculatePreCollisionBatch(hydroVars);
+          }
+
+          inline void CollideBatch(const LbmParameters* lbmParams, CHydroVarsBatch& hydroVars)
+          {
+            static_cast<CollisionImpl*>(this)->DoCollideBatch(lbmParams, hydroVars);
+          }
+
+          inline void CopyLaneTo(const CHydroVarsBatch& batch,
+                                 unsigned lane,
+                                 kernels::HydroVars<KernelImpl>& hydroVars)
+          {
+            static_cast<CollisionImpl*>(this)->DoCopyLaneTo(batch, lane, hydroVars);
+          }
+
       };
 
     }
@@ -24,6 +24,7 @@ namespace hemelb
       {
         public:
           typedef KernelType CKernel;
+          static const bool SupportsBatch = KernelType::SupportsBatch;
 
           Normal(kernels::InitParams& initParams) :
               kernel(initParams)
@@ -42,6 +43,24 @@ namespace hemelb
             kernel.Collide(lbmParams, iHydroVars);
           }
 
+          inline void DoCalculatePreCollisionBatch(typename KernelType::KHydroVarsBatch& hydroVars)
+          {
+            kernel.CalculateDensityMomentumFeqBatch(hydroVars);
+          }
+
+          inline void DoCollideBatch(const LbmParameters* lbmParams,
+                                     typename KernelType::KHydroVarsBatch& hydroVars)
+          {
+            kernel.CollideBatch(lbmParams, hydroVars);
+          }
+
+          inline void DoCopyLaneTo(const typename KernelType::KHydroVarsBatch& batch,
+                                   unsigned lane,
+                                   kernels::HydroVars<KernelType>& hydroVars)
+          {
+            kernel.CopyLaneTo(batch, lane, hydroVars);
+          }
+
 
           KernelType kernel;
 
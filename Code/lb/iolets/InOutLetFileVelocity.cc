@@ -12,7 +12,6 @@
 #include "util/utilityStructs.h"
 #include "configuration/SimConfig.h"
 #include <cmath>
-#include <algorithm>
 
 namespace hemelb
 {
@@ -112,7 +111,11 @@ namespace hemelb
       LatticeVelocity InOutLetFileVelocity::GetVelocity(const LatticePosition& x,
                                                         const LatticeTimeStep t) const
       {
+        return GetProfile(x) * GetTimeFactor(t);
+      }
 
+      LatticeVelocity InOutLetFileVelocity::GetProfile(const LatticePosition& x) const
+      {
         if (!useWeightsFromFile)
         {
           // v(r) = vMax (1 - r**2 / a**2)
@@ -122,131 +125,114 @@ namespace hemelb
           Dimensionless rSqOverASq = (displ.GetMagnitudeSquared() - z * z) / (radius * radius);
           assert(rSqOverASq <= 1.0);
 
-          // Get the max velocity
-          LatticeSpeed max = velocityTable[t];
-
-          // Brackets to ensure that the scalar multiplies are done before vector * scalar.
-          return normal * (max * (1. - rSqOverASq));
+          return normal * (1. - rSqOverASq);
         }
         else
         {
-          /* These absolute normal values can still be negative here,
-           * but are corrected below to become positive.
-           * */
-          double abs_normal[3] = {normal.x, normal.y, normal.z};
-
-          /* Prevent division by 0 errors if the normals are 0.0. */
-          if(normal.x < 0.0000001) { abs_normal[0] = 0.0000001; }
-          if(normal.y < 0.0000001) { abs_normal[1] = 0.0000001; }
-          if(normal.z < 0.0000001) { abs_normal[2] = 0.0000001; }
-
-          /*bool logging = false;
-          if (402.9 < x.x && x.x < 403.1 && 312.9 < x.y && x.y < 313.1 && 160.4 < x.z && x.z < 160.6)
-           {
-           logging = true;
-           }
-
-          if (logging)
-          {
-            log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f", x.x, x.y, x.z);
-          }*/
+          return normal * GetWeight(x);
+        }
+      }
+
+      double InOutLetFileVelocity::GetWeight(const LatticePosition& x) const
+      {
+        /* These absolute normal values can still be negative here,
+         * but are corrected below to become positive.
+         * */
+        double abs_normal[3] = {normal.x, normal.y, normal.z};
+
+        /* Prevent division by 0 errors if the normals are 0.0. */
+        if(normal.x < 0.0000001) { abs_normal[0] = 0.0000001; }
+        if(normal.y < 0.0000001) { abs_normal[1] = 0.0000001; }
+        if(normal.z < 0.0000001) { abs_normal[2] = 0.0000001; }
+
+        /*bool logging = false;
+        if (402.9 < x.x && x.x < 403.1 && 312.9 < x.y && x.y < 313.1 && 160.4 < x.z && x.z < 160.6)
+         {
+         logging = true;
+         }
+
+        if (logging)
+        {
+          log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f", x.x, x.y, x.z);
+        }*/
 
-          int xyz_directions[3] = { 1, 1, 1 };
+        int xyz_directions[3] = { 1, 1, 1 };
 
-          std::vector<int> xyz;
-          xyz.push_back(0);
-          xyz.push_back(0);
-          xyz.push_back(0);
+        int xyz[3] = { 0, 0, 0 };
 
-          double xyz_residual[3] = {0.0, 0.0, 0.0};
-          /* The residual values increase by the normal values at every time step. When they hit >1.0, then
-           * xyz is incremented and a new grid point is attempted.
-           * In addition, the specific residual value is decreased by 1.0. */
+        double xyz_residual[3] = {0.0, 0.0, 0.0};
+        /* The residual values increase by the normal values at every time step. When they hit >1.0, then
+         * xyz is incremented and a new grid point is attempted.
+         * In addition, the specific residual value is decreased by 1.0. */
 
-          if (normal.x < 0.0)
-          {
-            xyz_directions[0] = -1;
-            xyz[0] = floor(x.x);
-            abs_normal[0] = -abs_normal[0];
-            /* Start with a negative residual because we already moved partially in this direction. */
-            xyz_residual[0] = -(x.x - floor(x.x));
-          } else {
-            xyz[0] = std::ceil(x.x);
-            xyz_residual[0] = -(std::ceil(x.x) - x.x);
-          }
+        if (normal.x < 0.0)
+        {
+          xyz_directions[0] = -1;
+          xyz[0] = floor(x.x);
+          abs_normal[0] = -abs_normal[0];
+          /* Start with a negative residual because we already moved partially in this direction. */
+          xyz_residual[0] = -(x.x - floor(x.x));
+        } else {
+          xyz[0] = std::ceil(x.x);
+          xyz_residual[0] = -(std::ceil(x.x) - x.x);
+        }
 
-          if (normal.y < 0.0)
+        if (normal.y < 0.0)
+        {
+          xyz_directions[1] = -1;
+          xyz[1] = floor(x.y);
+          abs_normal[1] = -abs_normal[1];
+          xyz_residual[1] = -(x.y - floor(x.y));
+        } else {
+          xyz[1] = std::ceil(x.y);
+          xyz_residual[1] = -(std::ceil(x.y) - x.y);
+        }
+
+        if (normal.z < 0.0)
+        {
+          xyz_directions[2] = -1;
+          xyz[2] = floor(x.z);
+          abs_normal[2] = -abs_normal[2];
+          xyz_residual[2] = -(x.z - floor(x.z));
+        } else {
+          xyz[2] = std::ceil(x.z);
+          xyz_residual[2] = -(std::ceil(x.z) - x.z);
+        }
+
+        int iterations = 0;
+
+        while (iterations < 3)
+        {
+          if (const double* weight = weights_table->Find(xyz[0], xyz[1], xyz[2]))
           {
-            xyz_directions[1] = -1;
-            xyz[1] = floor(x.y);
-            abs_normal[1] = -abs_normal[1];
-            xyz_residual[1] = -(x.y - floor(x.y));
-          } else {
-            xyz[1] = std::ceil(x.y);
-            xyz_residual[1] = -(std::ceil(x.y) - x.y);
+            return *weight;
           }
 
-          if (normal.z < 0.0)
+          /*if (logging)
           {
-            xyz_directions[2] = -1;
-            xyz[2] = floor(x.z);
-            abs_normal[2] = -abs_normal[2];
-            xyz_residual[2] = -(x.z - floor(x.z));
-          } else {
-            xyz[2] = std::ceil(x.z);
-            xyz_residual[2] = -(std::ceil(x.z) - x.z);
-          }
+            log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f %d %d %d",
+                                                            x.x,
+                                                            x.y,
+                                                            x.z,
+                                                            xyz[0],
+                                                            xyz[1],
+                                                            xyz[2]);
+          }*/
 
-	  auto v_tot = LatticeVelocity::Zero();
-          int iterations = 0;
+          /* Propagate residuals to the move to the next grid point. */
+          double xstep = (1.0 - xyz_residual[0]) / abs_normal[0];
+          double ystep = (1.0 - xyz_residual[1]) / abs_normal[1];
+          double zstep = (1.0 - xyz_residual[2]) / abs_normal[2];
 
-          while (iterations < 3)
-          {
-            if (weights_table.count(xyz) > 0)
-            {
-              v_tot = normal * weights_table.at(xyz) * velocityTable[t];
-              //log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f %f",
-              //                                                              x.x,
-              //                                                              x.y,
-              //                                                              x.z, v_tot);
-              return v_tot;
-            }
+          //log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f", xstep, ystep, zstep);
 
-            /*if (logging)
-            {
-              log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f %d %d %d",
-                                                              x.x,
-                                                              x.y,
-                                                              x.z,
-                                                              xyz[0],
-                                                              xyz[1],
-                                                              xyz[2]);
-            }*/
-
-            /* Propagate residuals to the move to the next grid point. */
-            double xstep = (1.0 - xyz_residual[0]) / abs_normal[0];
-            double ystep = (1.0 - xyz_residual[1]) / abs_normal[1];
-            double zstep = (1.0 - xyz_residual[2]) / abs_normal[2];
-
-            //log::Logger::Log<log::Warning, log::OnePerCore>("%f %f %f", xstep, ystep, zstep);
-
-            double all_step = 0.0;
-            int xyz_change = 0;
-
-            if(xstep < ystep) {
-              if (xstep < zstep) {
-                all_step = xstep;
-                xyz_change = 0;
-              } else {
-                if (ystep < zstep) {
-                  all_step = ystep;
-                  xyz_change = 1;
-                } else {
-                  all_step = zstep;
-                  xyz_change = 2;
-                }
-              }
+          double all_step = 0.0;
+          int xyz_change = 0;
 
+          if(xstep < ystep) {
+            if (xstep < zstep) {
+              all_step = xstep;
+              xyz_change = 0;
             } else {
               if (ystep < zstep) {
                 all_step = ystep;
@@ -257,28 +243,36 @@ namespace hemelb
               }
             }
 
-            xyz_residual[0] += abs_normal[0] * all_step;
-            xyz_residual[1] += abs_normal[1] * all_step;
-            xyz_residual[2] += abs_normal[2] * all_step;
+          } else {
+            if (ystep < zstep) {
+              all_step = ystep;
+              xyz_change = 1;
+            } else {
+              all_step = zstep;
+              xyz_change = 2;
+            }
+          }
 
-            xyz[xyz_change] += xyz_directions[xyz_change];
+          xyz_residual[0] += abs_normal[0] * all_step;
+          xyz_residual[1] += abs_normal[1] * all_step;
+          xyz_residual[2] += abs_normal[2] * all_step;
 
-            //if(xyz_residual[xyz_change] < 1.0) {
-            //  log::Logger::Log<log::Error, log::Singleton>("ERROR: Residual bug in vInlet: %f %f %f %f", x.x, x.y, x.z, xyz_residual[xyz_change]);
-            //}
+          xyz[xyz_change] += xyz_directions[xyz_change];
 
-            xyz_residual[xyz_change] -= 1.0;
+          //if(xyz_residual[xyz_change] < 1.0) {
+          //  log::Logger::Log<log::Error, log::Singleton>("ERROR: Residual bug in vInlet: %f %f %f %f", x.x, x.y, x.z, xyz_residual[xyz_change]);
+          //}
 
-            iterations++;
-          }
+          xyz_residual[xyz_change] -= 1.0;
 
-          /* Lists the sites which should be in the wall, outside of the main inlet.
-           * If you are unsure, you can increase the log level of this, run HemeLb
-           * for 1 time step, and plot these points out. */
-          log::Logger::Log<log::Trace, log::OnePerCore>("%f %f %f", x.x, x.y, x.z);
-          return normal * 0.0;
+          iterations++;
         }
 
+        /* Lists the sites which should be in the wall, outside of the main inlet.
+         * If you are unsure, you can increase the log level of this, run HemeLb
+         * for 1 time step, and plot these points out. */
+        log::Logger::Log<log::Trace, log::OnePerCore>("%f %f %f", x.x, x.y, x.z);
+        return 0.0;
       }
 
       void InOutLetFileVelocity::Initialise(const util::UnitConverter* unitConverter)
@@ -292,41 +286,21 @@ namespace hemelb
         #endif
 
         if(useWeightsFromFile) {
-          //if the new velocity approximation is enabled, then we want to create a lookup table here.
-          const std::string in_name = velocityFilePath + ".weights.txt";
-          util::check_file(in_name.c_str());
-
-          /* Load and read file. */
-          std::fstream myfile;
-          myfile.open(in_name.c_str(), std::ios_base::in);
-          log::Logger::Log<log::Warning, log::OnePerCore>("Loading weights file: %s",
-                                                        in_name.c_str());
-
-          std::string input_line;
-          /* input files are in ASCII, in format:
-           *
-           * coord_x coord_y coord_z weights_value
-           *
-           * */
-          while (myfile.good()) //(std::getline(myfile, input_line))
+          // Prefer the binary weights, which are mapped rather than parsed.
+          const std::string binaryName = velocityFilePath + ".weights.bin";
+          const std::string textName = velocityFilePath + ".weights.txt";
+          if (util::file_exists(binaryName.c_str()))
+          {
+            log::Logger::Log<log::Info, log::OnePerCore>("Mapping weights file: %s", binaryName.c_str());
+            weights_table.reset(VelocityWeightsTable::FromBinary(binaryName));
+          }
+          else
           {
-            int x, y, z;
-            double v;
-            myfile >> x >> y >> z >> v;
-
-            std::vector<int> xyz;
-            xyz.push_back(x);
-            xyz.push_back(y);
-            xyz.push_back(z);
-            weights_table[xyz] = v;
-
-            log::Logger::Log<log::Trace, log::OnePerCore>("%lld %lld %lld %f",
-            x,
-            y,
-            z,
-            weights_table[xyz]);
+            util::check_file(textName.c_str());
+            log::Logger::Log<log::Warning, log::OnePerCore>("Loading weights file: %s", textName.c_str());
+            weights_table.reset(VelocityWeightsTable::FromText(textName));
           }
-          myfile.close();
+          log::Logger::Log<log::Debug, log::OnePerCore>("%lu velocity weights", weights_table->GetSize());
         }
       }
 
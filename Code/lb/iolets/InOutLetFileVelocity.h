@@ -6,8 +6,9 @@
 #ifndef HEMELB_LB_IOLETS_INOUTLETFILEVELOCITY_H
 #define HEMELB_LB_IOLETS_INOUTLETFILEVELOCITY_H
 
-#include <map>
+#include <memory>
 #include "lb/iolets/InOutLetVelocity.h"
+#include "lb/iolets/VelocityWeightsTable.h"
 
 namespace hemelb
 {
@@ -37,6 +38,18 @@ namespace hemelb
           }
 
           LatticeVelocity GetVelocity(const LatticePosition& x, const LatticeTimeStep t) const;
+
+          // The profile is fixed (either parabolic or from the weights file) and scaled by the
+          // velocity read from the file.
+          bool IsSeparable() const
+          {
+            return true;
+          }
+          LatticeVelocity GetProfile(const LatticePosition& x) const;
+          LatticeSpeed GetTimeFactor(const LatticeTimeStep t) const
+          {
+            return velocityTable[t];
+          }
           /*LatticeVelocity GetVelocity2(const util::Vector3D<int64_t> globalCoordinates,
                                                                   const LatticeTimeStep t) const;*/
 
@@ -51,7 +64,14 @@ namespace hemelb
           std::vector<LatticeSpeed> velocityTable;
           const util::UnitConverter* units;
 
-          std::map<std::vector<int>, double> weights_table;
+          // Shared between copies of this iolet.
+          std::shared_ptr<const VelocityWeightsTable> weights_table;
+
+          /**
+           * Find the weight for a point on the iolet, looking from x along the normal to the
+           * nearest lattice point with a weight.
+           */
+          double GetWeight(const LatticePosition& x) const;
 
           //double calcVTot(std::vector<double> v);
 
@@ -5,6 +5,7 @@
 // license in the file LICENSE.
 #include "lb/iolets/InOutLetVelocity.h"
 #include "configuration/SimConfig.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -33,6 +34,16 @@ namespace hemelb
       {
         return 1.0;
       }
+
+      LatticeVelocity InOutLetVelocity::GetProfile(const LatticePosition& x) const
+      {
+        throw Exception() << "This velocity iolet doesn't have a fixed profile";
+      }
+
+      LatticeSpeed InOutLetVelocity::GetTimeFactor(const LatticeTimeStep t) const
+      {
+        throw Exception() << "This velocity iolet doesn't have a fixed profile";
+      }
     }
   }
 }
@@ -43,6 +43,20 @@ namespace hemelb
 
           virtual LatticeVelocity GetVelocity(const LatticePosition& x, const LatticeTimeStep t) const = 0;
 
+          /**
+           * Whether the velocity is a fixed profile scaled by a function of time, i.e.
+           * GetVelocity(x, t) == GetProfile(x) * GetTimeFactor(t). If so, streamers can work
+           * out the profile once for each link and only look up the time factor each step.
+           */
+          virtual bool IsSeparable() const
+          {
+            return false;
+          }
+          //! Only valid if IsSeparable().
+          virtual LatticeVelocity GetProfile(const LatticePosition& x) const;
+          //! Only valid if IsSeparable().
+          virtual LatticeSpeed GetTimeFactor(const LatticeTimeStep t) const;
+
           //virtual LatticeVelocity GetVelocity2(const util::Vector3D<site_t> globalCoordinates,
           //                                                          const LatticeTimeStep t) const = 0;
 
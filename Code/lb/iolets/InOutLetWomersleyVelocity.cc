@@ -4,6 +4,7 @@
 // file AUTHORS. This software is provided under the terms of the
 // license in the file LICENSE.
 #include "lb/iolets/InOutLetWomersleyVelocity.h"
+#include <algorithm>
 #include "configuration/SimConfig.h"
 #include "util/Bessel.h"
 
@@ -17,6 +18,12 @@ namespace hemelb
       const InOutLetWomersleyVelocity::Complex InOutLetWomersleyVelocity::iPowThreeHalves =
           pow(i, 1.5);
 
+      InOutLetWomersleyVelocity::InOutLetWomersleyVelocity() :
+          pressureGradientAmplitude(0.0), period(1.0), womersleyNumber(1.0)
+      {
+        UpdateProfileTable();
+      }
+
       InOutLet* InOutLetWomersleyVelocity::Clone() const
       {
         InOutLet* copy = new InOutLetWomersleyVelocity(*this);
@@ -28,18 +35,106 @@ namespace hemelb
       {
         LatticePosition displ = x - position;
         LatticeDistance z = displ.Dot(normal);
-        Dimensionless r = sqrt(displ.GetMagnitudeSquared() - z * z);
+        Dimensionless rSqOverRSq = (displ.GetMagnitudeSquared() - z * z) / (radius * radius);
+
+        // Linearly interpolate the shapes in the table.
+        const unsigned terms = termMultiples.size();
+        double tablePosition = std::min(std::max(rSqOverRSq, 0.0), 1.0) * (ProfileTableSize - 1);
+        unsigned j = std::min(unsigned(tablePosition), ProfileTableSize - 2);
+        double fraction = tablePosition - j;
+        const Complex* below = &profileTable[j * terms];
+        const Complex* above = below + terms;
+
+        // Step the time factor exp(i * multiple * omega * t) up through the multiples.
+        const Complex fundamentalFactor = std::polar(1.0, 2.0 * PI / period * double(t));
+        Complex timeFactor(1.0, 0.0);
+        unsigned factorMultiple = 0;
+
+        Complex velocity(0.0, 0.0);
+        for (unsigned term = 0; term < terms; ++term)
+        {
+          for (; factorMultiple < termMultiples[term]; ++factorMultiple)
+          {
+            timeFactor *= fundamentalFactor;
+          }
+          Complex shape = below[term] + fraction * (above[term] - below[term]);
+          velocity += termCoefficients[term] * shape * timeFactor;
+        }
+
+        return normal * -std::real(velocity);
+      }
+
+      void InOutLetWomersleyVelocity::UpdateProfileTable()
+      {
+        // The fundamental always comes first among the terms of its multiple.
+        termMultiples.assign(1, 1);
+        termHarmonics.assign(1, -1);
+        for (unsigned harmonic = 0; harmonic < harmonics.size(); ++harmonic)
+        {
+          unsigned term = 0;
+          while (term < termMultiples.size() && termMultiples[term] <= harmonics[harmonic].multiple)
+          {
+            ++term;
+          }
+          termMultiples.insert(termMultiples.begin() + term, harmonics[harmonic].multiple);
+          termHarmonics.insert(termHarmonics.begin() + term, harmonic);
+        }
 
+        const unsigned terms = termMultiples.size();
+        profileTable.resize(ProfileTableSize * terms);
+        for (unsigned term = 0; term < terms; ++term)
+        {
+          const unsigned multiple = termMultiples[term];
+          // The Womersley number of the harmonic scales with the square root of its frequency.
+          const Complex argument = iPowThreeHalves * womersleyNumber * std::sqrt(double(multiple));
+          const Complex besselDenom = util::BesselJ0ComplexArgument(argument);
+          for (unsigned j = 0; j < ProfileTableSize; ++j)
+          {
+            const double rSqOverRSq = double(j) / (ProfileTableSize - 1);
+            if (multiple == 0)
+            {
+              // Poiseuille flow
+              profileTable[j * terms + term] = 1.0 - rSqOverRSq;
+            }
+            else
+            {
+              Complex besselNumer = util::BesselJ0ComplexArgument(argument * std::sqrt(rSqOverRSq));
+              profileTable[j * terms + term] = 1.0 - besselNumer / besselDenom;
+            }
+          }
+        }
+
+        UpdateCoefficients();
+      }
+
+      void InOutLetWomersleyVelocity::UpdateCoefficients()
+      {
         double omega = 2.0 * PI / period;
         LatticeDensity density = 1.0;
 
-        Complex besselNumer = util::BesselJ0ComplexArgument(iPowThreeHalves * womersleyNumber * r
-            / radius);
-        Complex besselDenom = util::BesselJ0ComplexArgument(iPowThreeHalves * womersleyNumber);
-        LatticeSpeed velocityMagnitude = std::real(pressureGradientAmplitude / (density * omega)
-            * (1.0 - besselNumer / besselDenom) * exp(i * omega * double(t)));
+        termCoefficients.resize(termMultiples.size());
+        for (unsigned term = 0; term < termMultiples.size(); ++term)
+        {
+          if (termHarmonics[term] < 0)
+          {
+            termCoefficients[term] = pressureGradientAmplitude / (density * omega);
+            continue;
+          }
 
-        return normal * -velocityMagnitude;
+          const Harmonic& harmonic = harmonics[termHarmonics[term]];
+          if (harmonic.multiple == 0)
+          {
+            // The zero frequency limit of the other terms: the Poiseuille flow G R^2 / (4 rho nu),
+            // where the viscosity nu = R^2 omega / alpha^2 follows from the Womersley number.
+            termCoefficients[term] = -harmonic.amplitude * womersleyNumber * womersleyNumber
+                / (4.0 * density * omega);
+          }
+          else
+          {
+            termCoefficients[term] = std::polar(harmonic.amplitude / (density * omega * harmonic.multiple),
+                                                harmonic.phase);
+          }
+        }
       }
 
       const LatticePressureGradient& InOutLetWomersleyVelocity::GetPressureGradientAmplitude() const
@@ -50,6 +145,7 @@ namespace hemelb
       void InOutLetWomersleyVelocity::SetPressureGradientAmplitude(const LatticePressureGradient& pressGradAmp)
       {
         pressureGradientAmplitude = pressGradAmp;
+        UpdateCoefficients();
       }
 
       const LatticeTime& InOutLetWomersleyVelocity::GetPeriod() const
@@ -60,6 +156,7 @@ namespace hemelb
       void InOutLetWomersleyVelocity::SetPeriod(const LatticeTime& per)
       {
         period = per;
+        UpdateCoefficients();
       }
 
       const Dimensionless& InOutLetWomersleyVelocity::GetWomersleyNumber() const
@@ -70,6 +167,24 @@ namespace hemelb
       void InOutLetWomersleyVelocity::SetWomersleyNumber(const Dimensionless& womNumber)
       {
         womersleyNumber = womNumber;
+        UpdateProfileTable();
+      }
+
+      void InOutLetWomersleyVelocity::AddHarmonic(unsigned multiple,
+                                                  const LatticePressureGradient& amplitude,
+                                                  const Dimensionless& phase)
+      {
+        Harmonic harmonic;
+        harmonic.multiple = multiple;
+        harmonic.amplitude = amplitude;
+        harmonic.phase = phase;
+        harmonics.push_back(harmonic);
+        UpdateProfileTable();
+      }
+
+      const std::vector<InOutLetWomersleyVelocity::Harmonic>& InOutLetWomersleyVelocity::GetHarmonics() const
+      {
+        return harmonics;
       }
     }
   }
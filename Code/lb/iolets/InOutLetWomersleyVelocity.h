@@ -8,6 +8,7 @@
 #define HEMELB_LB_IOLETS_INOUTLETWOMERSLEYVELOCITY_H
 #include "lb/iolets/InOutLetVelocity.h"
 #include <complex>
+#include <vector>
 
 namespace hemelb
 {
@@ -28,10 +29,28 @@ namespace hemelb
        *
        * If combined with a pressure iolet at the other end of the cylinder, it must be set to
        * zero pressure
+       *
+       * Further harmonics of the pressure gradient, amplitude * sin(multiple*2*pi*t/period + phase),
+       * can be added to build up a realistic waveform as a Fourier series; a harmonic with multiple
+       * zero is a steady gradient and adds the corresponding Poiseuille flow.
+       *
+       * The radial shape of each harmonic is tabulated against (r/R)^2 when the parameters are set,
+       * so GetVelocity only interpolates in the table rather than evaluating Bessel functions.
        */
       class InOutLetWomersleyVelocity : public InOutLetVelocity
       {
         public:
+          struct Harmonic
+          {
+              unsigned multiple;
+              LatticePressureGradient amplitude;
+              Dimensionless phase;
+          };
+
+          //! The number of points in the table of each harmonic's radial shape.
+          static const unsigned ProfileTableSize = 4096;
+
+          InOutLetWomersleyVelocity();
 
           /**
            * Returns a copy of the current iolet. The caller is responsible for freeing that memory.
@@ -91,13 +110,43 @@ namespace hemelb
            */
           void SetWomersleyNumber(const Dimensionless& womNumber);
 
+          /**
+           * Add a harmonic to the pressure gradient, on top of the fundamental given by the
+           * pressure gradient amplitude.
+           *
+           * @param multiple of the fundamental frequency, or zero for a steady gradient
+           * @param amplitude of the pressure gradient
+           * @param phase in radians (ignored for a steady gradient)
+           */
+          void AddHarmonic(unsigned multiple, const LatticePressureGradient& amplitude,
+                           const Dimensionless& phase);
+
+          //! The harmonics added with AddHarmonic.
+          const std::vector<Harmonic>& GetHarmonics() const;
+
         private:
           typedef std::complex<double> Complex;
           static const Complex i;
           static const Complex iPowThreeHalves;
+
+          //! Tabulate the radial shape of each harmonic. Needed when the Womersley number or harmonics change.
+          void UpdateProfileTable();
+          //! Work out the complex amplitude of each harmonic's velocity.
+          void UpdateCoefficients();
+
           LatticePressureGradient pressureGradientAmplitude; ///< See class documentation
           LatticeTime period; ///< See class documentation
           double womersleyNumber; ///< See class documentation
+          std::vector<Harmonic> harmonics; ///< See class documentation
+
+          //! The multiple of each term, in ascending order, including the fundamental.
+          std::vector<unsigned> termMultiples;
+          //! The index in harmonics of each term, or -1 for the fundamental.
+          std::vector<int> termHarmonics;
+          //! The velocity of each term at unit shape and time factor.
+          std::vector<Complex> termCoefficients;
+          //! The shape of each term at (r/R)^2 = j / (ProfileTableSize - 1), indexed [j * terms + term].
+          std::vector<Complex> profileTable;
       };
     }
   }
@@ -0,0 +1,173 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "lb/iolets/VelocityWeightsTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Exception.h"
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace iolets
+    {
+      namespace
+      {
+        const char Magic[8] = { 'H', 'L', 'B', 'V', 'W', 'T', '1', '\0' };
+        const std::size_t HeaderLength = sizeof(Magic) + sizeof(std::uint64_t);
+
+        bool IsBefore(const VelocityWeightsTable::Entry& entry, std::int32_t x, std::int32_t y, std::int32_t z)
+        {
+          if (entry.x != x)
+          {
+            return entry.x < x;
+          }
+          if (entry.y != y)
+          {
+            return entry.y < y;
+          }
+          return entry.z < z;
+        }
+
+        bool IsOrdered(const VelocityWeightsTable::Entry& left, const VelocityWeightsTable::Entry& right)
+        {
+          return IsBefore(left, right.x, right.y, right.z);
+        }
+      }
+
+      VelocityWeightsTable::VelocityWeightsTable() :
+          begin(NULL), end(NULL), mapping(NULL), mappingLength(0)
+      {
+      }
+
+      VelocityWeightsTable::~VelocityWeightsTable()
+      {
+        if (mapping != NULL)
+        {
+          munmap(mapping, mappingLength);
+        }
+      }
+
+      VelocityWeightsTable* VelocityWeightsTable::FromText(const std::string& path)
+      {
+        std::ifstream file(path.c_str());
+        if (!file)
+        {
+          throw Exception() << "Unable to open velocity weights file " << path;
+        }
+
+        VelocityWeightsTable* table = new VelocityWeightsTable();
+        Entry entry;
+        entry.unused = 0;
+        while (file >> entry.x >> entry.y >> entry.z >> entry.weight)
+        {
+          table->entries.push_back(entry);
+        }
+
+        // Later lines win, as they did when these were read into a map.
+        std::stable_sort(table->entries.begin(), table->entries.end(), IsOrdered);
+        std::vector<Entry> unique;
+        for (const Entry& read : table->entries)
+        {
+          if (!unique.empty() && !IsOrdered(unique.back(), read))
+          {
+            unique.back() = read;
+          }
+          else
+          {
+            unique.push_back(read);
+          }
+        }
+        table->entries.swap(unique);
+
+        table->begin = table->entries.data();
+        table->end = table->begin + table->entries.size();
+        return table;
+      }
+
+      VelocityWeightsTable* VelocityWeightsTable::FromBinary(const std::string& path)
+      {
+        const int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0)
+        {
+          throw Exception() << "Unable to open velocity weights file " << path;
+        }
+        struct stat status;
+        if (fstat(descriptor, &status) != 0 || std::size_t(status.st_size) < HeaderLength)
+        {
+          close(descriptor);
+          throw Exception() << "Velocity weights file " << path << " is too short";
+        }
+
+        const std::size_t length = status.st_size;
+        void* mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        close(descriptor);
+        if (mapping == MAP_FAILED)
+        {
+          throw Exception() << "Unable to map velocity weights file " << path;
+        }
+
+        VelocityWeightsTable* table = new VelocityWeightsTable();
+        table->mapping = mapping;
+        table->mappingLength = length;
+
+        const char* bytes = static_cast<const char*>(mapping);
+        std::uint64_t count;
+        std::memcpy(&count, bytes + sizeof(Magic), sizeof(count));
+        if (std::memcmp(bytes, Magic, sizeof(Magic)) != 0 || length != HeaderLength + count * sizeof(Entry))
+        {
+          delete table;
+          throw Exception() << "Velocity weights file " << path << " is not in the expected format";
+        }
+
+        table->begin = reinterpret_cast<const Entry*>(bytes + HeaderLength);
+        table->end = table->begin + count;
+        // Find searches by bisection, so out-of-order entries would be silently missed.
+        if (!std::is_sorted(table->begin, table->end, IsOrdered))
+        {
+          delete table;
+          throw Exception() << "Velocity weights file " << path << " is not sorted by (x, y, z)";
+        }
+        return table;
+      }
+
+      void VelocityWeightsTable::WriteBinary(const std::string& path, std::vector<Entry> entries)
+      {
+        std::stable_sort(entries.begin(), entries.end(), IsOrdered);
+
+        std::ofstream file(path.c_str(), std::ios::binary);
+        const std::uint64_t count = entries.size();
+        file.write(Magic, sizeof(Magic));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+        if (!file)
+        {
+          throw Exception() << "Unable to write velocity weights file " << path;
+        }
+      }
+
+      const double* VelocityWeightsTable::Find(std::int32_t x, std::int32_t y, std::int32_t z) const
+      {
+        const Entry* found = std::lower_bound(begin, end, 0, [&](const Entry& entry, int)
+        {
+          return IsBefore(entry, x, y, z);
+        });
+        if (found == end || found->x != x || found->y != y || found->z != z)
+        {
+          return NULL;
+        }
+        return &found->weight;
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_LB_IOLETS_VELOCITYWEIGHTSTABLE_H
+#define HEMELB_LB_IOLETS_VELOCITYWEIGHTSTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hemelb
+{
+  namespace lb
+  {
+    namespace iolets
+    {
+      /**
+       * The weights of a velocity profile at the lattice points of an inlet, as made by the
+       * setup tool, for InOutLetFileVelocity.
+       *
+       * The weights come from either the ASCII file of "x y z weight" lines or, much faster,
+       * from a binary file which is memory-mapped and searched in place. The binary file is:
+       *
+       *   char[8]  magic, "HLBVWT1\0"
+       *   uint64   the number of entries
+       *   Entry[]  the entries, sorted by (x, y, z)
+       *
+       * all in native byte order, so the entries start 8-byte aligned.
+       */
+      class VelocityWeightsTable
+      {
+        public:
+          struct Entry
+          {
+              std::int32_t x, y, z;
+              std::int32_t unused;
+              double weight;
+          };
+
+          //! Load an ASCII weights file.
+          static VelocityWeightsTable* FromText(const std::string& path);
+          //! Map a binary weights file.
+          static VelocityWeightsTable* FromBinary(const std::string& path);
+
+          //! Write the entries, in any order, as a binary weights file.
+          static void WriteBinary(const std::string& path, std::vector<Entry> entries);
+
+          ~VelocityWeightsTable();
+
+          /**
+           * Get the weight at a lattice point.
+           * @return NULL if there is none
+           */
+          const double* Find(std::int32_t x, std::int32_t y, std::int32_t z) const;
+
+          std::size_t GetSize() const
+          {
+            return end - begin;
+          }
+
+        private:
+          VelocityWeightsTable();
+          VelocityWeightsTable(const VelocityWeightsTable&) = delete;
+          VelocityWeightsTable& operator=(const VelocityWeightsTable&) = delete;
+
+          const Entry* begin;
+          const Entry* end;
+          //! The entries read from a text file.
+          std::vector<Entry> entries;
+          //! The mapping of a binary file.
+          void* mapping;
+          std::size_t mappingLength;
+      };
+    }
+  }
+}
+
+#endif /* HEMELB_LB_IOLETS_VELOCITYWEIGHTSTABLE_H */
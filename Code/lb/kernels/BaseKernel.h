@@ -12,6 +12,7 @@
 #include "lb/iolets/BoundaryValues.h"
 #include "lb/kernels/rheologyModels/RheologyModels.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
+#include "geometry/DistributionLayout.h"
 
 namespace hemelb
 {
@@ -107,7 +108,7 @@ namespace hemelb
             fPostCollision[direction] = value;
           }
 
-          inline const FVector<LatticeType>& GetFPostCollision()
+          inline const FVector<LatticeType>& GetFPostCollision() const
           {
             return fPostCollision;
           }
@@ -127,6 +128,48 @@ namespace hemelb
           }
       };
 
+      /**
+       * HydroVarsBatch: the hydrodynamic variables of HEMELB_SIMD_WIDTH sites, for kernels
+       * that can collide several sites per call (those with SupportsBatch set). The
+       * distribution arrays are indexed [direction][lane], so the same direction of every site
+       * in the batch can be loaded into one SIMD register.
+       */
+      template<class LatticeType>
+      struct HydroVarsBatch
+      {
+        public:
+          static const unsigned WIDTH = HEMELB_SIMD_WIDTH;
+
+          distribn_t density[WIDTH];
+          distribn_t momentumX[WIDTH], momentumY[WIDTH], momentumZ[WIDTH];
+          distribn_t velocityX[WIDTH], velocityY[WIDTH], velocityZ[WIDTH];
+
+          distribn_t f[LatticeType::NUMVECTORS][WIDTH];
+          distribn_t f_eq[LatticeType::NUMVECTORS][WIDTH];
+          distribn_t f_neq[LatticeType::NUMVECTORS][WIDTH];
+          distribn_t fPostCollision[LatticeType::NUMVECTORS][WIDTH];
+
+          /**
+           * Copy the results for one lane into a single-site HydroVars, so that the streamer
+           * delegates and the stability / property code can be used unchanged.
+           * @param lane
+           * @param hydroVars
+           */
+          inline void CopyLaneTo(unsigned lane, HydroVarsBase<LatticeType>& hydroVars) const
+          {
+            hydroVars.density = density[lane];
+            hydroVars.momentum = util::Vector3D<distribn_t>(momentumX[lane], momentumY[lane], momentumZ[lane]);
+            hydroVars.velocity = util::Vector3D<distribn_t>(velocityX[lane], velocityY[lane], velocityZ[lane]);
+
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              hydroVars.SetFEq(direction, f_eq[direction][lane]);
+              hydroVars.SetFNeq(direction, f_neq[direction][lane]);
+              hydroVars.SetFPostCollision(direction, fPostCollision[direction][lane]);
+            }
+          }
+      };
+
       /**
        * InitParams: struct for passing variables into streaming, collision and kernel operators
        * to initialise them.
@@ -183,6 +226,12 @@ namespace hemelb
        *      the density, momentum and equilibrium distribution
        *  - Collide(const LbmParameters*, KHydroVars& hydroVars, unsigned int directionIndex)
        *  - Reset(InitParams*)
+       *  - SupportsBatch, true if the batched methods below may be used
+       *  - CalculateDensityMomentumFeqBatch(KHydroVarsBatch&) and
+       *      CollideBatch(const LbmParameters*, KHydroVarsBatch&), which do the same as the
+       *      single-site versions for HydroVarsBatch::WIDTH sites at a time.
+       *  - CopyLaneTo(const KHydroVarsBatch&, unsigned, KHydroVars&), which fills in a
+       *      single-site KHydroVars from one lane of a collided batch.
        *
        * The following must be implemented must be kernels (which derive from this class
        * using the CRTP).
@@ -190,14 +239,24 @@ namespace hemelb
        *  - DoCalculateDensityMomentumFeq(KHydroVars&, site_t)
        *  - DoCollide(const LbmParameters*, KHydroVars&, unsigned int) returns distibn_t
        *  - DoReset(InitParams*)
+       *
+       * Kernels that set SupportsBatch must also implement
+       *  - DoCalculateDensityMomentumFeqBatch(KHydroVarsBatch&)
+       *  - DoCollideBatch(const LbmParameters*, KHydroVarsBatch&)
+       * and, if their KHydroVars carries more than HydroVarsBase, DoCopyLaneTo to fill it in.
        */
       template<typename KernelImpl, typename LatticeImpl>
       class BaseKernel
       {
         public:
           typedef HydroVars<KernelImpl> KHydroVars;
+          typedef HydroVarsBatch<LatticeImpl> KHydroVarsBatch;
           typedef LatticeImpl LatticeType;
 
+          // Kernels whose collision only depends on the local distributions and the
+          // global LB parameters can override this to enable the batched path.
+          static const bool SupportsBatch = false;
+
           inline void CalculateDensityMomentumFeq(KHydroVars& hydroVars, site_t index)
           {
             static_cast<KernelImpl*> (this)->DoCalculateDensityMomentumFeq(hydroVars, index);
@@ -213,6 +272,26 @@ namespace hemelb
             static_cast<KernelImpl*> (this)->DoCollide(lbmParams, hydroVars);
           }
 
+          inline void CalculateDensityMomentumFeqBatch(KHydroVarsBatch& hydroVars)
+          {
+            static_cast<KernelImpl*> (this)->DoCalculateDensityMomentumFeqBatch(hydroVars);
+          }
+
+          inline void CollideBatch(const LbmParameters* lbmParams, KHydroVarsBatch& hydroVars)
+          {
+            static_cast<KernelImpl*> (this)->DoCollideBatch(lbmParams, hydroVars);
+          }
+
+          inline void CopyLaneTo(const KHydroVarsBatch& batch, unsigned lane, KHydroVars& hydroVars)
+          {
+            static_cast<KernelImpl*> (this)->DoCopyLaneTo(batch, lane, hydroVars);
+          }
+
+          inline void DoCopyLaneTo(const KHydroVarsBatch& batch, unsigned lane, KHydroVars& hydroVars)
+          {
+            batch.CopyLaneTo(lane, hydroVars);
+          }
+
       };
 
     }
@@ -25,6 +25,8 @@ namespace hemelb
       class LBGK : public BaseKernel<LBGK<LatticeType>, LatticeType>
       {
         public:
+          static const bool SupportsBatch = true;
+
           LBGK(InitParams& initParams)
           {
           }
@@ -71,6 +73,41 @@ namespace hemelb
             }
           }
 
+          inline void DoCalculateDensityMomentumFeqBatch(HydroVarsBatch<LatticeType>& hydroVars)
+          {
+            const unsigned WIDTH = HydroVarsBatch<LatticeType>::WIDTH;
+            LatticeType::template CalculateDensityMomentumFEqBatch<WIDTH>(hydroVars.f,
+                                                                          hydroVars.density,
+                                                                          hydroVars.momentumX,
+                                                                          hydroVars.momentumY,
+                                                                          hydroVars.momentumZ,
+                                                                          hydroVars.velocityX,
+                                                                          hydroVars.velocityY,
+                                                                          hydroVars.velocityZ,
+                                                                          hydroVars.f_eq);
+
+            for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                hydroVars.f_neq[ii][lane] = hydroVars.f[ii][lane] - hydroVars.f_eq[ii][lane];
+              }
+            }
+          }
+
+          inline void DoCollideBatch(const LbmParameters* const lbmParams, HydroVarsBatch<LatticeType>& hydroVars)
+          {
+            const distribn_t omega = lbmParams->GetOmega();
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              for (unsigned lane = 0; lane < HydroVarsBatch<LatticeType>::WIDTH; ++lane)
+              {
+                hydroVars.fPostCollision[direction][lane] = hydroVars.f[direction][lane]
+                    + hydroVars.f_neq[direction][lane] * omega;
+              }
+            }
+          }
+
       };
 
     }
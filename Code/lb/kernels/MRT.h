@@ -51,6 +51,8 @@ namespace hemelb
       class MRT : public BaseKernel<MRT<MomentBasis>, typename MomentBasis::Lattice>
       {
         public:
+          typedef typename MomentBasis::Lattice LatticeType;
+          static const bool SupportsBatch = true;
 
           MRT(InitParams& initParams)
           {
@@ -123,6 +125,86 @@ namespace hemelb
             }
           }
 
+          inline void DoCalculateDensityMomentumFeqBatch(HydroVarsBatch<LatticeType>& hydroVars)
+          {
+            const unsigned WIDTH = HydroVarsBatch<LatticeType>::WIDTH;
+            LatticeType::template CalculateDensityMomentumFEqBatch<WIDTH>(hydroVars.f,
+                                                                          hydroVars.density,
+                                                                          hydroVars.momentumX,
+                                                                          hydroVars.momentumY,
+                                                                          hydroVars.momentumZ,
+                                                                          hydroVars.velocityX,
+                                                                          hydroVars.velocityY,
+                                                                          hydroVars.velocityZ,
+                                                                          hydroVars.f_eq);
+
+            for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                hydroVars.f_neq[ii][lane] = hydroVars.f[ii][lane] - hydroVars.f_eq[ii][lane];
+              }
+            }
+          }
+
+          /**
+           * The moment space projection is done here rather than in
+           * DoCalculateDensityMomentumFeqBatch, so the batch doesn't have to carry m_neq.
+           */
+          inline void DoCollideBatch(const LbmParameters* const lbmParams, HydroVarsBatch<LatticeType>& hydroVars)
+          {
+            const unsigned WIDTH = HydroVarsBatch<LatticeType>::WIDTH;
+
+            distribn_t scaledMNeq[MomentBasis::NUM_KINETIC_MOMENTS][WIDTH];
+            for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
+            {
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                scaledMNeq[momentIndex][lane] = 0.;
+              }
+              for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+              {
+                const distribn_t basis = MomentBasis::REDUCED_MOMENT_BASIS[momentIndex][direction];
+                for (unsigned lane = 0; lane < WIDTH; ++lane)
+                {
+                  scaledMNeq[momentIndex][lane] += basis * hydroVars.f_neq[direction][lane];
+                }
+              }
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                scaledMNeq[momentIndex][lane] *= collisionMatrix[momentIndex];
+              }
+            }
+
+            for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+            {
+              distribn_t collision[WIDTH] = { };
+              for (unsigned momentIndex = 0; momentIndex < MomentBasis::NUM_KINETIC_MOMENTS; momentIndex++)
+              {
+                const distribn_t basis = normalisedReducedMomentBasis[momentIndex][direction];
+                for (unsigned lane = 0; lane < WIDTH; ++lane)
+                {
+                  collision[lane] += basis * scaledMNeq[momentIndex][lane];
+                }
+              }
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                hydroVars.fPostCollision[direction][lane] = hydroVars.f[direction][lane] - collision[lane];
+              }
+            }
+          }
+
+          /**
+           * The batch doesn't carry m_neq, so project this lane's f_neq again to fill it in.
+           */
+          inline void DoCopyLaneTo(const HydroVarsBatch<LatticeType>& batch,
+                                   unsigned lane,
+                                   HydroVars<MRT>& hydroVars)
+          {
+            batch.CopyLaneTo(lane, hydroVars);
+            MomentBasis::ProjectVelsIntoMomentSpace(hydroVars.f_neq.f, hydroVars.m_neq);
+          }
+
           inline void DoReset(InitParams* initParams)
           {
             InitState(*initParams);
@@ -32,6 +32,8 @@ namespace hemelb
           Direction iZero;
 
         public:
+          static const bool SupportsBatch = true;
+
           TRT(InitParams& initParams)
           {
             for (Direction i = 0; i < LatticeType::NUMVECTORS; ++i)
@@ -110,6 +112,64 @@ namespace hemelb
             }
           }
 
+          inline void DoCalculateDensityMomentumFeqBatch(HydroVarsBatch<LatticeType>& hydroVars)
+          {
+            const unsigned WIDTH = HydroVarsBatch<LatticeType>::WIDTH;
+            LatticeType::template CalculateDensityMomentumFEqBatch<WIDTH>(hydroVars.f,
+                                                                          hydroVars.density,
+                                                                          hydroVars.momentumX,
+                                                                          hydroVars.momentumY,
+                                                                          hydroVars.momentumZ,
+                                                                          hydroVars.velocityX,
+                                                                          hydroVars.velocityY,
+                                                                          hydroVars.velocityZ,
+                                                                          hydroVars.f_eq);
+
+            for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+            {
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                hydroVars.f_neq[ii][lane] = hydroVars.f[ii][lane] - hydroVars.f_eq[ii][lane];
+              }
+            }
+          }
+
+          inline void DoCollideBatch(const LbmParameters* const lbmParams, HydroVarsBatch<LatticeType>& hydroVars)
+          {
+            const unsigned WIDTH = HydroVarsBatch<LatticeType>::WIDTH;
+
+            // See DoCollide for the choice of the second relaxation time.
+            const distribn_t Lambda = 3.0 / 16.0;
+
+            const distribn_t tau_plus = lbmParams->GetTau();
+            const distribn_t omega_plus = lbmParams->GetOmega();
+            const distribn_t tau_minus = 0.5 + Lambda / (tau_plus - 0.5);
+            const distribn_t omega_minus = -1.0 / tau_minus;
+
+            for (unsigned lane = 0; lane < WIDTH; ++lane)
+            {
+              hydroVars.fPostCollision[iZero][lane] = hydroVars.f[iZero][lane]
+                  + omega_plus * hydroVars.f_neq[iZero][lane];
+            }
+
+            for (OppList::const_iterator oppIt = directionPairs.begin();
+                oppIt != directionPairs.end();
+                ++oppIt)
+            {
+              const Direction i = oppIt->first;
+              const Direction iBar = oppIt->second;
+
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                const distribn_t sym = 0.5 * omega_plus * (hydroVars.f_neq[i][lane] + hydroVars.f_neq[iBar][lane]);
+                const distribn_t asym = 0.5 * omega_minus
+                    * (hydroVars.f_neq[i][lane] - hydroVars.f_neq[iBar][lane]);
+                hydroVars.fPostCollision[i][lane] = hydroVars.f[i][lane] + sym + asym;
+                hydroVars.fPostCollision[iBar][lane] = hydroVars.f[iBar][lane] + sym - asym;
+              }
+            }
+          }
+
       };
 
     }
@@ -58,6 +58,61 @@ namespace hemelb
             CalculateFeq(density, momentum_x, momentum_y, momentum_z, f_eq);
           }
 
+          /**
+           * Batched version of CalculateDensityMomentumFEq; see Lattice for the array layout.
+           */
+          template<unsigned tWidth>
+          inline static void CalculateDensityMomentumFEqBatch(const distribn_t f[][tWidth],
+                                                              distribn_t density[],
+                                                              distribn_t momentum_x[],
+                                                              distribn_t momentum_y[],
+                                                              distribn_t momentum_z[],
+                                                              distribn_t velocity_x[],
+                                                              distribn_t velocity_y[],
+                                                              distribn_t velocity_z[],
+                                                              distribn_t f_eq[][tWidth])
+          {
+            for (unsigned lane = 0; lane < tWidth; ++lane)
+            {
+              density[lane] = momentum_x[lane] = momentum_y[lane] = momentum_z[lane] = 0.0;
+            }
+
+            for (Direction direction = 0; direction < DmQn::NUMVECTORS; ++direction)
+            {
+              for (unsigned lane = 0; lane < tWidth; ++lane)
+              {
+                density[lane] += f[direction][lane];
+                momentum_x[lane] += DmQn::CXD[direction] * f[direction][lane];
+                momentum_y[lane] += DmQn::CYD[direction] * f[direction][lane];
+                momentum_z[lane] += DmQn::CZD[direction] * f[direction][lane];
+              }
+            }
+
+            distribn_t isotropic[tWidth];
+            for (unsigned lane = 0; lane < tWidth; ++lane)
+            {
+              velocity_x[lane] = momentum_x[lane];
+              velocity_y[lane] = momentum_y[lane];
+              velocity_z[lane] = momentum_z[lane];
+              isotropic[lane] = density[lane]
+                  - (3. / 2.)
+                      * (momentum_x[lane] * momentum_x[lane] + momentum_y[lane] * momentum_y[lane]
+                          + momentum_z[lane] * momentum_z[lane]);
+            }
+
+            for (Direction direction = 0; direction < DmQn::NUMVECTORS; ++direction)
+            {
+              for (unsigned lane = 0; lane < tWidth; ++lane)
+              {
+                const distribn_t mom_dot_ei = DmQn::CXD[direction] * momentum_x[lane]
+                    + DmQn::CYD[direction] * momentum_y[lane] + DmQn::CZD[direction] * momentum_z[lane];
+
+                f_eq[direction][lane] = DmQn::EQMWEIGHTS[direction]
+                    * (isotropic[lane] + (9. / 2.) * mom_dot_ei * mom_dot_ei + 3. * mom_dot_ei);
+              }
+            }
+          }
+
           inline static bool IsLatticeCompressible()
           {
             return false;
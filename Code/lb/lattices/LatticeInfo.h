@@ -22,13 +22,15 @@ namespace hemelb
         public:
           inline LatticeInfo(unsigned numberOfVectors,
                              const util::Vector3D<int>* vectors,
-                             const Direction* inverseVectorIndicesIn) :
-              numVectors(numberOfVectors), vectorSet(), inverseVectorIndices()
+                             const Direction* inverseVectorIndicesIn,
+                             const distribn_t* weightsIn) :
+              numVectors(numberOfVectors), vectorSet(), inverseVectorIndices(), weights()
           {
             for (Direction direction = 0; direction < numberOfVectors; ++direction)
             {
               vectorSet.push_back(util::Vector3D<int>(vectors[direction]));
               inverseVectorIndices.push_back(inverseVectorIndicesIn[direction]);
+              weights.push_back(weightsIn[direction]);
             }
           }
 
@@ -47,10 +49,22 @@ namespace hemelb
             return inverseVectorIndices[index];
           }
 
+          /**
+           * The weight of the given direction in the equilibrium distribution, i.e. the
+           * equilibrium distribution at unit density and zero velocity.
+           * @param index
+           * @return
+           */
+          inline distribn_t GetWeight(unsigned index) const
+          {
+            return weights[index];
+          }
+
         private:
           const unsigned numVectors;
           std::vector<util::Vector3D<int> > vectorSet;
           std::vector<Direction> inverseVectorIndices;
+          std::vector<distribn_t> weights;
       };
     }
   }
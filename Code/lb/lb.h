@@ -17,6 +17,10 @@
 #include "configuration/SimConfig.h"
 #include "reporting/Timers.h"
 #include "lb/BuildSystemInterface.h"
+#include "lb/CollisionSchedule.h"
+#include <algorithm>
+#include <memory>
+#include <type_traits>
 #include <typeinfo>
 
 namespace hemelb
@@ -47,6 +51,16 @@ namespace hemelb
         // And again but for sites that are both in-/outlet and wall
         typedef typename HEMELB_WALL_INLET_BOUNDARY<collisions::Normal<LB_KERNEL> >::Type tInletWallCollision;
         typedef typename HEMELB_WALL_OUTLET_BOUNDARY<collisions::Normal<LB_KERNEL> >::Type tOutletWallCollision;
+        // Catch an unsupported combination at build time rather than when the streamers are made.
+        static_assert(!geometry::StreamingPattern::InPlace
+                          || (HEMELB_WALL_BOUNDARY<collisions::Normal<LB_KERNEL> >::SupportsInPlaceStreaming
+                              && HEMELB_WALL_INLET_BOUNDARY<collisions::Normal<LB_KERNEL> >::SupportsInPlaceStreaming
+                              && HEMELB_WALL_OUTLET_BOUNDARY<collisions::Normal<LB_KERNEL> >::SupportsInPlaceStreaming),
+                      "The wall boundary conditions chosen are not available with in-place streaming");
+
+        // The streamers in the order of the collision types.
+        typedef CollisionSchedule<tMidFluidCollision, tWallCollision, tInletCollision, tOutletCollision,
+            tInletWallCollision, tOutletWallCollision> tCollisions;
 
       public:
         /**
@@ -61,7 +75,6 @@ namespace hemelb
             SimulationState* simState,
             reporting::Timers &atimings,
             geometry::neighbouring::NeighbouringDataManager *neighbouringDataManager);
-        ~LBM();
 
         void RequestComms(); ///< part of IteratedAction interface.
         void PreSend(); ///< part of IteratedAction interface.
@@ -103,12 +116,29 @@ namespace hemelb
         hemelb::lb::LbmParameters *GetLbmParams();
         lb::MacroscopicPropertyCache& GetPropertyCache();
 
+        /**
+         * Log the time spent on each range of sites, if it was timed (when debug output is on).
+         */
+        void LogCollisionRangeTimes() const;
+
+        /**
+         * Time the ranges from now on, whether or not debug output is on.
+         */
+        void TimeCollisions();
+
+        /**
+         * Get the total time spent on each collision type, over all phases, and the number of
+         * local sites of each type.
+         */
+        void GetCollisionTimes(std::vector<double>& seconds, std::vector<site_t>& sites) const;
+
       private:
 
         void InitCollisions();
         // The following function pair simplify initialising the site ranges for each collider object.
         void InitInitParamsSiteRanges(kernels::InitParams& initParams, unsigned& state);
         void AdvanceInitParamsSiteRanges(kernels::InitParams& initParams, unsigned& state);
+        void InitCollisionRanges();
         /**
          * Ensure that the BoundaryValues objects have all necessary fields populated.
          */
@@ -118,40 +148,89 @@ namespace hemelb
 
         void handleIOError(int iError);
 
-        // Collision objects
-        tMidFluidCollision* mMidFluidCollision;
-        tWallCollision* mWallCollision;
-        tInletCollision* mInletCollision;
-        tOutletCollision* mOutletCollision;
-        tInletWallCollision* mInletWallCollision;
-        tOutletWallCollision* mOutletWallCollision;
+        std::unique_ptr<tCollisions> mCollisions;
+        // The work of each phase of a step.
+        CollisionRanges preSendRanges;
+        CollisionRanges preReceiveRanges;
+        CollisionRanges postReceiveRanges;
 
-        template<typename Collision>
-        void StreamAndCollide(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
+        /**
+         * Stream and collide the ranges in turn, calling beforeRange(range) before each.
+         */
+        template<typename BeforeRange>
+        void StreamAndCollide(CollisionRanges& ranges, BeforeRange beforeRange)
         {
           if (mVisControl->IsRendering())
           {
-            collision->template StreamAndCollide<true> (iFirstIndex, iSiteCount, &mParams, mLatDat, propertyCache);
+            StreamAndCollide<true> (ranges, beforeRange);
           }
           else
           {
-            collision->template StreamAndCollide<false> (iFirstIndex, iSiteCount, &mParams, mLatDat, propertyCache);
+            StreamAndCollide<false> (ranges, beforeRange);
           }
         }
 
-        template<typename Collision>
-        void PostStep(Collision* collision, const site_t iFirstIndex, const site_t iSiteCount)
+        template<bool tDoRayTracing, typename BeforeRange>
+        void StreamAndCollide(CollisionRanges& ranges, BeforeRange beforeRange)
+        {
+          mCollisions->Run(ranges, [&](auto& collision, const CollisionRange& range)
+          {
+            beforeRange(range);
+            typedef typename std::decay<decltype(collision)>::type Collision;
+            ForEachThreadSiteRange<Collision>(range.first, range.count, [&](site_t firstIndex, site_t siteCount)
+            {
+              collision.template StreamAndCollide<tDoRayTracing> (firstIndex, siteCount, &mParams, mLatDat, propertyCache);
+            });
+          });
+        }
+
+        void PostStep(CollisionRanges& ranges)
         {
           if (mVisControl->IsRendering())
           {
-            collision->template DoPostStep<true> (iFirstIndex, iSiteCount, &mParams, mLatDat, propertyCache);
+            PostStep<true> (ranges);
           }
           else
           {
-            collision->template DoPostStep<false> (iFirstIndex, iSiteCount, &mParams, mLatDat, propertyCache);
+            PostStep<false> (ranges);
           }
         }
 
+        template<bool tDoRayTracing>
+        void PostStep(CollisionRanges& ranges)
+        {
+          mCollisions->Run(ranges, [&](auto& collision, const CollisionRange& range)
+          {
+            typedef typename std::decay<decltype(collision)>::type Collision;
+            ForEachThreadSiteRange<Collision>(range.first, range.count, [&](site_t firstIndex, site_t siteCount)
+            {
+              collision.template DoPostStep<tDoRayTracing> (firstIndex, siteCount, &mParams, mLatDat, propertyCache);
+            });
+          });
+        }
+
+        /**
+         * Share the range out between the OpenMP threads (see lb::ForEachThreadSiteRange) if
+         * it is big enough to be worth it and the streamer allows it. This is safe because each
+         * site only writes its own streamed distributions, cache entries and stability slot; the
+         * iolets (boundary values, velocity profiles and weights) and the Ladd link profiles are
+         * only read while streaming. Streamers that keep state in shared containers say they
+         * aren't thread safe, and get the whole range as one piece.
+         */
+        template<typename Collision, typename RangeFunctor>
+        void ForEachThreadSiteRange(const site_t firstIndex, const site_t siteCount, RangeFunctor rangeFunctor)
+        {
+          // Below this there isn't enough work to be worth waking the threads.
+          const site_t minimumThreadedSites = 256;
+          // Cut on multiples of the layout's granularity, so that no two threads write to the
+          // same tile of distributions.
+          lb::ForEachThreadSiteRange(firstIndex,
+                                     siteCount,
+                                     Collision::IsThreadSafe && siteCount >= minimumThreadedSites,
+                                     geometry::DistributionLayout::SiteGranularity,
+                                     rangeFunctor);
+        }
+
         unsigned int inletCount;
         unsigned int outletCount;
 
@@ -106,26 +106,55 @@ namespace hemelb
 
       unsigned collId;
       InitInitParamsSiteRanges(initParams, collId);
-      mMidFluidCollision = new tMidFluidCollision(initParams);
+      tMidFluidCollision* midFluidCollision = new tMidFluidCollision(initParams);
 
       AdvanceInitParamsSiteRanges(initParams, collId);
-      mWallCollision = new tWallCollision(initParams);
+      tWallCollision* wallCollision = new tWallCollision(initParams);
 
       AdvanceInitParamsSiteRanges(initParams, collId);
       initParams.boundaryObject = mInletValues;
-      mInletCollision = new tInletCollision(initParams);
+      tInletCollision* inletCollision = new tInletCollision(initParams);
 
       AdvanceInitParamsSiteRanges(initParams, collId);
       initParams.boundaryObject = mOutletValues;
-      mOutletCollision = new tOutletCollision(initParams);
+      tOutletCollision* outletCollision = new tOutletCollision(initParams);
 
       AdvanceInitParamsSiteRanges(initParams, collId);
       initParams.boundaryObject = mInletValues;
-      mInletWallCollision = new tInletWallCollision(initParams);
+      tInletWallCollision* inletWallCollision = new tInletWallCollision(initParams);
 
       AdvanceInitParamsSiteRanges(initParams, collId);
       initParams.boundaryObject = mOutletValues;
-      mOutletWallCollision = new tOutletWallCollision(initParams);
+      tOutletWallCollision* outletWallCollision = new tOutletWallCollision(initParams);
+
+      mCollisions.reset(new tCollisions(midFluidCollision,
+                                        wallCollision,
+                                        inletCollision,
+                                        outletCollision,
+                                        inletWallCollision,
+                                        outletWallCollision));
+      mCollisions->SetTimed(log::Logger::ShouldDisplay<log::Debug>());
+    }
+
+    template<class LatticeType>
+    void LBM<LatticeType>::InitCollisionRanges()
+    {
+      /**
+       * PreSend does LB on all the sites that need to have results sent to neighbouring ranks
+       * ('domainEdge' sites), PreReceive on all the sites whose neighbours lie on this rank
+       * ('midDomain'), and PostReceive does the post step on everything. Empty ranges are
+       * dropped, and neighbouring ranges of the same type joined.
+       */
+      preSendRanges = GetDomainEdgeCollisionRanges(*mLatDat);
+      MergeCollisionRanges(preSendRanges);
+
+      preReceiveRanges = GetMidDomainCollisionRanges(*mLatDat);
+      MergeCollisionRanges(preReceiveRanges);
+
+      postReceiveRanges = GetDomainEdgeCollisionRanges(*mLatDat);
+      const CollisionRanges midDomainRanges = GetMidDomainCollisionRanges(*mLatDat);
+      postReceiveRanges.insert(postReceiveRanges.end(), midDomainRanges.begin(), midDomainRanges.end());
+      MergeCollisionRanges(postReceiveRanges);
     }
 
     template<class LatticeType>
@@ -139,6 +168,7 @@ namespace hemelb
       mUnits = iUnits;
 
       InitCollisions();
+      InitCollisionRanges();
 
       mVisControl = iControl;
     }
@@ -184,11 +214,16 @@ namespace hemelb
     {
       timings[hemelb::reporting::Timers::lb].Start();
 
+#ifdef HEMELB_USE_PERSISTENT_HALO
+      // The halo bypasses the net, so the receives can be started now.
+      mLatDat->StartHaloReceives();
+#else
       // Delegate to the lattice data object to post the asynchronous sends and receives
       // (via the Net object).
       // NOTE that this doesn't actually *perform* the sends and receives, it asks the Net
       // to include them in the ISends and IRecvs that happen later.
       mLatDat->SendAndReceive(mNet);
+#endif
 
       timings[hemelb::reporting::Timers::lb].Stop();
     }
@@ -199,32 +234,50 @@ namespace hemelb
       timings[hemelb::reporting::Timers::lb].Start();
       timings[hemelb::reporting::Timers::lb_calc].Start();
 
-      /**
-       * In the PreSend phase, we do LB on all the sites that need to have results sent to
-       * neighbouring ranks ('domainEdge' sites). In site id terms, this means we start at the
-       * end of the sites whose neighbours all lie on this rank ('midDomain'), then progress
-       * through the sites of each type in turn.
-       */
-      site_t offset = mLatDat->GetMidDomainSiteCount();
-
-      StreamAndCollide(mMidFluidCollision, offset, mLatDat->GetDomainEdgeCollisionCount(0));
-      offset += mLatDat->GetDomainEdgeCollisionCount(0);
-
-      StreamAndCollide(mWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(1));
-      offset += mLatDat->GetDomainEdgeCollisionCount(1);
-
-      mInletValues->FinishReceive();
-      StreamAndCollide(mInletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(2));
-      offset += mLatDat->GetDomainEdgeCollisionCount(2);
-
-      mOutletValues->FinishReceive();
-      StreamAndCollide(mOutletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(3));
-      offset += mLatDat->GetDomainEdgeCollisionCount(3);
-
-      StreamAndCollide(mInletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(4));
-      offset += mLatDat->GetDomainEdgeCollisionCount(4);
-
-      StreamAndCollide(mOutletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(5));
+      // The iolet streamers need this step's boundary values, so wait for them as late as we
+      // can: just before the first range that uses them.
+      bool inletValuesReceived = false;
+      bool outletValuesReceived = false;
+      auto receiveInletValues = [&]()
+      {
+        if (!inletValuesReceived)
+        {
+          mInletValues->FinishReceive();
+          inletValuesReceived = true;
+        }
+      };
+      auto receiveOutletValues = [&]()
+      {
+        if (!outletValuesReceived)
+        {
+          mOutletValues->FinishReceive();
+          outletValuesReceived = true;
+        }
+      };
+
+      StreamAndCollide(preSendRanges, [&](const CollisionRange& range)
+      {
+        if (range.collision == 2 || range.collision == 4)
+        {
+          receiveInletValues();
+        }
+        else if (range.collision == 3 || range.collision == 5)
+        {
+          receiveOutletValues();
+        }
+      });
+
+      // The mid-domain iolet sites use them too.
+      receiveInletValues();
+      receiveOutletValues();
+
+      // With in-place streaming, half the time steps leave the values to send in the sites' own
+      // slots rather than in the send buffer.
+      mLatDat->FillSharedSendBuffer();
+
+#ifdef HEMELB_USE_PERSISTENT_HALO
+      mLatDat->StartHaloSends();
+#endif
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
@@ -236,32 +289,11 @@ namespace hemelb
       timings[hemelb::reporting::Timers::lb].Start();
       timings[hemelb::reporting::Timers::lb_calc].Start();
 
-      /**
-       * In the PreReceive phase, we perform LB for all the sites whose neighbours lie on this
-       * rank ('midDomain' rather than 'domainEdge' sites). Ideally this phase is the longest bit (maximising time for the asynchronous sends
-       * and receives to complete).
-       *
-       * In site id terms, this means starting at the first site and progressing through the
-       * midDomain sites, one type at a time.
-       */
-      site_t offset = 0;
-
-      StreamAndCollide(mMidFluidCollision, offset, mLatDat->GetMidDomainCollisionCount(0));
-      offset += mLatDat->GetMidDomainCollisionCount(0);
-
-      StreamAndCollide(mWallCollision, offset, mLatDat->GetMidDomainCollisionCount(1));
-      offset += mLatDat->GetMidDomainCollisionCount(1);
-
-      StreamAndCollide(mInletCollision, offset, mLatDat->GetMidDomainCollisionCount(2));
-      offset += mLatDat->GetMidDomainCollisionCount(2);
-
-      StreamAndCollide(mOutletCollision, offset, mLatDat->GetMidDomainCollisionCount(3));
-      offset += mLatDat->GetMidDomainCollisionCount(3);
-
-      StreamAndCollide(mInletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(4));
-      offset += mLatDat->GetMidDomainCollisionCount(4);
-
-      StreamAndCollide(mOutletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(5));
+      // Ideally this phase is the longest bit (maximising time for the asynchronous sends and
+      // receives to complete).
+      StreamAndCollide(preReceiveRanges, [](const CollisionRange&)
+      {
+      });
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
@@ -275,49 +307,15 @@ namespace hemelb
       // Copy the distribution functions received from the neighbouring
       // processors into the destination buffer "f_new".
       // This is done here, after receiving the sent distributions from neighbours.
+#ifdef HEMELB_USE_PERSISTENT_HALO
+      mLatDat->WaitHalo();
+#endif
       mLatDat->CopyReceived();
 
-      // Do any cleanup steps necessary on boundary nodes
-      site_t offset = mLatDat->GetMidDomainSiteCount();
-
       timings[hemelb::reporting::Timers::lb_calc].Start();
 
-      //TODO yup, this is horrible. If you read this, please improve the following code.
-      PostStep(mMidFluidCollision, offset, mLatDat->GetDomainEdgeCollisionCount(0));
-      offset += mLatDat->GetDomainEdgeCollisionCount(0);
-
-      PostStep(mWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(1));
-      offset += mLatDat->GetDomainEdgeCollisionCount(1);
-
-      PostStep(mInletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(2));
-      offset += mLatDat->GetDomainEdgeCollisionCount(2);
-
-      PostStep(mOutletCollision, offset, mLatDat->GetDomainEdgeCollisionCount(3));
-      offset += mLatDat->GetDomainEdgeCollisionCount(3);
-
-      PostStep(mInletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(4));
-      offset += mLatDat->GetDomainEdgeCollisionCount(4);
-
-      PostStep(mOutletWallCollision, offset, mLatDat->GetDomainEdgeCollisionCount(5));
-
-      offset = 0;
-
-      PostStep(mMidFluidCollision, offset, mLatDat->GetMidDomainCollisionCount(0));
-      offset += mLatDat->GetMidDomainCollisionCount(0);
-
-      PostStep(mWallCollision, offset, mLatDat->GetMidDomainCollisionCount(1));
-      offset += mLatDat->GetMidDomainCollisionCount(1);
-
-      PostStep(mInletCollision, offset, mLatDat->GetMidDomainCollisionCount(2));
-      offset += mLatDat->GetMidDomainCollisionCount(2);
-
-      PostStep(mOutletCollision, offset, mLatDat->GetMidDomainCollisionCount(3));
-      offset += mLatDat->GetMidDomainCollisionCount(3);
-
-      PostStep(mInletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(4));
-      offset += mLatDat->GetMidDomainCollisionCount(4);
-
-      PostStep(mOutletWallCollision, offset, mLatDat->GetMidDomainCollisionCount(5));
+      // Do any cleanup steps necessary on boundary nodes
+      PostStep(postReceiveRanges);
 
       timings[hemelb::reporting::Timers::lb_calc].Stop();
       timings[hemelb::reporting::Timers::lb].Stop();
@@ -337,15 +335,55 @@ namespace hemelb
     }
 
     template<class LatticeType>
-    LBM<LatticeType>::~LBM()
+    void LBM<LatticeType>::LogCollisionRangeTimes() const
     {
-      // Delete the collision and stream objects we've been using
-      delete mMidFluidCollision;
-      delete mWallCollision;
-      delete mInletCollision;
-      delete mOutletCollision;
-      delete mInletWallCollision;
-      delete mOutletWallCollision;
+      if (!mCollisions->IsTimed())
+      {
+        return;
+      }
+
+      const CollisionRanges* phases[] = { &preSendRanges, &preReceiveRanges, &postReceiveRanges };
+      const char* phaseNames[] = { "PreSend", "PreReceive", "PostReceive" };
+      for (unsigned phase = 0; phase < 3; ++phase)
+      {
+        for (const CollisionRange& range : *phases[phase])
+        {
+          log::Logger::Log<log::Debug, log::OnePerCore>("%s: collision type %u, sites [%li, %li): %.6f s",
+                                                        phaseNames[phase],
+                                                        range.collision,
+                                                        range.first,
+                                                        range.first + range.count,
+                                                        range.seconds);
+        }
+      }
+    }
+
+    template<class LatticeType>
+    void LBM<LatticeType>::TimeCollisions()
+    {
+      mCollisions->SetTimed(true);
+    }
+
+    template<class LatticeType>
+    void LBM<LatticeType>::GetCollisionTimes(std::vector<double>& seconds,
+                                             std::vector<site_t>& sites) const
+    {
+      seconds.assign(tCollisions::CollisionCount, 0.0);
+      sites.assign(tCollisions::CollisionCount, 0);
+
+      // Every site is collided once, in PreSend or PreReceive, and post-stepped in PostReceive.
+      const CollisionRanges* phases[] = { &preSendRanges, &preReceiveRanges, &postReceiveRanges };
+      for (unsigned phase = 0; phase < 3; ++phase)
+      {
+        for (const CollisionRange& range : *phases[phase])
+        {
+          seconds[range.collision] += range.seconds;
+          if (phase < 2)
+          {
+            sites[range.collision] += range.count;
+          }
+        }
+      }
     }
 
     template<class LatticeType>
@@ -8,6 +8,7 @@
 #define HEMELB_LB_STREAMERS_BASESTREAMER_H
 
 #include <cmath>
+#include <type_traits>
 
 #include "geometry/LatticeData.h"
 #include "vis/Control.h"
@@ -31,6 +32,9 @@ namespace hemelb
        *  - <bool tDoRayTracing> PostStep(const site_t, const site_t, const LbmParameters*,
        *      geometry::LatticeData*, hemelb::vis::Control*)
        *  - Reset(kernels::InitParams* init)
+       *  - IsThreadSafe, whether disjoint site ranges may be streamed and collided (or
+       *    post-stepped) concurrently. Streamers that keep state in shared containers hide
+       *    this with false.
        *
        * The following must be implemented by concrete streamers (which derive from this class
        * using the CRTP).
@@ -54,6 +58,8 @@ namespace hemelb
       class BaseStreamer
       {
         public:
+          static const bool IsThreadSafe = true;
+
           template<bool tDoRayTracing>
           inline void StreamAndCollide(const site_t firstIndex,
                                        const site_t siteCount,
@@ -85,12 +91,161 @@ namespace hemelb
           }
 
         protected:
+          /**
+           * Calculate the pre-collision variables and collide every site in
+           * [firstIndex, firstIndex + siteCount), then hand each site and its hydrodynamic
+           * variables to streamSite(site, hydroVars) to be streamed.
+           *
+           * If the collision supports it, runs of HydroVarsBatch::WIDTH sites are collided
+           * together by the batched kernel and only the remainder is done one site at a time.
+           */
+          template<typename CollisionType, typename SiteFunctor>
+          inline static void CollideSites(CollisionType& collider,
+                                          const site_t firstIndex,
+                                          const site_t siteCount,
+                                          const LbmParameters* lbmParams,
+                                          geometry::LatticeData* latDat,
+                                          SiteFunctor streamSite)
+          {
+            CollideSites(collider,
+                         firstIndex,
+                         siteCount,
+                         lbmParams,
+                         latDat,
+                         streamSite,
+                         [](const site_t, const kernels::HydroVarsBatch<typename CollisionType::CKernel::LatticeType>&)
+                         {
+                           return false;
+                         });
+          }
+
+          /**
+           * As above, but each collided batch is first offered to
+           * streamBatch(batchStart, batch). If that returns true it has streamed the whole
+           * batch itself, straight from the batch arrays; if false the batch is handed to
+           * streamSite one site at a time as usual.
+           */
+          template<typename CollisionType, typename SiteFunctor, typename BatchFunctor>
+          inline static void CollideSites(CollisionType& collider,
+                                          const site_t firstIndex,
+                                          const site_t siteCount,
+                                          const LbmParameters* lbmParams,
+                                          geometry::LatticeData* latDat,
+                                          SiteFunctor streamSite,
+                                          BatchFunctor streamBatch)
+          {
+            CollideSites(collider,
+                         firstIndex,
+                         siteCount,
+                         lbmParams,
+                         latDat,
+                         streamSite,
+                         streamBatch,
+                         std::integral_constant<bool, CollisionType::SupportsBatch>());
+          }
+
+          template<typename CollisionType, typename SiteFunctor, typename BatchFunctor>
+          inline static void CollideSites(CollisionType& collider,
+                                          const site_t firstIndex,
+                                          const site_t siteCount,
+                                          const LbmParameters* lbmParams,
+                                          geometry::LatticeData* latDat,
+                                          SiteFunctor streamSite,
+                                          BatchFunctor,
+                                          std::false_type)
+          {
+            typedef typename CollisionType::CKernel::LatticeType LatticeType;
+
+            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            {
+              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
+
+              const distribn_t* fOld = site.GetFOld<LatticeType> ();
+
+              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
+
+              ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
+              hydroVars.tau = lbmParams->GetTau();
+
+              collider.CalculatePreCollision(hydroVars, site);
+
+              collider.Collide(lbmParams, hydroVars);
+
+              streamSite(site, hydroVars);
+            }
+          }
+
+          template<typename CollisionType, typename SiteFunctor, typename BatchFunctor>
+          inline static void CollideSites(CollisionType& collider,
+                                          const site_t firstIndex,
+                                          const site_t siteCount,
+                                          const LbmParameters* lbmParams,
+                                          geometry::LatticeData* latDat,
+                                          SiteFunctor streamSite,
+                                          BatchFunctor streamBatch,
+                                          std::true_type)
+          {
+            typedef typename CollisionType::CKernel::LatticeType LatticeType;
+            typedef kernels::HydroVarsBatch<LatticeType> BatchType;
+            const unsigned WIDTH = BatchType::WIDTH;
+
+            BatchType batch;
+            const site_t batchedEnd = firstIndex + (siteCount / WIDTH) * WIDTH;
+
+            for (site_t batchStart = firstIndex; batchStart < batchedEnd; batchStart += WIDTH)
+            {
+              latDat->GetFOldBatch<LatticeType, WIDTH>(batchStart, batch.f);
+
+              collider.CalculatePreCollisionBatch(batch);
+
+              collider.CollideBatch(lbmParams, batch);
+
+              if (streamBatch(batchStart, batch))
+              {
+                continue;
+              }
+
+              for (unsigned lane = 0; lane < WIDTH; ++lane)
+              {
+                geometry::Site<geometry::LatticeData> site = latDat->GetSite(batchStart + lane);
+
+                // The lane's distributions are already in the batch, so there is no need to
+                // gather them from the lattice again.
+                distribn_t f[LatticeType::NUMVECTORS];
+                for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction)
+                {
+                  f[direction] = batch.f[direction][lane];
+                }
+
+                kernels::HydroVars<typename CollisionType::CKernel> hydroVars(f);
+                hydroVars.tau = lbmParams->GetTau();
+                collider.CopyLaneTo(batch, lane, hydroVars);
+
+                streamSite(site, hydroVars);
+              }
+            }
+
+            CollideSites(collider,
+                         batchedEnd,
+                         firstIndex + siteCount - batchedEnd,
+                         lbmParams,
+                         latDat,
+                         streamSite,
+                         streamBatch,
+                         std::false_type());
+          }
+
           template<bool tDoRayTracing, class LatticeType>
           inline static void UpdateMinsAndMaxes(const geometry::Site<geometry::LatticeData>& site,
                                                 const kernels::HydroVarsBase<LatticeType>& hydroVars,
                                                 const LbmParameters* lbmParams,
                                                 lb::MacroscopicPropertyCache& propertyCache)
           {
+            if (propertyCache.stabilityAccumulator.IsRequired())
+            {
+              propertyCache.stabilityAccumulator.Accumulate<LatticeType>(site.GetIndex(), hydroVars);
+            }
+
             if (propertyCache.densityCache.RequiresRefresh())
             {
               propertyCache.densityCache.Put(site.GetIndex(), hydroVars.density);
@@ -9,6 +9,7 @@
 
 #include "lb/streamers/BaseStreamerDelegate.h"
 #include "lb/streamers/SimpleBounceBackDelegate.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -39,6 +40,10 @@ namespace hemelb
           BouzidiFirdaousLallemandDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams) :
             bbDelegate(delegatorCollider, initParams)
           {
+            if (geometry::StreamingPattern::InPlace)
+            {
+              throw Exception() << "BFL walls are not available with in-place streaming";
+            }
           }
 
           inline void StreamLink(const LbmParameters* lbmParams,
@@ -48,7 +53,7 @@ namespace hemelb
                                  const Direction& direction)
           {
             site_t invDirection = LatticeType::INVERSEDIRECTIONS[direction];
-            site_t bbDestination = (site.GetIndex() * LatticeType::NUMVECTORS) + invDirection;
+            site_t bbDestination = site.GetDistributionIndex<LatticeType> (invDirection);
             distribn_t q = site.GetWallDistance<LatticeType> (direction);
 
             if (site.HasWall(invDirection) || q < 0.5)
@@ -64,8 +69,10 @@ namespace hemelb
             {
               // We have a fluid site and have all the data needed to complete this direction!
               // Implement Eq (5b) from Bouzidi et al.
-              * (latticeData->GetFNew(bbDestination)) = (hydroVars.GetFPostCollision()[direction] + (2.0 * q - 1)
-                  * hydroVars.GetFPostCollision()[invDirection]) / (2.0 * q);
+              latticeData->SetFNew(bbDestination,
+                                   direction,
+                                   (hydroVars.GetFPostCollision()[direction] + (2.0 * q - 1)
+                                       * hydroVars.GetFPostCollision()[invDirection]) / (2.0 * q));
             }
 
           }
@@ -73,7 +80,6 @@ namespace hemelb
                                    const geometry::Site<geometry::LatticeData>& site,
                                    const Direction& direction)
           {
-            distribn_t* fNew = latticeData->GetFNew(site.GetIndex() * LatticeType::NUMVECTORS);
             site_t invDirection = LatticeType::INVERSEDIRECTIONS[direction];
             distribn_t q = site.GetWallDistance<LatticeType> (direction);
             // If there is no fluid site in the opposite direction, fall back to simple
@@ -88,7 +94,13 @@ namespace hemelb
               // Note that:
               // - fNew[direction] is the newly-arrived fPostColl[direction] from the neighbouring site
               // - fNew[invDirection] is the above-bounced-back fPostColl[direction] for this site.
-              fNew[invDirection] = 2.0 * q * fNew[invDirection] + (1.0 - 2.0 * q) * fNew[direction];
+              const site_t invIndex = site.GetDistributionIndex<LatticeType> (invDirection);
+              latticeData->SetFNew(invIndex,
+                                   invDirection,
+                                   2.0 * q * latticeData->GetFNewValue(invIndex, invDirection)
+                                       + (1.0 - 2.0 * q)
+                                           * latticeData->GetFNewValue(site.GetDistributionIndex<LatticeType> (direction),
+                                                                       direction));
             }
           }
       };
@@ -7,9 +7,11 @@
 #ifndef HEMELB_LB_STREAMERS_GUOZHENGSHIDELEGATE_H
 #define HEMELB_LB_STREAMERS_GUOZHENGSHIDELEGATE_H
 
+#include <algorithm>
 #include "lb/streamers/BaseStreamerDelegate.h"
 #include "geometry/neighbouring/RequiredSiteInformation.h"
 #include "geometry/neighbouring/NeighbouringDataManager.h"
+#include "Exception.h"
 
 namespace hemelb
 {
@@ -36,6 +38,11 @@ namespace hemelb
                 bValues(initParams.boundaryObject),
                 bbDelegate(delegatorCollider, initParams)
           {
+            if (geometry::StreamingPattern::InPlace)
+            {
+              throw Exception() << "GZS walls are not available with in-place streaming";
+            }
+
             // Want to loop over each site this streamer is responsible for,
             // as specified in the siteRanges.
             for (std::vector<std::pair<site_t, site_t> >::iterator rangeIt =
@@ -146,6 +153,8 @@ namespace hemelb
             kernels::HydroVars<typename CollisionType::CKernel> hydroVarsWall(fWall);
 
             hydroVarsWall.density = hydroVars.density;
+            // Kernels with a local relaxation time (e.g. LBGKNN) collide with this.
+            hydroVarsWall.tau = hydroVars.tau;
             hydroVarsWall.momentum = hydroVars.momentum * (1. - 1. / wallDistance);
 
             // Find the non-equilibrium distribution in the unstreamed direction.
@@ -217,7 +226,8 @@ namespace hemelb
                 else
                 {
                   // There is a neighbour site to use for standard GZS to calculate u_w2.
-                  const distribn_t *neighbourFOld = GetNeighbourFOld(site, i, latDat);
+                  distribn_t neighbourFOldBuffer[LatticeType::NUMVECTORS];
+                  const distribn_t *neighbourFOld = GetNeighbourFOld(site, i, latDat, neighbourFOldBuffer);
                   // Now calculate this field information.
                   LatticeVelocity neighbourVelocity;
                   distribn_t neighbourFEq[LatticeType::NUMVECTORS];
@@ -287,15 +297,20 @@ namespace hemelb
             // Perform collision
             collider.Collide(lbmParams, hydroVarsWall);
             // stream
-            distribn_t* fNew = latDat->GetFNew(site.GetIndex() * LatticeType::NUMVECTORS);
-            fNew[i] = hydroVarsWall.GetFPostCollision()[i];
+            latDat->SetFNew(site.GetDistributionIndex<LatticeType> (i), i, hydroVarsWall.GetFPostCollision()[i]);
 
           }
 
         private:
+          /**
+           * Get the neighbour's fOld. If the distribution layout means the local neighbour's
+           * values have to be gathered, they are copied into gatherBuffer so that they outlive
+           * the temporary Site.
+           */
           const distribn_t *GetNeighbourFOld(const geometry::Site<geometry::LatticeData>& site,
                                              const Direction& i,
-                                             geometry::LatticeData* const latDat)
+                                             geometry::LatticeData* const latDat,
+                                             distribn_t* gatherBuffer)
           {
             const distribn_t* neighbourFOld;
             // Find the neighbour's global location and which proc it's on.
@@ -308,6 +323,11 @@ namespace hemelb
               geometry::Site<geometry::LatticeData> nextSiteOut =
                   latDat->GetSite(latDat->GetContiguousSiteId(neighbourGlobalLocation));
               neighbourFOld = nextSiteOut.GetFOld<LatticeType> ();
+              if (!geometry::LatticeData::SitesAreContiguous)
+              {
+                std::copy(neighbourFOld, neighbourFOld + LatticeType::NUMVECTORS, gatherBuffer);
+                neighbourFOld = gatherBuffer;
+              }
             }
             else
             {
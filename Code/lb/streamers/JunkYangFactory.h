@@ -9,6 +9,7 @@
 
 #include "lb/kernels/BaseKernel.h"
 #include "lb/streamers/BaseStreamer.h"
+#include "Exception.h"
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/lu.hpp>
 #include <boost/numeric/ublas/io.hpp>
@@ -40,12 +41,19 @@ namespace hemelb
         public:
 
           typedef CollisionImpl CollisionType;
+          // The per-site matrices and vectors live in std::maps filled in as we go.
+          static const bool IsThreadSafe = false;
 
           JunkYangFactory(kernels::InitParams& initParams) :
               collider(initParams), bulkLinkDelegate(collider, initParams),
                   ioletLinkDelegate(collider, initParams), THETA(0.7),
                   latticeData(*initParams.latDat)
           {
+            if (geometry::StreamingPattern::InPlace)
+            {
+              throw Exception() << "Junk-Yang walls are not available with in-place streaming";
+            }
+
             for (std::vector<std::pair<site_t, site_t> >::iterator rangeIt =
                 initParams.siteRanges.begin(); rangeIt != initParams.siteRanges.end(); ++rangeIt)
             {
@@ -181,8 +189,10 @@ namespace hemelb
                   incomingVelocityIter != incomingVelocities[siteIndex].end();
                   ++incomingVelocityIter, ++index)
               {
-                * (latticeData->GetFNew(siteIndex * LatticeType::NUMVECTORS + *incomingVelocityIter)) =
-                    systemSolution[index];
+                latticeData->SetFNew(latticeData->GetDistributionIndex<LatticeType>(siteIndex,
+                                                                                    *incomingVelocityIter),
+                                     *incomingVelocityIter,
+                                     systemSolution[index]);
               }
 
               geometry::Site<geometry::LatticeData> site = latticeData->GetSite(siteIndex);
@@ -465,8 +475,9 @@ namespace hemelb
                 outgoingDirIter != outgoingVelocities[contiguousSiteIndex].end();
                 ++outgoingDirIter, ++index)
             {
-              fNew[index] = *latticeData.GetFNew(contiguousSiteIndex * LatticeType::NUMVECTORS
-                  + *outgoingDirIter);
+              fNew[index] = latticeData.GetFNewValue(latticeData.GetDistributionIndex<LatticeType>(contiguousSiteIndex,
+                                                                                                   *outgoingDirIter),
+                                                     *outgoingDirIter);
             }
 
             rVector = THETA
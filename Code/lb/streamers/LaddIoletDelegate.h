@@ -7,6 +7,7 @@
 #ifndef HEMELB_LB_STREAMERS_LADDIOLETDELEGATE_H
 #define HEMELB_LB_STREAMERS_LADDIOLETDELEGATE_H
 
+#include <vector>
 #include "lb/streamers/SimpleBounceBackDelegate.h"
 
 namespace hemelb
@@ -25,8 +26,35 @@ namespace hemelb
 
           LaddIoletDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams) :
               SimpleBounceBackDelegate<CollisionType>(delegatorCollider, initParams),
-                  bValues(initParams.boundaryObject)
+                  bValues(initParams.boundaryObject), siteRanges(initParams.siteRanges)
           {
+            // Work out the velocity profile along every iolet link of our sites once, for the
+            // iolets where it only scales with time. Links are indexed by the position of the
+            // site in our ranges, then direction.
+            site_t rangeSite = 0;
+            for (auto range = siteRanges.begin(); range != siteRanges.end(); ++range)
+            {
+              for (site_t index = range->first; index < range->second; ++index, ++rangeSite)
+              {
+                const geometry::Site<const geometry::LatticeData> site = initParams.latDat->GetSite(index);
+                const iolets::InOutLetVelocity* iolet = GetIolet(site);
+                if (!iolet->IsSeparable())
+                {
+                  continue;
+                }
+                if (linkProfiles.empty())
+                {
+                  linkProfiles.resize(GetRangeSite(-1) * LatticeType::NUMVECTORS, LatticeVelocity::Zero());
+                }
+                for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ++ii)
+                {
+                  if (site.HasIolet(ii))
+                  {
+                    linkProfiles[rangeSite * LatticeType::NUMVECTORS + ii] = iolet->GetProfile(GetHalfWay(site, ii));
+                  }
+                }
+              }
+            }
           }
 
           inline void StreamLink(const LbmParameters* lbmParams,
@@ -45,18 +73,19 @@ namespace hemelb
             // where u is the velocity of the boundary half way along the
             // link and a1_i = w_1 / cs2
 
-            int boundaryId = site.GetIoletId();
-            iolets::InOutLetVelocity* iolet =
-                dynamic_cast<iolets::InOutLetVelocity*>(bValues->GetLocalIolet(boundaryId));
-            LatticePosition sitePos(site.GetGlobalSiteCoords());
-
-            LatticePosition halfWay(sitePos);
-            halfWay.x += 0.5 * LatticeType::CX[ii];
-            halfWay.y += 0.5 * LatticeType::CY[ii];
-            halfWay.z += 0.5 * LatticeType::CZ[ii];
-
-            LatticeVelocity wallMom(iolet->GetVelocity(halfWay, bValues->GetTimeStep()));
-            //TODO: Add site.GetGlobalSiteCoords() as a first argument?
+            const iolets::InOutLetVelocity* iolet = GetIolet(site);
+            const site_t rangeSite = GetRangeSite(site.GetIndex());
+            LatticeVelocity wallMom;
+            if (iolet->IsSeparable() && !linkProfiles.empty()
+                && std::size_t(rangeSite) < linkProfiles.size() / LatticeType::NUMVECTORS)
+            {
+              wallMom = linkProfiles[rangeSite * LatticeType::NUMVECTORS + ii]
+                  * iolet->GetTimeFactor(bValues->GetTimeStep());
+            }
+            else
+            {
+              wallMom = iolet->GetVelocity(GetHalfWay(site, ii), bValues->GetTimeStep());
+            }
 
             if (CollisionType::CKernel::LatticeType::IsLatticeCompressible())
             {
@@ -67,12 +96,48 @@ namespace hemelb
                 * (wallMom.x * LatticeType::CX[ii] + wallMom.y * LatticeType::CY[ii]
                     + wallMom.z * LatticeType::CZ[ii]) / Cs2;
 
-            * (latticeData->GetFNew(SimpleBounceBackDelegate<CollisionImpl>::GetBBIndex(site.GetIndex(),
-                                                                                        ii))) =
-                hydroVars.GetFPostCollision()[ii] - correction;
+            latticeData->SetFNew(SimpleBounceBackDelegate<CollisionImpl>::GetBBIndex(latticeData,
+                                                                                     site.GetIndex(),
+                                                                                     ii),
+                                 ii,
+                                 hydroVars.GetFPostCollision()[ii] - correction);
           }
         private:
+          template<typename SiteType>
+          const iolets::InOutLetVelocity* GetIolet(const SiteType& site) const
+          {
+            return dynamic_cast<const iolets::InOutLetVelocity*>(bValues->GetLocalIolet(site.GetIoletId()));
+          }
+
+          //! The point half way along the link from the site in direction ii.
+          template<typename SiteType>
+          static LatticePosition GetHalfWay(const SiteType& site, Direction ii)
+          {
+            LatticePosition halfWay(site.GetGlobalSiteCoords());
+            halfWay.x += 0.5 * LatticeType::CX[ii];
+            halfWay.y += 0.5 * LatticeType::CY[ii];
+            halfWay.z += 0.5 * LatticeType::CZ[ii];
+            return halfWay;
+          }
+
+          //! The position of a site in our ranges, or the number of sites in them if it isn't in any.
+          site_t GetRangeSite(site_t index) const
+          {
+            site_t offset = 0;
+            for (auto range = siteRanges.begin(); range != siteRanges.end(); ++range)
+            {
+              if (index >= range->first && index < range->second)
+              {
+                return offset + index - range->first;
+              }
+              offset += range->second - range->first;
+            }
+            return offset;
+          }
+
           iolets::BoundaryValues* bValues;
+          std::vector<std::pair<site_t, site_t> > siteRanges;
+          std::vector<LatticeVelocity> linkProfiles;
       };
 
     }
@@ -58,8 +58,9 @@ namespace hemelb
 
             Direction unstreamed = LatticeType::INVERSEDIRECTIONS[direction];
 
-            *latticeData->GetFNew(site.GetIndex() * LatticeType::NUMVECTORS + unstreamed)
-                = ghostHydrovars.GetFEq()[unstreamed];
+            latticeData->SetFNew(site.GetDistributionIndex<LatticeType> (unstreamed),
+                                 unstreamed,
+                                 ghostHydrovars.GetFEq()[unstreamed]);
           }
         protected:
           CollisionType& collider;
@@ -24,9 +24,12 @@ namespace hemelb
           typedef CollisionImpl CollisionType;
           typedef typename CollisionType::CKernel::LatticeType LatticeType;
 
-          static inline site_t GetBBIndex(site_t siteIndex, int direction)
+          static inline site_t GetBBIndex(const geometry::LatticeData* const latticeData,
+                                          site_t siteIndex,
+                                          int direction)
           {
-            return (siteIndex * LatticeType::NUMVECTORS) + LatticeType::INVERSEDIRECTIONS[direction];
+            return latticeData->GetDistributionIndex<LatticeType>(siteIndex,
+                                                                  LatticeType::INVERSEDIRECTIONS[direction]);
           }
 
           SimpleBounceBackDelegate(CollisionType& delegatorCollider, kernels::InitParams& initParams)
@@ -40,7 +43,9 @@ namespace hemelb
                                  const Direction& direction)
           {
             // Propagate the outgoing post-collisional f into the opposite direction.
-            * (latticeData->GetFNew(GetBBIndex(site.GetIndex(), direction))) = hydroVars.GetFPostCollision()[direction];
+            latticeData->SetFNew(GetBBIndex(latticeData, site.GetIndex(), direction),
+                                 direction,
+                                 hydroVars.GetFPostCollision()[direction]);
           }
 
       };
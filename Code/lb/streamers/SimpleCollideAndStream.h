@@ -44,21 +44,9 @@ namespace hemelb
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            auto streamSite = [&](const geometry::Site<geometry::LatticeData>& site,
+                                  kernels::HydroVars<typename CollisionType::CKernel>& hydroVars)
             {
-              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
-
-              const distribn_t* lFOld = site.GetFOld<LatticeType> ();
-
-              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(lFOld);
-
-              ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
-              hydroVars.tau = lbmParams->GetTau();
-
-              collider.CalculatePreCollision(hydroVars, site);
-
-              collider.Collide(lbmParams, hydroVars);
-
               for (unsigned int ii = 0; ii < LatticeType::NUMVECTORS; ii++)
               {
                 bulkLinkDelegate.StreamLink(lbmParams, latDat, site, hydroVars, ii);
@@ -68,7 +56,37 @@ namespace hemelb
                                                                                                hydroVars,
                                                                                                lbmParams,
                                                                                                propertyCache);
-            }
+            };
+
+            // Every link is a bulk link, so unless the property cache wants something from
+            // these sites, stream the post-collision values straight out of the batch.
+            const bool updateProperties = propertyCache.RequiresRefresh();
+            auto streamBatch = [&](const site_t batchStart,
+                                   const kernels::HydroVarsBatch<LatticeType>& batch)
+            {
+              if (updateProperties)
+              {
+                return false;
+              }
+
+              for (unsigned lane = 0; lane < kernels::HydroVarsBatch<LatticeType>::WIDTH; ++lane)
+              {
+                const geometry::Site<geometry::LatticeData> site = latDat->GetSite(batchStart + lane);
+                for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ii++)
+                {
+                  latDat->SetFNew(site.GetStreamedIndex<LatticeType>(ii), ii, batch.fPostCollision[ii][lane]);
+                }
+              }
+              return true;
+            };
+
+            BaseStreamer<SimpleCollideAndStream>::CollideSites(collider,
+                                                               firstIndex,
+                                                               siteCount,
+                                                               lbmParams,
+                                                               latDat,
+                                                               streamSite,
+                                                               streamBatch);
           }
 
           template<bool tDoRayTracing>
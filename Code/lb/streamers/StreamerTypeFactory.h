@@ -52,21 +52,9 @@ namespace hemelb
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            auto streamSite = [&](const geometry::Site<geometry::LatticeData>& site,
+                                  kernels::HydroVars<typename CollisionType::CKernel>& hydroVars)
             {
-              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
-
-              const distribn_t* fOld = site.GetFOld<LatticeType> ();
-
-              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
-
-              ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
-              hydroVars.tau = lbmParams->GetTau();
-
-              collider.CalculatePreCollision(hydroVars, site);
-
-              collider.Collide(lbmParams, hydroVars);
-
               for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ii++)
               {
                 if (site.HasWall(ii))
@@ -84,7 +72,14 @@ namespace hemelb
                                                                                                 hydroVars,
                                                                                                 lbmParams,
                                                                                                 propertyCache);
-            }
+            };
+
+            BaseStreamer<WallStreamerTypeFactory>::CollideSites(collider,
+                                                                firstIndex,
+                                                                siteCount,
+                                                                lbmParams,
+                                                                latDat,
+                                                                streamSite);
           }
           template<bool tDoRayTracing>
           inline void DoPostStep(const site_t firstIndex,
@@ -143,21 +138,9 @@ namespace hemelb
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            auto streamSite = [&](const geometry::Site<geometry::LatticeData>& site,
+                                  kernels::HydroVars<typename CollisionType::CKernel>& hydroVars)
             {
-              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
-
-              const distribn_t* fOld = site.GetFOld<LatticeType> ();
-
-              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
-
-              ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
-              hydroVars.tau = lbmParams->GetTau();
-
-              collider.CalculatePreCollision(hydroVars, site);
-
-              collider.Collide(lbmParams, hydroVars);
-
               for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ii++)
               {
                 if (site.HasIolet(ii))
@@ -175,7 +158,14 @@ namespace hemelb
                                                                                                  hydroVars,
                                                                                                  lbmParams,
                                                                                                  propertyCache);
-            }
+            };
+
+            BaseStreamer<IoletStreamerTypeFactory>::CollideSites(collider,
+                                                                 firstIndex,
+                                                                 siteCount,
+                                                                 lbmParams,
+                                                                 latDat,
+                                                                 streamSite);
           }
           template<bool tDoRayTracing>
           inline void DoPostStep(const site_t firstIndex,
@@ -237,21 +227,9 @@ namespace hemelb
                                          geometry::LatticeData* latDat,
                                          lb::MacroscopicPropertyCache& propertyCache)
           {
-            for (site_t siteIndex = firstIndex; siteIndex < (firstIndex + siteCount); siteIndex++)
+            auto streamSite = [&](const geometry::Site<geometry::LatticeData>& site,
+                                  kernels::HydroVars<typename CollisionType::CKernel>& hydroVars)
             {
-              geometry::Site<geometry::LatticeData> site = latDat->GetSite(siteIndex);
-
-              const distribn_t* fOld = site.GetFOld<LatticeType> ();
-
-              kernels::HydroVars<typename CollisionType::CKernel> hydroVars(fOld);
-
-              ///< @todo #126 This value of tau will be updated by some kernels within the collider code (e.g. LBGKNN). It would be nicer if tau is handled in a single place.
-              hydroVars.tau = lbmParams->GetTau();
-
-              collider.CalculatePreCollision(hydroVars, site);
-
-              collider.Collide(lbmParams, hydroVars);
-
               for (Direction ii = 0; ii < LatticeType::NUMVECTORS; ii++)
               {
                 if (site.HasIolet(ii))
@@ -273,7 +251,14 @@ namespace hemelb
                                                                                                      hydroVars,
                                                                                                      lbmParams,
                                                                                                      propertyCache);
-            }
+            };
+
+            BaseStreamer<WallIoletStreamerTypeFactory>::CollideSites(collider,
+                                                                     firstIndex,
+                                                                     siteCount,
+                                                                     lbmParams,
+                                                                     latDat,
+                                                                     streamSite);
           }
 
           template<bool tDoRayTracing>
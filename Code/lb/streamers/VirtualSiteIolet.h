@@ -13,6 +13,7 @@
 #include "lb/streamers/BaseStreamerDelegate.h"
 #include "lb/streamers/VirtualSite.h"
 #include "log/Logger.h"
+#include "Exception.h"
 #include "util/FlatMap.h"
 #include <map>
 
@@ -30,6 +31,8 @@ namespace hemelb
         public:
 
           typedef CollisionImpl CollisionType;
+          // The virtual sites accumulate sums over the real sites that feed them.
+          static const bool IsThreadSafe = false;
           typedef typename CollisionType::CKernel::LatticeType LatticeType;
 
         private:
@@ -62,6 +65,11 @@ namespace hemelb
                 wallLinkDelegate(collider, initParams), bValues(initParams.boundaryObject),
                 neighbouringLatticeData(initParams.latDat->GetNeighbouringData())
           {
+            if (geometry::StreamingPattern::InPlace)
+            {
+              throw Exception() << "Virtual site iolets are not available with in-place streaming";
+            }
+
             // Loop over the local in/outlets, creating the extra data objects.
             unsigned nIolets = bValues->GetLocalIoletCount();
             for (unsigned iIolet = 0; iIolet < nIolets; ++iIolet)
@@ -221,7 +229,7 @@ namespace hemelb
               CalculateVirtualSiteDistributions(*latDat, *iolet, extra->hydroVarsCache, *vSite, t);
               // Stream this direction
               Direction i = vSiteIt->second.direction;
-              * (latDat->GetFNew(siteIdx * LatticeType::NUMVECTORS + i)) = vSite->hv.fPostColl[i];
+              latDat->SetFNew(latDat->GetDistributionIndex<LatticeType>(siteIdx, i), i, vSite->hv.fPostColl[i]);
               //* (latticeData->GetFNew(GetBBIndex(site.GetIndex(), direction))) = hydroVars.GetFPostCollision()[direction];
               //return (siteIndex * LatticeType::NUMVECTORS) + LatticeType::INVERSEDIRECTIONS[direction];
             }
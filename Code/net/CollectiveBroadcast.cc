@@ -0,0 +1,110 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstring>
+#include "net/CollectiveBroadcast.h"
+#include "net/MpiError.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    CollectiveBroadcast::CollectiveBroadcast(Net* net, const lb::SimulationState* simState,
+                                             unsigned int spreadFactor) :
+        mNet(net), mSimState(simState),
+            reductionPeriod(GetReductionPeriod(net->GetCommunicator().Size(), spreadFactor)),
+            opCreated(false), request(MPI_REQUEST_NULL), reducing(false)
+    {
+    }
+
+    unsigned long CollectiveBroadcast::GetReductionPeriod(proc_t processCount,
+                                                          unsigned int spreadFactor)
+    {
+      // As in PhasedBroadcast, the depth of a tree where each node has spreadFactor children;
+      // a value takes that many steps to go up and as many to come back down.
+      unsigned long treeDepth = 0;
+      proc_t noSeenToThisDepth = 1;
+      proc_t noAtCurrentDepth = 1;
+      while (noSeenToThisDepth < processCount)
+      {
+        ++treeDepth;
+        noAtCurrentDepth *= spreadFactor;
+        noSeenToThisDepth += noAtCurrentDepth;
+      }
+      return treeDepth > 0 ?
+        2 * treeDepth :
+        1;
+    }
+
+    CollectiveBroadcast::~CollectiveBroadcast()
+    {
+      int finalized;
+      MPI_Finalized(&finalized);
+      if (finalized)
+      {
+        return;
+      }
+      // A collective can't be cancelled, so let it finish.
+      if (request != MPI_REQUEST_NULL)
+      {
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+      }
+      if (opCreated)
+      {
+        MPI_Op_free(&op);
+      }
+    }
+
+    void CollectiveBroadcast::PreReceive()
+    {
+      if (request != MPI_REQUEST_NULL)
+      {
+        int done;
+        HEMELB_MPI_CALL(MPI_Test, (&request, &done, MPI_STATUS_IGNORE));
+      }
+    }
+
+    void CollectiveBroadcast::PostReceive()
+    {
+      if (!opCreated)
+      {
+        reduction = GetReduction();
+        HEMELB_MPI_CALL(MPI_Op_create, (reduction.function, 1, &op));
+        opCreated = true;
+
+        MPI_Aint lowerBound, extent;
+        HEMELB_MPI_CALL(MPI_Type_get_extent, (reduction.type, &lowerBound, &extent));
+        sendBuffer.resize(extent * reduction.count);
+        receiveBuffer.resize(extent * reduction.count);
+      }
+
+      // The request may already have been completed by PreReceive.
+      if (reducing)
+      {
+        Wait();
+      }
+
+      if (!SendsToParentOnStep(mSimState->Get0IndexedTimeStep()))
+      {
+        return;
+      }
+
+      PostSendToParent(0);
+
+      std::memcpy(&sendBuffer[0], reduction.upwards, sendBuffer.size());
+      HEMELB_MPI_CALL(MPI_Iallreduce, (&sendBuffer[0], &receiveBuffer[0], reduction.count,
+                                       reduction.type, op, mNet->GetCommunicator(), &request));
+      reducing = true;
+    }
+
+    void CollectiveBroadcast::Wait()
+    {
+      HEMELB_MPI_CALL(MPI_Wait, (&request, MPI_STATUS_IGNORE));
+      reducing = false;
+      std::memcpy(reduction.downwards, &receiveBuffer[0], receiveBuffer.size());
+      Effect();
+    }
+  }
+}
@@ -0,0 +1,136 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_COLLECTIVEBROADCAST_H
+#define HEMELB_NET_COLLECTIVEBROADCAST_H
+
+#include <vector>
+
+#include "net/IteratedAction.h"
+#include "net/net.h"
+#include "lb/SimulationState.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * CollectiveBroadcast - an alternative to PhasedBroadcastRegular for actors that combine a
+     * fixed-size value from every process and pass the result back to all of them.
+     *
+     * Rather than sending messages up and down a tree over several time steps, the local
+     * values are combined by one MPI_Iallreduce, with an operation given by the derived class.
+     * The reduction is started at the end of a step, progresses while the next step streams and
+     * collides, and is completed at the end of that step. So the result is only one step old,
+     * however many processes there are.
+     *
+     * Working out the local value usually means a pass over the lattice, so a reduction is only
+     * started once every round trip of the phased broadcast this replaces (see
+     * GetReductionPeriod). The monitoring then costs the same per step as with the tree.
+     *
+     * The derived class implements the same hooks as for a phased broadcast, with the same
+     * meanings, so can be written to work with either (see StabilityTester):
+     *  - PostSendToParent(0), to put this process's value in the upwards buffer,
+     *  - Effect(), to use the combined value, which has been put in the downwards buffer,
+     * and also GetReduction, to say what the buffers are and how to combine them. The other
+     * hooks of a phased broadcast are never called.
+     *
+     * MPI works on copies of the buffers, so the derived class may use them at any time.
+     */
+    class CollectiveBroadcast : public IteratedAction
+    {
+      public:
+        /**
+         * The value reduced.
+         */
+        struct Reduction
+        {
+            //! This process's value.
+            const void* upwards;
+            //! Where to put the combined value.
+            void* downwards;
+            int count;
+            MPI_Datatype type;
+            //! Combines values, as for MPI_Op_create. Must be commutative.
+            MPI_User_function* function;
+        };
+
+        /**
+         * Takes the same arguments as the phased broadcasts, though there is no tree to
+         * spread.
+         */
+        CollectiveBroadcast(Net* net, const lb::SimulationState* simState, unsigned int spreadFactor);
+
+        virtual ~CollectiveBroadcast();
+
+        /**
+         * Nudge the reduction along before the mid-domain sites are collided.
+         */
+        void PreReceive();
+
+        /**
+         * Finish and apply the last step's reduction, if there was one, and start one with this
+         * step's value if it is time to.
+         */
+        void PostReceive();
+
+        /**
+         * Whether PostSendToParent will be called on a (0-indexed) time step, e.g. so that the
+         * local value can be prepared for it during the step.
+         */
+        bool SendsToParentOnStep(LatticeTimeStep step) const
+        {
+          return step % reductionPeriod == 0;
+        }
+
+        /**
+         * The number of steps between reductions: the round trip length of a
+         * PhasedBroadcastRegular<> over the same processes, or 1 if there is only one process.
+         * @param processCount
+         * @param spreadFactor the number of children of each node of the broadcast tree
+         * @return
+         */
+        static unsigned long GetReductionPeriod(proc_t processCount, unsigned int spreadFactor);
+
+      protected:
+        /**
+         * Describe the value to reduce. Called once, before the first reduction.
+         */
+        virtual Reduction GetReduction() = 0;
+
+        /**
+         * Work out this process's value, in the upwards buffer.
+         */
+        virtual void PostSendToParent(unsigned long splayNumber)
+        {
+        }
+
+        /**
+         * Use the combined value in the downwards buffer.
+         */
+        virtual void Effect()
+        {
+        }
+
+        Net* mNet;
+        const lb::SimulationState* mSimState;
+
+      private:
+        void Wait();
+
+        const unsigned long reductionPeriod;
+        Reduction reduction;
+        MPI_Op op;
+        bool opCreated;
+        MPI_Request request;
+        //! Whether a reduction has been started and not yet applied.
+        bool reducing;
+        std::vector<char> sendBuffer;
+        std::vector<char> receiveBuffer;
+    };
+  }
+}
+
+#endif /* HEMELB_NET_COLLECTIVEBROADCAST_H */
@@ -9,6 +9,7 @@
 
 //#include "units.h"
 //#include "net/mpi.h"
+#include <map>
 #include <vector>
 #include "net/MpiError.h"
 #include <boost/shared_ptr.hpp>
@@ -88,6 +89,13 @@ namespace hemelb
          */
         MpiCommunicator Duplicate() const;
 
+        /**
+         * Split the communicator into the ranks that can share memory, i.e. those on each node
+         * - see MPI_COMM_SPLIT_TYPE. Ranks keep their relative order.
+         * @return The communicator of the ranks on this node.
+         */
+        MpiCommunicator SplitShared() const;
+
         template <typename T>
         void Broadcast(T& val, const int root) const;
         template <typename T>
@@ -111,12 +119,32 @@ namespace hemelb
         template <typename T>
         std::vector<T> Scatter(const std::vector<T>& vals, const size_t n, const int root) const;
 
+        template <typename T>
+        std::vector<T> GatherV(const std::vector<T>& vals, const int root) const;
+
         template <typename T>
         std::vector<T> AllGather(const T& val) const;
 
         template <typename T>
         std::vector<T> AllToAll(const std::vector<T>& vals) const;
 
+        /**
+         * Send each vector to its rank and receive whatever other ranks send here, without
+         * knowing in advance which ranks those are. Only the ranks that exchange data are
+         * contacted (a "non-blocking consensus": synchronous sends, then a non-blocking
+         * barrier once they have all been matched) so, unlike an AllToAll of counts first, the
+         * cost doesn't grow with the communicator size.
+         *
+         * Throws if a vector is too long to send as one message.
+         *
+         * @param sends the data for each rank; empty vectors are not sent
+         * @param tag a tag not used by any other messages in flight on this communicator
+         * @return the data received, by source rank
+         */
+        template <typename T>
+        std::map<int, std::vector<T> > SparseExchange(const std::map<int, std::vector<T> >& sends,
+                                                     int tag) const;
+
         template <typename T>
         void Send(const T& val, int dest, int tag=0) const;
         template <typename T>
@@ -6,6 +6,7 @@
 #ifndef HEMELB_NET_MPICOMMUNICATOR_HPP
 #define HEMELB_NET_MPICOMMUNICATOR_HPP
 
+#include <limits>
 #include "net/MpiDataType.h"
 #include "net/MpiConstness.h"
 
@@ -105,6 +106,32 @@ namespace hemelb
       return ans;
     }
 
+    template<typename T>
+    std::vector<T> MpiCommunicator::GatherV(const std::vector<T>& vals, const int root) const
+    {
+      const int count = vals.size();
+      const std::vector<int> counts = Gather(count, root);
+
+      std::vector<T> ans;
+      std::vector<int> displacements;
+      if (Rank() == root)
+      {
+        displacements.resize(Size(), 0);
+        for (int rank = 1; rank < Size(); ++rank)
+        {
+          displacements[rank] = displacements[rank - 1] + counts[rank - 1];
+        }
+        ans.resize(displacements.back() + counts.back());
+      }
+      HEMELB_MPI_CALL(
+          MPI_Gatherv,
+          (MpiConstCast(vals.data()), count, MpiDataType<T>(),
+              ans.data(), counts.data(), displacements.data(), MpiDataType<T>(),
+              root, *this)
+      );
+      return ans;
+    }
+
     template <typename T>
     T MpiCommunicator::Scatter(const std::vector<T>& vals, const int root) const {
       T ans;
@@ -159,6 +186,75 @@ namespace hemelb
       return ans;
     }
 
+    template <typename T>
+    std::map<int, std::vector<T> > MpiCommunicator::SparseExchange(const std::map<int, std::vector<T> >& sends,
+                                                                   int tag) const
+    {
+      std::vector<MPI_Request> sendRequests;
+      for (typename std::map<int, std::vector<T> >::const_iterator send = sends.begin(); send != sends.end();
+          ++send)
+      {
+        if (send->second.empty())
+        {
+          continue;
+        }
+        if (send->second.size() > std::size_t(std::numeric_limits<int>::max()))
+        {
+          throw Exception() << "Too many values (" << send->second.size()
+              << ") to send to rank " << send->first << " in one message";
+        }
+        sendRequests.push_back(MPI_REQUEST_NULL);
+        HEMELB_MPI_CALL(
+            MPI_Issend,
+            (MpiConstCast(&send->second[0]), int(send->second.size()), MpiDataType<T>(),
+             send->first, tag, *this, &sendRequests.back())
+        );
+      }
+
+      // Receive until every process has had all its sends matched, which is when the barrier
+      // completes.
+      std::map<int, std::vector<T> > received;
+      MPI_Request barrier = MPI_REQUEST_NULL;
+      bool barrierDone = false;
+      while (!barrierDone)
+      {
+        int arrived;
+        MPI_Status status;
+        HEMELB_MPI_CALL(MPI_Iprobe, (MPI_ANY_SOURCE, tag, *this, &arrived, &status));
+        if (arrived)
+        {
+          int count;
+          HEMELB_MPI_CALL(MPI_Get_count, (&status, MpiDataType<T>(), &count));
+          std::vector<T>& values = received[status.MPI_SOURCE];
+          values.resize(count);
+          HEMELB_MPI_CALL(
+              MPI_Recv,
+              (&values[0], count, MpiDataType<T>(), status.MPI_SOURCE, tag, *this, MPI_STATUS_IGNORE)
+          );
+        }
+
+        if (barrier == MPI_REQUEST_NULL)
+        {
+          int sendsDone;
+          HEMELB_MPI_CALL(
+              MPI_Testall,
+              (sendRequests.size(), sendRequests.data(), &sendsDone, MPI_STATUSES_IGNORE)
+          );
+          if (sendsDone)
+          {
+            HEMELB_MPI_CALL(MPI_Ibarrier, (*this, &barrier));
+          }
+        }
+        else
+        {
+          int done;
+          HEMELB_MPI_CALL(MPI_Test, (&barrier, &done, MPI_STATUS_IGNORE));
+          barrierDone = done;
+        }
+      }
+      return received;
+    }
+
     template <typename T>
     void MpiCommunicator::Send(const T& val, int dest, int tag) const
     {
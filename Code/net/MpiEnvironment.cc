@@ -19,7 +19,19 @@ namespace hemelb
     {
       if (!Initialized())
       {
+#ifdef HEMELB_USE_OPENMP
+        // Only the main thread makes MPI calls; the other threads just do LB work.
+        int provided;
+        HEMELB_MPI_CALL(MPI_Init_thread, (&argc, &argv, MPI_THREAD_FUNNELED, &provided));
+        if (provided < MPI_THREAD_FUNNELED)
+        {
+          MPI_Finalize();
+          throw Exception() << "MPI library only provides thread support level " << provided
+              << ", but HemeLB built with OpenMP needs at least MPI_THREAD_FUNNELED";
+        }
+#else
         HEMELB_MPI_CALL(MPI_Init, (&argc, &argv));
+#endif
         HEMELB_MPI_CALL(MPI_Comm_set_errhandler, (MPI_COMM_WORLD, MPI_ERRORS_RETURN));
         doesOwnMpi = true;
       }
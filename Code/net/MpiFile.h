@@ -55,10 +55,28 @@ namespace hemelb
         template<typename T>
         void ReadAt(MPI_Offset offset, std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
 
+        /**
+         * Starts a collective read with MPI_File_iread_at_all. Every rank of the communicator
+         * must start it (with an empty buffer if it has nothing to read), and the buffer must
+         * be left alone until the request completes.
+         * @return the request to complete
+         */
+        template<typename T>
+        MPI_Request IReadAtAll(MPI_Offset offset, std::vector<T>& buffer);
+
         template<typename T>
         void Write(const std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
         template<typename T>
         void WriteAt(MPI_Offset offset, const std::vector<T>& buffer, MPI_Status* stat = MPI_STATUS_IGNORE);
+
+        /**
+         * Starts a collective write with MPI_File_iwrite_at_all. Every rank of the communicator
+         * must start it (with an empty buffer if it has nothing to write), and the buffer must
+         * be left alone until the request completes.
+         * @return the request to complete
+         */
+        template<typename T>
+        MPI_Request IWriteAtAll(MPI_Offset offset, const std::vector<T>& buffer);
       protected:
         MpiFile(const MpiCommunicator& parentComm, MPI_File fh);
 
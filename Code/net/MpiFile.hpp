@@ -31,6 +31,17 @@ namespace hemelb
       );
     }
 
+    template<typename T>
+    MPI_Request MpiFile::IReadAtAll(MPI_Offset offset, std::vector<T>& buffer)
+    {
+      MPI_Request request;
+      HEMELB_MPI_CALL(
+          MPI_File_iread_at_all,
+          (*filePtr, offset, buffer.data(), buffer.size(), MpiDataType<T>(), &request)
+      );
+      return request;
+    }
+
     template<typename T>
     void MpiFile::Write(const std::vector<T>& buffer, MPI_Status* stat)
     {
@@ -48,6 +59,16 @@ namespace hemelb
       );
 
     }
+    template<typename T>
+    MPI_Request MpiFile::IWriteAtAll(MPI_Offset offset, const std::vector<T>& buffer)
+    {
+      MPI_Request request;
+      HEMELB_MPI_CALL(
+          MPI_File_iwrite_at_all,
+          (*filePtr, offset, MpiConstCast(buffer.data()), buffer.size(), MpiDataType<T>(), &request)
+      );
+      return request;
+    }
 
   }
 }
@@ -0,0 +1,165 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include "net/PersistentHaloExchange.h"
+#include "net/MpiError.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    PersistentHaloExchange::PersistentHaloExchange(MPI_Comm communicator,
+                                                   const std::vector<proc_t>& neighbours,
+                                                   const std::vector<int>& counts,
+                                                   MPI_Datatype type,
+                                                   const std::vector<MPI_Datatype>& receiveTypes) :
+        neighbours(neighbours), counts(counts), type(type), receiveTypes(receiveTypes), current(0)
+    {
+      // Keep the ranks as they are: the buffers are laid out for them. Every rank of the
+      // communicator must take part, and one with no neighbours must still say that its
+      // (empty) edges are weighted, like everyone else's.
+      const int degree = neighbours.size();
+      const int* weights = degree == 0 ?
+        MPI_WEIGHTS_EMPTY :
+        counts.data();
+      HEMELB_MPI_CALL(MPI_Dist_graph_create_adjacent,
+                      (communicator, degree, neighbours.data(), weights,
+                       degree, neighbours.data(), weights,
+                       MPI_INFO_NULL, 0, &graphCommunicator));
+
+      MPI_Aint lowerBound, extent;
+      HEMELB_MPI_CALL(MPI_Type_get_extent, (type, &lowerBound, &extent));
+      std::size_t offset = 0;
+      for (int neighbour = 0; neighbour < degree; ++neighbour)
+      {
+        offsets.push_back(offset);
+        offset += counts[neighbour] * extent;
+      }
+    }
+
+    PersistentHaloExchange::~PersistentHaloExchange()
+    {
+      int finalized;
+      MPI_Finalized(&finalized);
+      if (finalized)
+      {
+        return;
+      }
+      for (std::vector<Requests>::iterator requests = requestSets.begin(); requests != requestSets.end();
+          ++requests)
+      {
+        FreeRequests(requests->receives);
+        FreeRequests(requests->sends);
+      }
+      for (std::vector<MPI_Datatype>::iterator receiveType = receiveTypes.begin();
+          receiveType != receiveTypes.end(); ++receiveType)
+      {
+        MPI_Type_free(&*receiveType);
+      }
+      MPI_Comm_free(&graphCommunicator);
+    }
+
+    void PersistentHaloExchange::StartReceives(void* receiveBuffer)
+    {
+      for (current = 0; current < requestSets.size(); ++current)
+      {
+        if (requestSets[current].receiveBuffer == receiveBuffer)
+        {
+          break;
+        }
+      }
+
+      if (current == requestSets.size())
+      {
+        if (requestSets.size() == MaxRequestSets)
+        {
+          // The buffers are moving about; start again.
+          for (std::vector<Requests>::iterator requests = requestSets.begin();
+              requests != requestSets.end(); ++requests)
+          {
+            FreeRequests(requests->receives);
+            FreeRequests(requests->sends);
+          }
+          requestSets.clear();
+          current = 0;
+        }
+
+        requestSets.push_back(Requests());
+        Requests& requests = requestSets.back();
+        requests.receiveBuffer = receiveBuffer;
+        requests.sendBuffer = NULL;
+        requests.receives.resize(neighbours.size());
+        for (std::size_t neighbour = 0; neighbour < neighbours.size(); ++neighbour)
+        {
+          if (receiveTypes.empty())
+          {
+            HEMELB_MPI_CALL(MPI_Recv_init,
+                            (static_cast<char*>(receiveBuffer) + offsets[neighbour], counts[neighbour], type,
+                             neighbours[neighbour], 0, graphCommunicator, &requests.receives[neighbour]));
+          }
+          else
+          {
+            HEMELB_MPI_CALL(MPI_Recv_init,
+                            (receiveBuffer, 1, receiveTypes[neighbour],
+                             neighbours[neighbour], 0, graphCommunicator, &requests.receives[neighbour]));
+          }
+        }
+      }
+
+      if (!requestSets[current].receives.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Startall,
+                        (requestSets[current].receives.size(), requestSets[current].receives.data()));
+      }
+    }
+
+    void PersistentHaloExchange::StartSends(const void* sendBuffer)
+    {
+      Requests& requests = requestSets[current];
+      if (requests.sendBuffer != sendBuffer)
+      {
+        FreeRequests(requests.sends);
+        requests.sendBuffer = sendBuffer;
+        requests.sends.resize(neighbours.size());
+        for (std::size_t neighbour = 0; neighbour < neighbours.size(); ++neighbour)
+        {
+          // MPI-2 bindings take a non-const send buffer.
+          HEMELB_MPI_CALL(MPI_Send_init,
+                          (const_cast<char*>(static_cast<const char*>(sendBuffer)) + offsets[neighbour],
+                           counts[neighbour], type, neighbours[neighbour], 0, graphCommunicator,
+                           &requests.sends[neighbour]));
+        }
+      }
+
+      if (!requests.sends.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Startall, (requests.sends.size(), requests.sends.data()));
+      }
+    }
+
+    void PersistentHaloExchange::Wait()
+    {
+      Requests& requests = requestSets[current];
+      if (!requests.receives.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Waitall,
+                        (requests.receives.size(), requests.receives.data(), MPI_STATUSES_IGNORE));
+      }
+      if (!requests.sends.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Waitall, (requests.sends.size(), requests.sends.data(), MPI_STATUSES_IGNORE));
+      }
+    }
+
+    void PersistentHaloExchange::FreeRequests(std::vector<MPI_Request>& requests)
+    {
+      for (std::vector<MPI_Request>::iterator request = requests.begin(); request != requests.end(); ++request)
+      {
+        MPI_Request_free(&*request);
+      }
+      requests.clear();
+    }
+  }
+}
@@ -0,0 +1,103 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_PERSISTENTHALOEXCHANGE_H
+#define HEMELB_NET_PERSISTENTHALOEXCHANGE_H
+
+#include <vector>
+
+#include "units.h"
+#include "net/mpi.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Exchanges a fixed pattern of contiguous blocks with a fixed set of neighbours, every
+     * step, with persistent requests on a distributed-graph communicator.
+     *
+     * The pattern is given once, at construction: each neighbour's block is counts[i] items,
+     * and the blocks for successive neighbours follow each other in both the send and the
+     * receive buffer. The buffers themselves are given on each use. They are expected to
+     * alternate between a couple of places (as LatticeData's do, when the old and new
+     * distributions are swapped), so the requests for each receive buffer seen are kept.
+     *
+     * Alternatively, each neighbour's received items can be described by a datatype, relative
+     * to the start of the receive buffer, so that they're scattered straight to where they're
+     * needed rather than unpacked afterwards.
+     *
+     * Compared with posting the same messages through a Net, there's no per-step bookkeeping
+     * or request creation, and the MPI library is told the communication graph.
+     */
+    class PersistentHaloExchange
+    {
+      public:
+        /**
+         * Collective over the communicator: every rank must construct one, even if it has no
+         * neighbours.
+         *
+         * @param communicator the communicator the neighbours' ranks are on
+         * @param neighbours the ranks exchanged with, each both a source and destination
+         * @param counts the number of items exchanged with each
+         * @param type the type of the items
+         * @param receiveTypes if not empty, the committed type of the whole of each neighbour's
+         * received data, which the exchange takes ownership of
+         */
+        PersistentHaloExchange(MPI_Comm communicator, const std::vector<proc_t>& neighbours,
+                               const std::vector<int>& counts, MPI_Datatype type,
+                               const std::vector<MPI_Datatype>& receiveTypes = std::vector<MPI_Datatype>());
+
+        ~PersistentHaloExchange();
+
+        /**
+         * Start receiving into the buffer.
+         */
+        void StartReceives(void* receiveBuffer);
+
+        /**
+         * Start sending from the buffer. Must follow StartReceives and precede Wait.
+         */
+        void StartSends(const void* sendBuffer);
+
+        /**
+         * Wait for all the started sends and receives to complete.
+         */
+        void Wait();
+
+      private:
+        PersistentHaloExchange(const PersistentHaloExchange&) = delete;
+        PersistentHaloExchange& operator=(const PersistentHaloExchange&) = delete;
+
+        //! The requests for one receive buffer, and the last send buffer used with it.
+        struct Requests
+        {
+            void* receiveBuffer;
+            const void* sendBuffer;
+            std::vector<MPI_Request> receives;
+            std::vector<MPI_Request> sends;
+        };
+
+        //! After this many receive buffers, the requests are freed and made again.
+        static const std::size_t MaxRequestSets = 4;
+
+        static void FreeRequests(std::vector<MPI_Request>& requests);
+
+        MPI_Comm graphCommunicator;
+        std::vector<proc_t> neighbours;
+        std::vector<int> counts;
+        //! The offsets of the neighbours' blocks, in bytes.
+        std::vector<std::size_t> offsets;
+        MPI_Datatype type;
+        std::vector<MPI_Datatype> receiveTypes;
+
+        std::vector<Requests> requestSets;
+        //! The index of the set used by the current exchange.
+        std::size_t current;
+    };
+  }
+}
+
+#endif /* HEMELB_NET_PERSISTENTHALOEXCHANGE_H */
@@ -168,6 +168,21 @@ namespace hemelb
           }
         }
 
+        /**
+         * Whether PostSendToParent will be called on a (0-indexed) time step, e.g. so that the
+         * local value can be prepared for it during the step.
+         */
+        bool SendsToParentOnStep(LatticeTimeStep step)
+        {
+          const unsigned long cycle = base::GetTreeDepth() > 0 ?
+            step % base::GetRoundTripLength() :
+            0;
+          const unsigned long firstAscent = base::GetFirstAscending();
+          unsigned long sendOverlap;
+          return goUp && cycle >= firstAscent
+              && base::GetSendParentOverlap(cycle - firstAscent, &sendOverlap);
+        }
+
         /**
          * Returns the number of the iteration, as an integer between inclusive-0 and
          * exclusive-2 * (the tree depth)
@@ -9,6 +9,7 @@
 
 #include "net/mixins/pointpoint/CoalescePointPoint.h"
 #include "net/mixins/pointpoint/ImmediatePointPoint.h"
+#include "net/mixins/pointpoint/PersistentPointPoint.h"
 #include "net/mixins/pointpoint/SeparatedPointPoint.h"
 #include "net/mixins/StoringNet.h"
 #include "net/mixins/gathers/SeparatedGathers.h"
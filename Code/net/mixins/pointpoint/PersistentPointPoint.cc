@@ -0,0 +1,184 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+
+#include "net/mixins/pointpoint/PersistentPointPoint.h"
+
+namespace hemelb
+{
+  namespace net
+  {
+    namespace
+    {
+      bool IsSameRequest(const SimpleRequest& left, const SimpleRequest& right)
+      {
+        return left.Pointer == right.Pointer && left.Count == right.Count && left.Type == right.Type
+            && left.Rank == right.Rank;
+      }
+
+      void FreeRequests(std::vector<MPI_Request>& requests)
+      {
+        for (std::vector<MPI_Request>::iterator request = requests.begin(); request != requests.end();
+            ++request)
+        {
+          MPI_Request_free(&*request);
+        }
+        requests.clear();
+      }
+    }
+
+    void PersistentPointPoint::ReceivePointToPoint()
+    {
+      activeReceives = Start(receiveProcessorComms, receivePatterns, false);
+    }
+
+    void PersistentPointPoint::SendPointToPoint()
+    {
+      activeSends = Start(sendProcessorComms, sendPatterns, true);
+    }
+
+    std::size_t PersistentPointPoint::Start(const std::map<proc_t, ProcComms>& comms,
+                                            std::vector<Pattern>& patterns, bool send)
+    {
+      current.clear();
+      for (std::map<proc_t, ProcComms>::const_iterator it = comms.begin(); it != comms.end(); ++it)
+      {
+        current.insert(current.end(), it->second.begin(), it->second.end());
+      }
+      if (current.empty())
+      {
+        return NoPattern;
+      }
+
+      std::size_t match = 0;
+      for (; match < patterns.size(); ++match)
+      {
+        const std::vector<SimpleRequest>& recorded = patterns[match].requests;
+        if (recorded.size() == current.size()
+            && std::equal(current.begin(), current.end(), recorded.begin(), IsSameRequest))
+        {
+          break;
+        }
+      }
+
+      if (match == patterns.size())
+      {
+        // New: remember it, in place of the least recently used if need be, and post the
+        // requests as usual.
+        if (patterns.size() < MaxPatterns)
+        {
+          patterns.push_back(Pattern());
+        }
+        else
+        {
+          match = 0;
+          for (std::size_t pattern = 1; pattern < patterns.size(); ++pattern)
+          {
+            if (patterns[pattern].lastUsed < patterns[match].lastUsed)
+            {
+              match = pattern;
+            }
+          }
+          FreeRequests(patterns[match].persistentRequests);
+        }
+        patterns[match].requests = current;
+        patterns[match].lastUsed = ++patternsUsed;
+
+        for (std::vector<SimpleRequest>::iterator request = current.begin(); request != current.end();
+            ++request)
+        {
+          requests.push_back(MPI_REQUEST_NULL);
+          if (send)
+          {
+            HEMELB_MPI_CALL(MPI_Isend,
+                            (request->Pointer, request->Count, request->Type, request->Rank, 10, communicator,
+                             &requests.back()));
+          }
+          else
+          {
+            HEMELB_MPI_CALL(MPI_Irecv,
+                            (request->Pointer, request->Count, request->Type, request->Rank, 10, communicator,
+                             &requests.back()));
+          }
+        }
+        return NoPattern;
+      }
+
+      Pattern& pattern = patterns[match];
+      pattern.lastUsed = ++patternsUsed;
+      if (pattern.persistentRequests.empty())
+      {
+        pattern.persistentRequests.resize(pattern.requests.size());
+        for (std::size_t ii = 0; ii < pattern.requests.size(); ++ii)
+        {
+          const SimpleRequest& request = pattern.requests[ii];
+          if (send)
+          {
+            HEMELB_MPI_CALL(MPI_Send_init,
+                            (request.Pointer, request.Count, request.Type, request.Rank, 10, communicator,
+                             &pattern.persistentRequests[ii]));
+          }
+          else
+          {
+            HEMELB_MPI_CALL(MPI_Recv_init,
+                            (request.Pointer, request.Count, request.Type, request.Rank, 10, communicator,
+                             &pattern.persistentRequests[ii]));
+          }
+        }
+      }
+      HEMELB_MPI_CALL(MPI_Startall, (pattern.persistentRequests.size(), &pattern.persistentRequests[0]));
+      return match;
+    }
+
+    void PersistentPointPoint::WaitPattern(std::vector<Pattern>& patterns, std::size_t& active)
+    {
+      if (active != NoPattern)
+      {
+        std::vector<MPI_Request>& persistentRequests = patterns[active].persistentRequests;
+        HEMELB_MPI_CALL(MPI_Waitall,
+                        (persistentRequests.size(), &persistentRequests[0], MPI_STATUSES_IGNORE));
+        active = NoPattern;
+      }
+    }
+
+    /*!
+     Free the allocated data.
+     */
+    PersistentPointPoint::~PersistentPointPoint()
+    {
+      int finalized;
+      MPI_Finalized(&finalized);
+      if (finalized)
+      {
+        return;
+      }
+      for (std::vector<Pattern>::iterator pattern = sendPatterns.begin(); pattern != sendPatterns.end();
+          ++pattern)
+      {
+        FreeRequests(pattern->persistentRequests);
+      }
+      for (std::vector<Pattern>::iterator pattern = receivePatterns.begin(); pattern != receivePatterns.end();
+          ++pattern)
+      {
+        FreeRequests(pattern->persistentRequests);
+      }
+    }
+
+    void PersistentPointPoint::WaitPointToPoint()
+    {
+      if (!requests.empty())
+      {
+        HEMELB_MPI_CALL(MPI_Waitall, (requests.size(), &requests[0], MPI_STATUSES_IGNORE));
+        requests.clear();
+      }
+      WaitPattern(receivePatterns, activeReceives);
+      WaitPattern(sendPatterns, activeSends);
+
+      receiveProcessorComms.clear();
+      sendProcessorComms.clear();
+    }
+  }
+}
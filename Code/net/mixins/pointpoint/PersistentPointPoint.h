@@ -0,0 +1,77 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#ifndef HEMELB_NET_MIXINS_POINTPOINT_PERSISTENTPOINTPOINT_H
+#define HEMELB_NET_MIXINS_POINTPOINT_PERSISTENTPOINTPOINT_H
+#include "net/BaseNet.h"
+#include "net/mixins/StoringNet.h"
+namespace hemelb
+{
+  namespace net
+  {
+    /**
+     * Point-to-point comms that replay repeated patterns of requests with persistent MPI
+     * requests.
+     *
+     * The sends (and, separately, the receives) of each dispatch are compared with the
+     * patterns seen recently. The first time a pattern is seen it's sent as by
+     * SeparatedPointPoint; the second time, persistent requests are made for it, and from
+     * then on they are just started. Anything else - a new pattern, a buffer that has moved -
+     * simply doesn't match, so falls back to the first case. A few patterns are kept, since the
+     * requests made vary over a cycle of steps (e.g. for the phased broadcasts).
+     */
+    class PersistentPointPoint : public virtual StoringNet
+    {
+
+      public:
+        PersistentPointPoint(const MpiCommunicator& comms) :
+            BaseNet(comms), StoringNet(comms), patternsUsed(0), activeSends(NoPattern),
+                activeReceives(NoPattern)
+        {
+        }
+        ~PersistentPointPoint();
+
+        void WaitPointToPoint();
+
+      protected:
+        void ReceivePointToPoint();
+        void SendPointToPoint();
+
+      private:
+        struct Pattern
+        {
+            std::vector<SimpleRequest> requests;
+            //! Empty until the pattern has been seen twice.
+            std::vector<MPI_Request> persistentRequests;
+            unsigned long lastUsed;
+        };
+
+        //! How many patterns of each of sends and receives are kept.
+        static const std::size_t MaxPatterns = 8;
+        static const std::size_t NoPattern = -1;
+
+        /**
+         * Start the requests stored, returning the index of the pattern started, or NoPattern
+         * if they were posted as ordinary non-blocking requests.
+         */
+        std::size_t Start(const std::map<proc_t, ProcComms>& comms, std::vector<Pattern>& patterns,
+                          bool send);
+        void WaitPattern(std::vector<Pattern>& patterns, std::size_t& active);
+
+        std::vector<Pattern> sendPatterns;
+        std::vector<Pattern> receivePatterns;
+        unsigned long patternsUsed;
+
+        std::size_t activeSends;
+        std::size_t activeReceives;
+        //! Requests posted for patterns not (yet) replayed.
+        std::vector<MPI_Request> requests;
+        //! Reused to gather up the requests stored.
+        std::vector<SimpleRequest> current;
+    };
+  }
+}
+
+#endif
@@ -71,6 +71,12 @@ namespace hemelb
             return location < siteCount;
           }
 
+          bool ReadAt(site_t index)
+          {
+            location = index;
+            return location < siteCount;
+          }
+
           hemelb::util::Vector3D<site_t> GetPosition() const
           {
             return gridPositions[location];
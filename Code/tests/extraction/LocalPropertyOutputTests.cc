@@ -6,10 +6,13 @@
 
 #include <string>
 #include <cstdio>
+#include <cstring>
+#include <zlib.h>
 
 #include <catch2/catch.hpp>
 
 #include "io/formats/extraction.h"
+#include "io/formats/offset.h"
 #include "io/writers/xdr/XdrMemReader.h"
 #include "extraction/PropertyOutputFile.h"
 #include "extraction/OutputField.h"
@@ -107,6 +110,85 @@ namespace hemelb
 	}
 
       }
+
+      // Check a geometry-once file: the headers are as before but for the version, then come
+      // the flags, the coordinates and the timesteps without them.
+      void CheckGeometryOnceWriting(DummyDataSource* datasource, bool native, FILE* file) {
+	constexpr size_t headersLength = io::formats::extraction::MainHeaderLength + 0x30;
+	char headers[headersLength];
+	REQUIRE(headersLength == std::fread(headers, 1, headersLength, file));
+	io::writers::xdr::XdrMemReader headerReader(headers, headersLength);
+	uint32_t word;
+	headerReader.read(word);
+	headerReader.read(word);
+	headerReader.read(word);
+	REQUIRE(word == io::formats::extraction::GeometryOnceVersionNumber);
+
+	long siteCount = 0;
+	datasource->Reset();
+	while (datasource->ReadNext()) {
+	  ++siteCount;
+	}
+
+	// Flags, coordinates and one timestep of pressure and velocity.
+	size_t expectedSize = 4 + 12 * siteCount + 8 + 16 * siteCount;
+	auto contentsBuffer = std::make_unique<char[]>(expectedSize);
+	REQUIRE(expectedSize == std::fread(contentsBuffer.get(), 1, expectedSize + 1, file));
+	io::writers::xdr::XdrMemReader reader(contentsBuffer.get(), expectedSize);
+
+	uint32_t flags;
+	reader.read(flags);
+	const bool littleEndian = native && io::formats::extraction::IsLittleEndian();
+	REQUIRE(flags == (littleEndian ? uint32_t(io::formats::extraction::LittleEndianFields) : 0U));
+
+	datasource->Reset();
+	while (datasource->ReadNext()) {
+	  unsigned x, y, z;
+	  reader.read(x);
+	  reader.read(y);
+	  reader.read(z);
+	  LatticeVector grid = datasource->GetPosition();
+	  REQUIRE(grid.x == x);
+	  REQUIRE(grid.y == y);
+	  REQUIRE(grid.z == z);
+	}
+
+	uint64_t readTimestep;
+	reader.read(readTimestep);
+	REQUIRE(readTimestep == 0);
+
+	const char* nativeValues = contentsBuffer.get() + reader.GetPosition();
+	auto readValue = [&]() {
+	  float value;
+	  if (native) {
+	    std::memcpy(&value, nativeValues, sizeof(value));
+	    nativeValues += sizeof(value);
+	  } else {
+	    reader.read(value);
+	  }
+	  return value;
+	};
+	datasource->Reset();
+	while (datasource->ReadNext()) {
+	  float pressure = readValue();
+	  REQUIRE(apprx(datasource->GetPressure()) == (REFERENCE_PRESSURE_mmHg + double{pressure}));
+	  auto velocity = datasource->GetVelocity();
+	  REQUIRE(apprx(velocity.x) == readValue());
+	  REQUIRE(apprx(velocity.y) == readValue());
+	  REQUIRE(apprx(velocity.z) == readValue());
+	}
+      }
+
+      std::vector<char> ReadWholeFile(const char* fn) {
+	auto file = open_as_closing(fn, "r");
+	REQUIRE(file != nullptr);
+	std::vector<char> contents;
+	char c;
+	while (std::fread(&c, 1, 1, file.get()) == 1) {
+	  contents.push_back(c);
+	}
+	return contents;
+      }
     }
 
     TEST_CASE_METHOD(helpers::HasCommsTestFixture, "LocalPropertyOutput") {
@@ -209,8 +291,9 @@ namespace hemelb
 	// Now going to write the body.
 	// Create some pseudo-random data
 	simpleDataSource->FillFields();
-	// Write it
+	// Write it, and make sure it's reached the file
 	propertyWriter->Write(0);
+	propertyWriter->Flush();
 
 	CheckDataWriting(simpleDataSource.get(), 0, writtenFile.get());
 
@@ -220,6 +303,7 @@ namespace hemelb
 	propertyWriter->Write(10);
 	// This SHOULD write
 	propertyWriter->Write(100);
+	propertyWriter->Flush();
 
 	// The previous call to CheckDataWriting() sets the EOF indicator in writtenFile,
 	// the previous call to Write() ought to unset it but it isn't working properly in
@@ -230,6 +314,105 @@ namespace hemelb
       }
 
 
+      SECTION("WriteGeometryOnce") {
+	for (bool native : { false, true }) {
+	  std::remove(tempXtrFileName);
+	  std::remove(tempOffFileName);
+	  simpleOutFile.geometryOnce = true;
+	  simpleOutFile.nativeFields = native;
+	  simpleDataSource->FillFields();
+	  {
+	    extraction::LocalPropertyOutput propertyWriter(*simpleDataSource, &simpleOutFile, Comms());
+	    propertyWriter.Write(0);
+	  }
+	  auto writtenFile = open_as_closing(simpleOutFile.filename.c_str(), "r");
+	  REQUIRE(writtenFile != nullptr);
+	  CheckGeometryOnceWriting(simpleDataSource.get(), native, writtenFile.get());
+	}
+      }
+
+      SECTION("WriteCompressed") {
+	// Pressure may be rounded by up to 1/100; the quantum is 1/64.
+	simpleOutFile.fields[0].tolerance = 0.01;
+	simpleOutFile.geometryOnce = true;
+	simpleOutFile.compressFields = true;
+	std::vector<std::vector<float> > written;
+	{
+	  extraction::LocalPropertyOutput propertyWriter(*simpleDataSource, &simpleOutFile, Comms());
+	  for (unsigned long timestep : { 0, 100 }) {
+	    simpleDataSource->FillFields();
+	    propertyWriter.Write(timestep);
+	    written.emplace_back();
+	    simpleDataSource->Reset();
+	    while (simpleDataSource->ReadNext()) {
+	      written.back().push_back(simpleDataSource->GetPressure() - REFERENCE_PRESSURE_mmHg);
+	      written.back().push_back(simpleDataSource->GetVelocity().x);
+	      written.back().push_back(simpleDataSource->GetVelocity().y);
+	      written.back().push_back(simpleDataSource->GetVelocity().z);
+	    }
+	  }
+	}
+	const std::size_t siteCount = written[0].size() / 4;
+
+	auto contents = ReadWholeFile(tempXtrFileName);
+	io::writers::xdr::XdrMemReader headerReader(contents.data(), contents.size());
+	uint32_t word;
+	for (int i = 0; i < 3; ++i) {
+	  headerReader.read(word);
+	}
+	REQUIRE(word == io::formats::extraction::GeometryOnceVersionNumber);
+	const std::size_t flagsPosition = io::formats::extraction::MainHeaderLength + 0x30;
+	io::writers::xdr::XdrMemReader flagsReader(contents.data() + flagsPosition, 4);
+	flagsReader.read(word);
+	REQUIRE(word == io::formats::extraction::CompressedFields);
+
+	// One rank, so each timestep has a start and an end.
+	auto offsetContents = ReadWholeFile(tempOffFileName);
+	REQUIRE(offsetContents.size() == io::formats::offset::HeaderLength + 2 * 2 * 8);
+	io::writers::xdr::XdrMemReader offsetReader(offsetContents.data(), offsetContents.size());
+	offsetReader.read(word);
+	offsetReader.read(word);
+	offsetReader.read(word);
+	REQUIRE(word == io::formats::offset::PerTimestepVersionNumber);
+	offsetReader.read(word);
+	uint64_t offsets[4];
+	for (auto& offset : offsets) {
+	  offsetReader.read(offset);
+	}
+	REQUIRE(offsets[0] == flagsPosition + 4 + 12 * siteCount);
+	REQUIRE(offsets[1] == offsets[2]);
+	REQUIRE(offsets[3] == contents.size());
+
+	for (unsigned iTS = 0; iTS < 2; ++iTS) {
+	  const char* chunk = contents.data() + offsets[2 * iTS];
+	  io::writers::xdr::XdrMemReader timestepReader(chunk, 8);
+	  uint64_t timestep;
+	  timestepReader.read(timestep);
+	  REQUIRE(timestep == 100 * iTS);
+
+	  // The values compress, and come back within the tolerance.
+	  const uLong compressedLength = offsets[2 * iTS + 1] - offsets[2 * iTS] - 8;
+	  uLongf valuesLength = 16 * siteCount;
+	  REQUIRE(compressedLength < valuesLength);
+	  std::vector<char> values(valuesLength);
+	  REQUIRE(uncompress(reinterpret_cast<Bytef*>(values.data()), &valuesLength,
+			     reinterpret_cast<const Bytef*>(chunk + 8), compressedLength) == Z_OK);
+	  REQUIRE(valuesLength == 16 * siteCount);
+
+	  io::writers::xdr::XdrMemReader valueReader(values);
+	  for (std::size_t i = 0; i < written[iTS].size(); ++i) {
+	    float value;
+	    valueReader.read(value);
+	    if (i % 4 == 0) {
+	      REQUIRE(std::abs(value - written[iTS][i]) <= 0.01);
+	      REQUIRE(value * 64 == std::round(value * 64));
+	    } else {
+	      REQUIRE(apprx(written[iTS][i]) == value);
+	    }
+	  }
+	}
+      }
+
       // tearDown
 
       // remove temporary files
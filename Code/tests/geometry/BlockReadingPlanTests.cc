@@ -0,0 +1,68 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "geometry/needs/BlockReadingPlan.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    using namespace hemelb::geometry;
+
+    TEST_CASE("BlockReadingPlanTests") {
+      // 100 bytes, with some empty blocks, including the last.
+      std::vector<unsigned int> bytesPerBlock { 10, 0, 20, 30, 10, 0, 30, 0 };
+
+      auto requireChunk = [](const BlockReadingPlan& plan, proc_t reader, unsigned int round,
+			     site_t expectedFirst, site_t expectedEnd) {
+	site_t first, end;
+	plan.GetChunk(reader, round, first, end);
+	REQUIRE(first == expectedFirst);
+	REQUIRE(end == expectedEnd);
+      };
+
+      SECTION("Readers get contiguous runs of about equal bytes") {
+	BlockReadingPlan plan(bytesPerBlock, 2, 35);
+
+	REQUIRE(plan.GetReaderForEachBlock() == std::vector<proc_t>({ 0, 0, 0, 0, 1, 1, 1, 1 }));
+	REQUIRE(plan.GetBlockOffset(3) == 30);
+	REQUIRE(plan.GetBlockOffset(8) == 100);
+
+	REQUIRE(plan.GetRoundCount() == 2);
+	requireChunk(plan, 0, 0, 0, 3);
+	requireChunk(plan, 0, 1, 3, 4);
+	requireChunk(plan, 1, 0, 4, 6);
+	requireChunk(plan, 1, 1, 6, 8);
+	requireChunk(plan, 1, 2, 0, 0);
+      }
+
+      SECTION("Blocks longer than a chunk get a chunk each") {
+	BlockReadingPlan plan(bytesPerBlock, 1, 5);
+
+	REQUIRE(plan.GetRoundCount() == 5);
+	// Empty blocks go with the block before.
+	requireChunk(plan, 0, 0, 0, 2);
+	requireChunk(plan, 0, 1, 2, 3);
+	requireChunk(plan, 0, 2, 3, 4);
+	requireChunk(plan, 0, 3, 4, 6);
+	requireChunk(plan, 0, 4, 6, 8);
+      }
+
+      SECTION("Spare readers read nothing") {
+	BlockReadingPlan plan(std::vector<unsigned int>({ 0, 0 }), 3, 35);
+
+	REQUIRE(plan.GetReaderForEachBlock() == std::vector<proc_t>({ 0, 0 }));
+	REQUIRE(plan.GetRoundCount() == 1);
+	requireChunk(plan, 0, 0, 0, 2);
+	requireChunk(plan, 1, 0, 0, 0);
+	requireChunk(plan, 2, 0, 0, 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,68 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <fstream>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "Exception.h"
+#include "geometry/decomposition/CollisionCosts.h"
+#include "geometry/decomposition/DecompositionWeights.h"
+
+#include "tests/helpers/FolderTestFixture.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    using namespace hemelb::geometry::decomposition;
+
+    TEST_CASE_METHOD(helpers::FolderTestFixture, "CollisionCostsTests") {
+      SECTION("The defaults are the built-in weights") {
+	CollisionCosts costs;
+	REQUIRE(costs.GetCost(0) == 1.0);
+	for (unsigned type = 0; type < CollisionCosts::CollisionTypeCount; ++type)
+	{
+	  REQUIRE(costs.GetCost(type) * hemelbSiteWeights[0] == Approx(hemelbSiteWeights[type]));
+	}
+      }
+
+      SECTION("Measured costs are relative to bulk fluid and survive a round trip") {
+	// Wall sites take three times as long as fluid, and there are no outlet sites.
+	std::vector<double> seconds { 2.0, 0.6, 0.1, 0.0, 0.05, 0.0 };
+	std::vector<site_t> sites { 1000, 100, 25, 0, 5, 0 };
+	CollisionCosts measured = CollisionCosts::FromTimes(seconds, sites);
+	REQUIRE(measured.GetCost(0) == 1.0);
+	REQUIRE(measured.GetCost(1) == Approx(3.0));
+	REQUIRE(measured.GetCost(2) == Approx(2.0));
+	REQUIRE(measured.GetCost(4) == Approx(5.0));
+	REQUIRE(measured.GetWeight(0) == CollisionCosts::FluidWeight);
+	REQUIRE(measured.GetWeight(1) == 3 * CollisionCosts::FluidWeight);
+
+	MoveToTempdir();
+	measured.Write("costs.txt");
+	CollisionCosts read = CollisionCosts::Read("costs.txt");
+	for (unsigned type : { 0u, 1u, 2u, 4u })
+	{
+	  REQUIRE(read.GetCost(type) == Approx(measured.GetCost(type)));
+	}
+	// The unmeasured type is left at its guess.
+	REQUIRE(read.GetCost(3) == CollisionCosts().GetCost(3));
+      }
+
+      SECTION("Bad profiles are rejected") {
+	MoveToTempdir();
+	std::ofstream("costs.txt") << "1 -2.0\n";
+	REQUIRE_THROWS_AS(CollisionCosts::Read("costs.txt"), Exception);
+	REQUIRE_THROWS_AS(CollisionCosts::Read("missing.txt"), Exception);
+
+	std::vector<double> seconds(CollisionCosts::CollisionTypeCount, 1.0);
+	std::vector<site_t> sites(CollisionCosts::CollisionTypeCount, 0);
+	REQUIRE_THROWS_AS(CollisionCosts::FromTimes(seconds, sites), Exception);
+      }
+    }
+  }
+}
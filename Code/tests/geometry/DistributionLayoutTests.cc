@@ -0,0 +1,82 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <vector>
+#include <catch2/catch.hpp>
+
+#include "geometry/DistributionLayout.h"
+#include "lb/lattices/D3Q19.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    using namespace hemelb::geometry;
+
+    // Check that every (site, direction) pair maps to a distinct slot in
+    // [0, GetLocalDistributionCount()) and that the compile-time and
+    // run-time index calculations agree.
+    template<typename Layout>
+    void CheckLayoutIsBijective(site_t siteCount)
+    {
+      typedef lb::lattices::D3Q19 Lattice;
+      Layout layout;
+      layout.Initialise(siteCount, Lattice::NUMVECTORS);
+
+      REQUIRE(layout.GetPaddedSiteCount() >= siteCount);
+      REQUIRE(layout.GetPaddedSiteCount() % Layout::SiteGranularity == 0);
+      REQUIRE(layout.GetLocalDistributionCount() == layout.GetPaddedSiteCount() * Lattice::NUMVECTORS);
+
+      std::vector<int> seen(layout.GetLocalDistributionCount(), 0);
+      for (site_t site = 0; site < layout.GetPaddedSiteCount(); ++site)
+      {
+	for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+	{
+	  site_t index = layout.GetIndex(site, direction);
+	  REQUIRE(index == layout.template GetIndex<Lattice>(site, direction));
+	  REQUIRE(index >= 0);
+	  REQUIRE(index < layout.GetLocalDistributionCount());
+	  ++seen[index];
+	}
+      }
+      for (site_t index = 0; index < layout.GetLocalDistributionCount(); ++index)
+      {
+	REQUIRE(seen[index] == 1);
+      }
+    }
+
+    TEST_CASE("DistributionLayoutTests") {
+      SECTION("AosIsBijectiveAndLegacy") {
+	CheckLayoutIsBijective<AOS>(13);
+
+	AOS layout;
+	layout.Initialise(13, lb::lattices::D3Q19::NUMVECTORS);
+	REQUIRE(layout.GetPaddedSiteCount() == 13);
+	REQUIRE(layout.GetIndex(5, 7) == 5 * lb::lattices::D3Q19::NUMVECTORS + 7);
+      }
+
+      SECTION("SoaIsBijective") {
+	CheckLayoutIsBijective<SOA>(13);
+
+	// Same direction at consecutive sites is adjacent in memory.
+	SOA layout;
+	layout.Initialise(13, lb::lattices::D3Q19::NUMVECTORS);
+	REQUIRE(layout.GetIndex(6, 3) == layout.GetIndex(5, 3) + 1);
+      }
+
+      SECTION("AosoaIsBijective") {
+	CheckLayoutIsBijective<AOSOA>(13);
+
+	// Within a tile, the same direction at consecutive sites is adjacent.
+	AOSOA layout;
+	layout.Initialise(13, lb::lattices::D3Q19::NUMVECTORS);
+	REQUIRE(layout.GetIndex(1, 3) == layout.GetIndex(0, 3) + 1);
+	// Whole tiles are contiguous.
+	REQUIRE(layout.GetIndex(AOSOA::SiteGranularity, 0)
+		== AOSOA::SiteGranularity * lb::lattices::D3Q19::NUMVECTORS);
+      }
+    }
+  }
+}
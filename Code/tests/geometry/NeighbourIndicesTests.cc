@@ -0,0 +1,96 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <vector>
+#include <catch2/catch.hpp>
+
+#include "geometry/NeighbourIndices.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    using namespace hemelb::geometry;
+
+    // Fill a lookup with a mix of near, far, rubbish and send buffer
+    // targets, overwriting some of them, and check that it reads back
+    // what was last set.
+    template<typename Indices>
+    void CheckLookupReadsBack(Indices& indices)
+    {
+      const site_t slotCount = 100000;
+      const site_t rubbishIndex = slotCount;
+      const site_t targetCount = rubbishIndex + 1 + 500;
+
+      std::vector<site_t> expected(slotCount, rubbishIndex);
+      indices.Initialise(slotCount, rubbishIndex, targetCount);
+      for (site_t slot = 0; slot < slotCount; ++slot)
+      {
+	site_t target;
+	switch (slot % 5)
+	{
+	  case 0:
+	    target = (slot + 19) % slotCount;
+	    break;
+	  case 1:
+	    target = (slot * 7919) % slotCount;
+	    break;
+	  case 2:
+	    target = rubbishIndex;
+	    break;
+	  case 3:
+	    target = rubbishIndex + 1 + slot % 500;
+	    break;
+	  default:
+	    // Left at the initial value.
+	    continue;
+	}
+	indices.Set(slot, target);
+	expected[slot] = target;
+      }
+      // Later passes (like the receive lookup) overwrite some entries.
+      for (site_t slot = 3; slot < slotCount; slot += 10)
+      {
+	indices.Set(slot, slot - 1);
+	expected[slot] = slot - 1;
+      }
+      for (site_t slot = 0; slot < slotCount; slot += 10)
+      {
+	indices.Set(slot, rubbishIndex + 1 + slot % 500);
+	expected[slot] = rubbishIndex + 1 + slot % 500;
+      }
+      indices.Finalise();
+
+      for (site_t slot = 0; slot < slotCount; ++slot)
+      {
+	REQUIRE(indices.Get(slot) == expected[slot]);
+      }
+    }
+
+    TEST_CASE("NeighbourIndicesTests") {
+      SECTION("Wide") {
+	WIDE indices;
+	CheckLookupReadsBack(indices);
+      }
+
+      SECTION("Compact") {
+	COMPACT indices;
+	CheckLookupReadsBack(indices);
+	REQUIRE(indices.GetByteCount() == 100000 * sizeof(COMPACT::Index));
+
+	REQUIRE_THROWS_AS(indices.Initialise(10, 10, site_t(1) << 33), Exception);
+      }
+
+      SECTION("BlockRelative") {
+	BLOCKRELATIVE indices;
+	CheckLookupReadsBack(indices);
+
+	// Only the far and send buffer links should be escaped.
+	REQUIRE(indices.GetEscapedCount() > 0);
+	REQUIRE(indices.GetEscapedCount() < 100000 / 2);
+      }
+    }
+  }
+}
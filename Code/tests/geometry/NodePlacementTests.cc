@@ -0,0 +1,53 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "geometry/decomposition/NodePlacement.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    using namespace hemelb::geometry::decomposition;
+
+    TEST_CASE("NodePlacementTests") {
+      // Two nodes of two ranks each.
+      std::vector<std::vector<proc_t> > ranksOnEachNode(2);
+      ranksOnEachNode[0].push_back(0);
+      ranksOnEachNode[0].push_back(1);
+      ranksOnEachNode[1].push_back(2);
+      ranksOnEachNode[1].push_back(3);
+      NodePlacement placement(ranksOnEachNode);
+
+      SECTION("Heavily linked parts share a node") {
+	// Parts 0 and 2 share most of their links, as do 1 and 3.
+	placement.AddLinks(0, 2, 100);
+	placement.AddLinks(1, 3, 60);
+	placement.AddLinks(3, 1, 40);
+	placement.AddLinks(0, 1, 10);
+	placement.AddLinks(2, 3, 5);
+
+	std::vector<proc_t> unplaced { 0, 1, 2, 3 };
+	REQUIRE(placement.CountLinksBetweenNodes(unplaced) == 200);
+
+	std::vector<proc_t> rankForEachPart = placement.Place();
+	REQUIRE(rankForEachPart == std::vector<proc_t>({ 0, 2, 1, 3 }));
+	REQUIRE(placement.CountLinksBetweenNodes(rankForEachPart) == 15);
+      }
+
+      SECTION("Unlinked parts still all get a rank") {
+	placement.AddLinks(1, 2, 1);
+
+	std::vector<proc_t> rankForEachPart = placement.Place();
+	// Part 0 seeds the first node but has no links, so part 1 seeds it again.
+	REQUIRE(rankForEachPart == std::vector<proc_t>({ 0, 1, 2, 3 }));
+	REQUIRE(placement.CountLinksBetweenNodes(rankForEachPart) == 1);
+      }
+    }
+  }
+}
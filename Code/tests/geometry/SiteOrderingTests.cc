@@ -0,0 +1,66 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <catch2/catch.hpp>
+
+#include "geometry/SiteOrdering.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    using namespace hemelb::geometry;
+
+    // Check that the ordering maps a power-of-two cube onto
+    // [0, size^3) one-to-one and return the coordinates in key order.
+    template<typename Ordering>
+    std::vector<util::Vector3D<site_t> > GetCoordsInKeyOrder(site_t size)
+    {
+      const util::Vector3D<site_t> extents(size);
+      std::vector<util::Vector3D<site_t> > coordsByKey(size * size * size, util::Vector3D<site_t>(-1));
+      for (site_t x = 0; x < size; ++x)
+	for (site_t y = 0; y < size; ++y)
+	  for (site_t z = 0; z < size; ++z)
+	  {
+	    const std::uint64_t key = Ordering::GetKey(util::Vector3D<site_t>(x, y, z), extents);
+	    REQUIRE(key < coordsByKey.size());
+	    REQUIRE(coordsByKey[key].x == -1);
+	    coordsByKey[key] = util::Vector3D<site_t>(x, y, z);
+	  }
+      return coordsByKey;
+    }
+
+    TEST_CASE("SiteOrderingTests") {
+      SECTION("NaturalIsIdOrder") {
+	const util::Vector3D<site_t> extents(3, 4, 5);
+	REQUIRE(NATURAL::GetKey(util::Vector3D<site_t>(2, 1, 3), extents) == (2 * 4 + 1) * 5 + 3);
+      }
+
+      SECTION("MortonIsBijectiveAndInterleaved") {
+	GetCoordsInKeyOrder<MORTON>(8);
+	// x is the most significant bit of each triple, and the
+	// coordinates' high bits come first.
+	REQUIRE(MORTON::GetKey(util::Vector3D<site_t>(1, 0, 0), util::Vector3D<site_t>(8)) == 4u);
+	REQUIRE(MORTON::GetKey(util::Vector3D<site_t>(0, 0, 4), util::Vector3D<site_t>(8)) == 1u << 6);
+      }
+
+      SECTION("HilbertStepsBetweenFaceNeighbours") {
+	for (site_t size = 2; size <= 16; size *= 2)
+	{
+	  const std::vector<util::Vector3D<site_t> > coords = GetCoordsInKeyOrder<HILBERT>(size);
+	  for (std::size_t i = 1; i < coords.size(); ++i)
+	  {
+	    const site_t distance = std::abs(coords[i].x - coords[i - 1].x) + std::abs(coords[i].y - coords[i - 1].y)
+		+ std::abs(coords[i].z - coords[i - 1].z);
+	    REQUIRE(distance == 1);
+	  }
+	}
+      }
+    }
+  }
+}
@@ -85,6 +85,19 @@ namespace hemelb
 	REQUIRE(manager.GetNeedsForProc(0).front() == 43);
       }
 
+      SECTION("TestShareNeedsSparselyOneProc") {
+	// The sparse exchange uses MPI directly, so needs a real net.
+	auto realNet = net::Net(Comms());
+	auto sparseManager = NeighbouringDataManager{*latDat, data, realNet, true};
+	// Both fluid sites, so on this proc.
+	sparseManager.RegisterNeededSite(43);
+	sparseManager.RegisterNeededSite(86);
+
+	sparseManager.ShareNeeds();
+
+	REQUIRE(sparseManager.GetNeedsForProc(0) == std::vector<site_t>({43, 86}));
+      }
+
       SECTION("TestShareConstantDataOneProc") {
 	// As for ShareNeeds test, set up the site as needed from itself.
 	std::vector<int> countOfNeedsToZeroFromZero;
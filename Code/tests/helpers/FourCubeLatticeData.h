@@ -53,7 +53,7 @@ namespace hemelb
       void SetFOld(site_t site, distribn_t* fOldIn)
       {
 	for (Direction direction = 0; direction < LatticeType::NUMVECTORS; ++direction) {
-            *GetFOld(site * LatticeType::NUMVECTORS + direction) = fOldIn[direction];
+            LatticeData::SetFOld(GetDistributionIndex<LatticeType>(site, direction), direction, fOldIn[direction]);
           }
         }
 
@@ -0,0 +1,165 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
+
+#include "lb/CollisionSchedule.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    using namespace hemelb::lb;
+
+    // Stands in for a streamer, recording what it was asked to do.
+    template<int Id>
+    struct RecordingCollision
+    {
+	RecordingCollision(std::vector<std::string>& calls) :
+	  calls(calls)
+	{
+	}
+
+	void Record(const CollisionRange& range)
+	{
+	  calls.push_back(std::to_string(Id) + ":" + std::to_string(range.first) + "+"
+	      + std::to_string(range.count));
+	}
+
+	std::vector<std::string>& calls;
+    };
+
+    TEST_CASE("CollisionScheduleTests") {
+      SECTION("MergeDropsEmptyAndJoinsContiguous") {
+	CollisionRanges ranges;
+	ranges.push_back(CollisionRange(0, 0, 10));
+	ranges.push_back(CollisionRange(0, 10, 5));
+	ranges.push_back(CollisionRange(1, 15, 0));
+	ranges.push_back(CollisionRange(1, 15, 3));
+	// Same type, but not contiguous.
+	ranges.push_back(CollisionRange(1, 20, 3));
+	ranges.push_back(CollisionRange(2, 23, 1));
+	MergeCollisionRanges(ranges);
+
+	REQUIRE(ranges.size() == 4);
+	REQUIRE(ranges[0].collision == 0);
+	REQUIRE(ranges[0].first == 0);
+	REQUIRE(ranges[0].count == 15);
+	REQUIRE(ranges[1].first == 15);
+	REQUIRE(ranges[1].count == 3);
+	REQUIRE(ranges[2].first == 20);
+	REQUIRE(ranges[3].collision == 2);
+      }
+
+      SECTION("SplitRespectsGranularity") {
+	CollisionRanges ranges;
+	ranges.push_back(CollisionRange(3, 2, 20));
+	SplitCollisionRanges(ranges, 8, 4);
+
+	// Cuts at 8, 16, then the rest.
+	REQUIRE(ranges.size() == 3);
+	REQUIRE(ranges[0].first == 2);
+	REQUIRE(ranges[0].count == 6);
+	REQUIRE(ranges[1].first == 8);
+	REQUIRE(ranges[1].count == 8);
+	REQUIRE(ranges[2].first == 16);
+	REQUIRE(ranges[2].count == 6);
+	for (const CollisionRange& range : ranges)
+	{
+	  REQUIRE(range.collision == 3);
+	}
+      }
+
+      SECTION("RunDispatchesInListOrder") {
+	std::vector<std::string> calls;
+	CollisionSchedule<RecordingCollision<0>, RecordingCollision<1>, RecordingCollision<2> >
+	    schedule(new RecordingCollision<0>(calls),
+		     new RecordingCollision<1>(calls),
+		     new RecordingCollision<2>(calls));
+
+	CollisionRanges ranges;
+	ranges.push_back(CollisionRange(2, 30, 1));
+	ranges.push_back(CollisionRange(0, 0, 10));
+	ranges.push_back(CollisionRange(1, 10, 20));
+	ranges.push_back(CollisionRange(0, 31, 4));
+
+	schedule.SetTimed(true);
+	schedule.Run(ranges, [](auto& collision, const CollisionRange& range)
+	{
+	  collision.Record(range);
+	});
+
+	const std::vector<std::string> expected = { "2:30+1", "0:0+10", "1:10+20", "0:31+4" };
+	REQUIRE(calls == expected);
+	for (const CollisionRange& range : ranges)
+	{
+	  REQUIRE(range.seconds >= 0.0);
+	}
+      }
+
+      SECTION("ThreadPiecesCoverTheRange") {
+#ifdef HEMELB_USE_OPENMP
+	const int maxThreads = omp_get_max_threads();
+	omp_set_num_threads(3);
+#endif
+	const site_t first = 5;
+	const site_t count = 100;
+	const site_t granularity = 4;
+	for (bool threaded : { false, true }) {
+	  std::mutex mutex;
+	  std::vector<std::pair<site_t, site_t> > pieces;
+	  ForEachThreadSiteRange(first, count, threaded, granularity, [&](site_t pieceFirst, site_t pieceCount)
+	  {
+	    std::lock_guard<std::mutex> lock(mutex);
+	    pieces.push_back(std::make_pair(pieceFirst, pieceCount));
+	  });
+	  std::sort(pieces.begin(), pieces.end());
+
+	  INFO("Threaded " << threaded);
+	  REQUIRE(!pieces.empty());
+	  REQUIRE(pieces.front().first == first);
+	  site_t next = first;
+	  for (const auto& piece : pieces) {
+	    REQUIRE(piece.first == next);
+	    REQUIRE(piece.second > 0);
+	    // Only the start of the whole range may be off the granularity.
+	    if (piece.first != first) {
+	      REQUIRE(piece.first % granularity == 0);
+	    }
+	    next = piece.first + piece.second;
+	  }
+	  REQUIRE(next == first + count);
+#ifdef HEMELB_USE_OPENMP
+	  REQUIRE(pieces.size() == (threaded ? 3U : 1U));
+#else
+	  REQUIRE(pieces.size() == 1);
+#endif
+	}
+#ifdef HEMELB_USE_OPENMP
+	omp_set_num_threads(maxThreads);
+#endif
+      }
+
+      SECTION("ThreadPieceExceptionsReachTheCaller") {
+	for (bool threaded : { false, true }) {
+	  INFO("Threaded " << threaded);
+	  REQUIRE_THROWS_AS(ForEachThreadSiteRange(0, 100, threaded, 1, [](site_t, site_t)
+	  {
+	    throw std::runtime_error("piece failed");
+	  }), std::runtime_error);
+	}
+      }
+    }
+  }
+}
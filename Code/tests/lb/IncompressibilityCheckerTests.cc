@@ -142,6 +142,27 @@ namespace hemelb
 	REQUIRE(apprx(10.0) == incompChecker.GetGlobalLargestVelocityMagnitude());
       }
 
+      SECTION("IncompressibilityCheckerCollective") {
+	lb::IncompressibilityChecker<net::CollectiveBroadcast> incompChecker(latDat,
+									     net.get(),
+									     simState.get(),
+									     *cache,
+									     *timings,
+									     10.0);
+
+	// The first reduction is only started at the end of the first step...
+	AdvanceActorOneTimeStep(incompChecker);
+	REQUIRE(!incompChecker.AreDensitiesAvailable());
+
+	// ... and used at the end of the next.
+	AdvanceActorOneTimeStep(incompChecker);
+	REQUIRE(incompChecker.AreDensitiesAvailable());
+	REQUIRE(apprx(smallestDefaultDensity) == incompChecker.GetGlobalSmallestDensity());
+	REQUIRE(apprx(largestDefaultDensity) == incompChecker.GetGlobalLargestDensity());
+	REQUIRE(incompChecker.IsDensityDiffWithinRange());
+	REQUIRE(apprx(largestDefaultVelocityMagnitude) == incompChecker.GetGlobalLargestVelocityMagnitude());
+      }
+
     }
   }
 }
@@ -11,6 +11,7 @@
 #include "lb/kernels/rheologyModels/RheologyModels.h"
 #include "lb/kernels/momentBasis/DHumieresD3Q15MRTBasis.h"
 #include "lb/kernels/momentBasis/DHumieresD3Q19MRTBasis.h"
+#include "lb/lattices/D3Q15i.h"
 
 #include "tests/lb/LbTestsHelper.h"
 
@@ -140,6 +141,88 @@ namespace hemelb
       }
     }
 
+    template <typename T>
+    struct BatchTester : public helpers::FourCubeBasedTestFixture {
+      using KERNEL = T;
+      using LATTICE = typename KERNEL::LatticeType;
+      static constexpr auto NV = LATTICE::NUMVECTORS;
+      using HYDRO = lb::kernels::HydroVars<KERNEL>;
+      using BATCH = lb::kernels::HydroVarsBatch<LATTICE>;
+      static constexpr auto WIDTH = BATCH::WIDTH;
+      const distribn_t allowedError = 1e-10;
+      KERNEL kernel;
+      BatchTester() : kernel(initParams) {
+      }
+    };
+
+    // Only MRT's hydrodynamic variables carry more than the base ones.
+    template <typename HYDRO>
+    void RequireSameMoments(const HYDRO&, const HYDRO&, distribn_t) {
+    }
+
+    template <typename BASIS>
+    void RequireSameMoments(const lb::kernels::HydroVars<lb::kernels::MRT<BASIS> >& expected,
+			    const lb::kernels::HydroVars<lb::kernels::MRT<BASIS> >& actual,
+			    distribn_t allowedError) {
+      for (unsigned moment = 0; moment < BASIS::NUM_KINETIC_MOMENTS; ++moment) {
+	REQUIRE(Approx(expected.m_neq[moment]).margin(allowedError) == actual.m_neq[moment]);
+      }
+    }
+
+    TEMPLATE_TEST_CASE_METHOD(BatchTester, "KernelTests - batched collision matches the single-site version", "[lb][kernels]",
+			      lb::kernels::LBGK<lb::lattices::D3Q15>,
+			      lb::kernels::LBGK<lb::lattices::D3Q15i>,
+			      lb::kernels::TRT<lb::lattices::D3Q19>,
+			      lb::kernels::MRT<lb::kernels::momentBasis::DHumieresD3Q15MRTBasis>) {
+      using Fix = BatchTester<TestType>;
+      auto apprx = [this](double x) {
+	return Approx(x).margin(this->allowedError);
+      };
+
+      // A different, asymmetric distribution at each lane.
+      distribn_t f[Fix::WIDTH][Fix::NV];
+      typename Fix::BATCH batch;
+      for (unsigned lane = 0; lane < Fix::WIDTH; ++lane) {
+	LbTestsHelper::InitialiseAnisotropicTestData<typename Fix::LATTICE>(lane, f[lane]);
+	for (Direction ii = 0; ii < Fix::NV; ++ii) {
+	  batch.f[ii][lane] = f[lane][ii];
+	}
+      }
+
+      this->kernel.CalculateDensityMomentumFeqBatch(batch);
+      this->kernel.CollideBatch(this->lbmParams, batch);
+
+      for (unsigned lane = 0; lane < Fix::WIDTH; ++lane) {
+	typename Fix::HYDRO hydroVars(f[lane]);
+	this->kernel.CalculateDensityMomentumFeq(hydroVars, lane);
+	this->kernel.Collide(this->lbmParams, hydroVars);
+
+	REQUIRE(apprx(hydroVars.density) == batch.density[lane]);
+	REQUIRE(apprx(hydroVars.momentum.x) == batch.momentumX[lane]);
+	REQUIRE(apprx(hydroVars.momentum.y) == batch.momentumY[lane]);
+	REQUIRE(apprx(hydroVars.momentum.z) == batch.momentumZ[lane]);
+	REQUIRE(apprx(hydroVars.velocity.x) == batch.velocityX[lane]);
+	REQUIRE(apprx(hydroVars.velocity.y) == batch.velocityY[lane]);
+	REQUIRE(apprx(hydroVars.velocity.z) == batch.velocityZ[lane]);
+	for (Direction ii = 0; ii < Fix::NV; ++ii) {
+	  REQUIRE(apprx(hydroVars.GetFEq()[ii]) == batch.f_eq[ii][lane]);
+	  REQUIRE(apprx(hydroVars.GetFNeq()[ii]) == batch.f_neq[ii][lane]);
+	  REQUIRE(apprx(hydroVars.GetFPostCollision()[ii]) == batch.fPostCollision[ii][lane]);
+	}
+
+	// The streamers get each lane back as a single-site HydroVars.
+	typename Fix::HYDRO copied(f[lane]);
+	this->kernel.CopyLaneTo(batch, lane, copied);
+	REQUIRE(copied.density == batch.density[lane]);
+	REQUIRE(copied.velocity.z == batch.velocityZ[lane]);
+	for (Direction ii = 0; ii < Fix::NV; ++ii) {
+	  REQUIRE(copied.GetFNeq()[ii] == batch.f_neq[ii][lane]);
+	  REQUIRE(copied.GetFPostCollision()[ii] == batch.fPostCollision[ii][lane]);
+	}
+	RequireSameMoments(hydroVars, copied, this->allowedError);
+      }
+    }
+
     TEST_CASE_METHOD(helpers::FourCubeBasedTestFixture, "LBGKNNCalculationsAndCollision") {
       using LATTICE = lb::lattices::D3Q15;
       static constexpr auto NV = LATTICE::NUMVECTORS;
@@ -0,0 +1,249 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#ifdef HEMELB_USE_OPENMP
+#include <omp.h>
+#endif
+
+#include "lb/lb.hpp"
+#include "lb/iolets/InOutLetCosine.h"
+#include "net/net.h"
+#include "reporting/Timers.h"
+#include "vis/Control.h"
+
+#include "tests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    // LbmTests
+    //
+    // Runs the whole LBM, as configured by the build, on the four
+    // cube. Unlike the streamer tests this goes through the storage,
+    // layout and streaming pattern chosen at build time, so it is the
+    // one to run under each HEMELB_DISTRIBUTION_STORAGE.
+    TEST_CASE_METHOD(helpers::FourCubeBasedTestFixture, "LbmTests") {
+      using LATTICE = lb::lattices::D3Q15;
+      constexpr auto NUMVECTORS = LATTICE::NUMVECTORS;
+
+      // The momentum at each site, from the current distributions.
+      auto getMomenta = [&]() {
+	std::vector<util::Vector3D<distribn_t> > momenta(latDat->GetLocalFluidSiteCount());
+	for (site_t site = 0; site < latDat->GetLocalFluidSiteCount(); ++site) {
+	  distribn_t density;
+	  LATTICE::CalculateDensityAndMomentum(latDat->GetSite(site).GetFOld<LATTICE>(),
+					       density,
+					       momenta[site].x,
+					       momenta[site].y,
+					       momenta[site].z);
+	}
+	return momenta;
+      };
+
+      SECTION("PoiseuilleFlow") {
+	// Drive the flow along the duct with a steady pressure difference.
+	const distribn_t densityDifference = 1e-3;
+	auto inlet = dynamic_cast<lb::iolets::InOutLetCosine*>(simConfig->GetInlets()[0]);
+	auto outlet = dynamic_cast<lb::iolets::InOutLetCosine*>(simConfig->GetOutlets()[0]);
+	inlet->SetDensityAmp(0.0);
+	inlet->SetDensityMean(1.0 + densityDifference / 2.0);
+	inlet->SetNormal(util::Vector3D<Dimensionless>(0, 0, 1));
+	outlet->SetDensityAmp(0.0);
+	outlet->SetDensityMean(1.0 - densityDifference / 2.0);
+	outlet->SetNormal(util::Vector3D<Dimensionless>(0, 0, -1));
+
+	net::Net net(Comms());
+	reporting::Timers timings(Comms());
+	lb::iolets::BoundaryValues inletValues(geometry::INLET_TYPE,
+					       latDat,
+					       simConfig->GetInlets(),
+					       simState.get(),
+					       Comms(),
+					       *unitConverter);
+	lb::iolets::BoundaryValues outletValues(geometry::OUTLET_TYPE,
+						latDat,
+						simConfig->GetOutlets(),
+						simState.get(),
+						Comms(),
+						*unitConverter);
+
+	lb::LBM<LATTICE> lbm(simConfig, &net, latDat, simState.get(), timings, nullptr);
+	vis::Control visControl(lbm.GetLbmParams()->StressType,
+				&net,
+				simState.get(),
+				lbm.GetPropertyCache(),
+				latDat,
+				timings[reporting::Timers::visualisation]);
+	lbm.Initialise(&visControl, &inletValues, &outletValues, unitConverter);
+
+	for (site_t site = 0; site < latDat->GetLocalFluidSiteCount(); ++site) {
+	  distribn_t fEq[NUMVECTORS];
+	  LATTICE::CalculateFeq(1.0, 0.0, 0.0, 0.0, fEq);
+	  latDat->SetFOld<LATTICE>(site, fEq);
+	}
+
+	auto runSteps = [&](unsigned steps) {
+	  for (unsigned step = 0; step < steps; ++step) {
+	    lbm.RequestComms();
+	    lbm.PreSend();
+	    lbm.PreReceive();
+	    net.Dispatch();
+	    lbm.PostReceive();
+	    lbm.EndIteration();
+	    simState->Increment();
+	  }
+	};
+
+	runSteps(2000);
+	const auto momenta = getMomenta();
+	runSteps(100);
+	const auto laterMomenta = getMomenta();
+
+	// The momentum along the duct, as j[plane][x][y].
+	distribn_t j[4][4][4];
+	distribn_t maxMomentum = 0.0;
+	for (site_t site = 0; site < latDat->GetLocalFluidSiteCount(); ++site) {
+	  const auto& location = latDat->GetSite(site).GetGlobalSiteCoords();
+	  j[location.z - 1][location.x - 1][location.y - 1] = momenta[site].z;
+	  maxMomentum = std::max(maxMomentum, momenta[site].z);
+	}
+	INFO("Greatest momentum " << maxMomentum);
+	REQUIRE(maxMomentum > 0.0);
+
+	// The flow is steady...
+	for (site_t site = 0; site < latDat->GetLocalFluidSiteCount(); ++site) {
+	  REQUIRE(laterMomenta[site].z == Approx(momenta[site].z).margin(1e-3 * maxMomentum));
+	}
+
+	// ...has the symmetry of the square cross section...
+	const distribn_t symmetryTolerance = 1e-4 * maxMomentum;
+	for (unsigned plane = 0; plane < 4; ++plane) {
+	  for (unsigned x = 0; x < 4; ++x) {
+	    for (unsigned y = 0; y < 4; ++y) {
+	      REQUIRE(j[plane][x][y] == Approx(j[plane][3 - x][y]).margin(symmetryTolerance));
+	      REQUIRE(j[plane][x][y] == Approx(j[plane][x][3 - y]).margin(symmetryTolerance));
+	      REQUIRE(j[plane][x][y] == Approx(j[plane][y][x]).margin(symmetryTolerance));
+	    }
+	  }
+	}
+
+	// ...is fastest in the middle and slowest by the walls...
+	for (unsigned plane = 1; plane < 3; ++plane) {
+	  REQUIRE(j[plane][1][1] > j[plane][0][1]);
+	  REQUIRE(j[plane][0][1] > j[plane][0][0]);
+	}
+
+	// ...and carries the same mass through every plane.
+	distribn_t flux[4] = { };
+	for (unsigned plane = 0; plane < 4; ++plane) {
+	  for (unsigned x = 0; x < 4; ++x) {
+	    for (unsigned y = 0; y < 4; ++y) {
+	      flux[plane] += j[plane][x][y];
+	    }
+	  }
+	}
+	for (unsigned plane = 1; plane < 4; ++plane) {
+	  REQUIRE(flux[plane] == Approx(flux[0]).epsilon(1e-2));
+	}
+      }
+
+#ifdef HEMELB_USE_OPENMP
+      SECTION("ThreadedMatchesSerial") {
+	// A bigger cube, so that there are ranges long enough to be
+	// shared between the threads.
+	delete latDat;
+	latDat = FourCubeLatticeData::Create(Comms(), 12);
+	const site_t siteCount = latDat->GetLocalFluidSiteCount();
+	REQUIRE(latDat->GetMidDomainCollisionCount(0) >= 256);
+
+	auto inlet = dynamic_cast<lb::iolets::InOutLetCosine*>(simConfig->GetInlets()[0]);
+	auto outlet = dynamic_cast<lb::iolets::InOutLetCosine*>(simConfig->GetOutlets()[0]);
+	inlet->SetDensityAmp(0.0);
+	inlet->SetDensityMean(1.0005);
+	inlet->SetNormal(util::Vector3D<Dimensionless>(0, 0, 1));
+	outlet->SetDensityAmp(0.0);
+	outlet->SetDensityMean(0.9995);
+	outlet->SetNormal(util::Vector3D<Dimensionless>(0, 0, -1));
+
+	// Run from rest on the given number of threads, filling the
+	// density and velocity caches on every step, and return the
+	// distributions followed by the cached densities and velocities.
+	auto run = [&](int threadCount) {
+	  omp_set_num_threads(threadCount);
+	  lb::SimulationState state(simState->GetTimeStepLength(), simState->GetTotalTimeSteps());
+	  net::Net net(Comms());
+	  reporting::Timers timings(Comms());
+	  lb::iolets::BoundaryValues inletValues(geometry::INLET_TYPE,
+						 latDat,
+						 simConfig->GetInlets(),
+						 &state,
+						 Comms(),
+						 *unitConverter);
+	  lb::iolets::BoundaryValues outletValues(geometry::OUTLET_TYPE,
+						  latDat,
+						  simConfig->GetOutlets(),
+						  &state,
+						  Comms(),
+						  *unitConverter);
+	  lb::LBM<LATTICE> lbm(simConfig, &net, latDat, &state, timings, nullptr);
+	  vis::Control visControl(lbm.GetLbmParams()->StressType,
+				  &net,
+				  &state,
+				  lbm.GetPropertyCache(),
+				  latDat,
+				  timings[reporting::Timers::visualisation]);
+	  lbm.Initialise(&visControl, &inletValues, &outletValues, unitConverter);
+	  auto& propertyCache = lbm.GetPropertyCache();
+	  propertyCache.densityCache.SetRefreshFlag();
+	  propertyCache.velocityCache.SetRefreshFlag();
+
+	  for (site_t site = 0; site < siteCount; ++site) {
+	    distribn_t fEq[NUMVECTORS];
+	    LATTICE::CalculateFeq(1.0, 0.0, 0.0, 0.0, fEq);
+	    latDat->SetFOld<LATTICE>(site, fEq);
+	  }
+	  for (unsigned step = 0; step < 20; ++step) {
+	    lbm.RequestComms();
+	    lbm.PreSend();
+	    lbm.PreReceive();
+	    net.Dispatch();
+	    lbm.PostReceive();
+	    lbm.EndIteration();
+	    state.Increment();
+	  }
+
+	  std::vector<distribn_t> results;
+	  for (site_t site = 0; site < siteCount; ++site) {
+	    const distribn_t* fOld = latDat->GetSite(site).GetFOld<LATTICE>();
+	    results.insert(results.end(), fOld, fOld + NUMVECTORS);
+	  }
+	  for (site_t site = 0; site < siteCount; ++site) {
+	    const auto& velocity = propertyCache.velocityCache.Get(site);
+	    results.push_back(propertyCache.densityCache.Get(site));
+	    results.push_back(velocity.x);
+	    results.push_back(velocity.y);
+	    results.push_back(velocity.z);
+	  }
+	  return results;
+	};
+
+	const int maxThreads = omp_get_max_threads();
+	const auto serial = run(1);
+	const auto threaded = run(4);
+	omp_set_num_threads(maxThreads);
+
+	// The pieces are cut on the layout's granularity, so each site
+	// is collided just as it is on one thread.
+	REQUIRE(threaded == serial);
+      }
+#endif
+    }
+  }
+}
@@ -0,0 +1,86 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <cmath>
+#include <limits>
+#include <catch2/catch.hpp>
+
+#include "lb/StabilityAccumulator.h"
+#include "lb/kernels/Kernels.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    TEST_CASE("StabilityAccumulatorTests") {
+      using LATTICE = lb::lattices::D3Q15;
+      using HYDRO = lb::kernels::HydroVars<lb::kernels::LBGK<LATTICE> >;
+
+      distribn_t f[LATTICE::NUMVECTORS];
+      for (unsigned l = 0; l < LATTICE::NUMVECTORS; ++l)
+      {
+	f[l] = LATTICE::EQMWEIGHTS[l];
+      }
+      HYDRO hydroVars(f);
+      for (unsigned l = 0; l < LATTICE::NUMVECTORS; ++l)
+      {
+	hydroVars.SetFPostCollision(l, f[l]);
+      }
+      hydroVars.density = 2.0;
+      hydroVars.momentum = util::Vector3D<distribn_t>(0.2, 0.0, 0.0);
+
+      lb::StabilityAccumulator accumulator(3);
+
+      SECTION("NothingRequested") {
+	REQUIRE(!accumulator.IsRequired());
+      }
+
+      SECTION("CatchesNegativeAndNaN") {
+	accumulator.RequestStabilityCheck();
+	REQUIRE(accumulator.IsRequired());
+	accumulator.Accumulate<LATTICE>(0, hydroVars);
+	REQUIRE(!accumulator.IsUnstable());
+
+	hydroVars.SetFPostCollision(4, -1e-3);
+	accumulator.Accumulate<LATTICE>(1, hydroVars);
+	REQUIRE(accumulator.IsUnstable());
+
+	accumulator.Reset();
+	REQUIRE(!accumulator.IsRequired());
+	REQUIRE(!accumulator.IsUnstable());
+
+	accumulator.RequestStabilityCheck();
+	hydroVars.SetFPostCollision(4, std::numeric_limits<distribn_t>::quiet_NaN());
+	accumulator.Accumulate<LATTICE>(2, hydroVars);
+	REQUIRE(accumulator.IsUnstable());
+      }
+
+      SECTION("ComparesWithRecordedVelocities") {
+	accumulator.RequestVelocityRecord();
+	for (site_t site = 0; site < 3; ++site)
+	{
+	  accumulator.Accumulate<LATTICE>(site, hydroVars);
+	}
+	accumulator.Reset();
+
+	// Compare and record again in the same sweep.
+	accumulator.RequestVelocityComparison();
+	accumulator.RequestVelocityRecord();
+	accumulator.Accumulate<LATTICE>(0, hydroVars);
+	hydroVars.momentum = util::Vector3D<distribn_t>(0.2, 0.06, 0.08);
+	accumulator.Accumulate<LATTICE>(1, hydroVars);
+	REQUIRE(accumulator.GetMaxVelocityChange() == Approx(0.05));
+	accumulator.Reset();
+
+	// Site 1 now has the new velocity recorded.
+	accumulator.RequestVelocityComparison();
+	accumulator.Accumulate<LATTICE>(1, hydroVars);
+	REQUIRE(accumulator.GetMaxVelocityChange() == Approx(0.0).margin(1e-15));
+	accumulator.Accumulate<LATTICE>(2, hydroVars);
+	REQUIRE(accumulator.GetMaxVelocityChange() == Approx(0.05));
+      }
+    }
+  }
+}
@@ -0,0 +1,131 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <catch2/catch.hpp>
+
+#include "lb/lb.hpp"
+#include "lb/StabilityTester.h"
+#include "lb/iolets/InOutLetCosine.h"
+#include "net/CollectiveBroadcast.h"
+#include "net/net.h"
+#include "reporting/Timers.h"
+#include "vis/Control.h"
+
+#include "tests/helpers/FourCubeBasedTestFixture.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    // StabilityTesterTests
+    //
+    // Runs the LBM on the four cube as the flow through it starts up
+    // and settles, and checks that the fused stability check finds
+    // the flow converged exactly when the separate pass over the
+    // lattice does, one step later.
+    TEST_CASE_METHOD(helpers::FourCubeBasedTestFixture, "StabilityTesterTests") {
+      using LATTICE = lb::lattices::D3Q15;
+      // On one process the phased broadcast never gets to its
+      // Effect, while the collective one applies each step's result
+      // on the next.
+      using TESTER = lb::StabilityTester<LATTICE, net::CollectiveBroadcast>;
+      constexpr auto NUMVECTORS = LATTICE::NUMVECTORS;
+
+      // With in-place streaming there is only the fused check, so
+      // nothing to compare it with.
+      if (geometry::StreamingPattern::InPlace)
+	return;
+
+      auto inlet = dynamic_cast<lb::iolets::InOutLetCosine*>(simConfig->GetInlets()[0]);
+      auto outlet = dynamic_cast<lb::iolets::InOutLetCosine*>(simConfig->GetOutlets()[0]);
+      inlet->SetDensityAmp(0.0);
+      inlet->SetDensityMean(1.0005);
+      inlet->SetNormal(util::Vector3D<Dimensionless>(0, 0, 1));
+      outlet->SetDensityAmp(0.0);
+      outlet->SetDensityMean(0.9995);
+      outlet->SetNormal(util::Vector3D<Dimensionless>(0, 0, -1));
+
+      net::Net net(Comms());
+      reporting::Timers timings(Comms());
+      lb::iolets::BoundaryValues inletValues(geometry::INLET_TYPE,
+					     latDat,
+					     simConfig->GetInlets(),
+					     simState.get(),
+					     Comms(),
+					     *unitConverter);
+      lb::iolets::BoundaryValues outletValues(geometry::OUTLET_TYPE,
+					      latDat,
+					      simConfig->GetOutlets(),
+					      simState.get(),
+					      Comms(),
+					      *unitConverter);
+
+      lb::LBM<LATTICE> lbm(simConfig, &net, latDat, simState.get(), timings, nullptr);
+      vis::Control visControl(lbm.GetLbmParams()->StressType,
+			      &net,
+			      simState.get(),
+			      lbm.GetPropertyCache(),
+			      latDat,
+			      timings[reporting::Timers::visualisation]);
+      lbm.Initialise(&visControl, &inletValues, &outletValues, unitConverter);
+
+      for (site_t site = 0; site < latDat->GetLocalFluidSiteCount(); ++site) {
+	distribn_t fEq[NUMVECTORS];
+	LATTICE::CalculateFeq(1.0, 0.0, 0.0, 0.0, fEq);
+	latDat->SetFOld<LATTICE>(site, fEq);
+      }
+
+      configuration::SimConfig::MonitoringConfig unfusedConfig;
+      unfusedConfig.doConvergenceCheck = true;
+      unfusedConfig.convergenceVariable = extraction::OutputField::Velocity;
+      unfusedConfig.convergenceReferenceValue = 0.01;
+      unfusedConfig.convergenceRelativeTolerance = 1e-5;
+      configuration::SimConfig::MonitoringConfig fusedConfig = unfusedConfig;
+      fusedConfig.fuseStabilityCheck = true;
+
+      // Each tester reports to its own state.
+      lb::SimulationState unfusedState(simState->GetTimeStepLength(), simState->GetTotalTimeSteps());
+      lb::SimulationState fusedState(simState->GetTimeStepLength(), simState->GetTotalTimeSteps());
+      TESTER unfused(latDat, &net, &unfusedState, lbm.GetPropertyCache(), timings, &unfusedConfig);
+      TESTER fused(latDat, &net, &fusedState, lbm.GetPropertyCache(), timings, &fusedConfig);
+
+      net::IteratedAction* actors[] = { &lbm, &unfused, &fused };
+      lb::Stability lastUnfusedStability = lb::UndefinedStability;
+      unsigned stepsStable = 0;
+      unsigned stepsConverged = 0;
+      for (unsigned step = 0; step < 2000; ++step) {
+	for (auto actor : actors) actor->RequestComms();
+	for (auto actor : actors) actor->PreSend();
+	for (auto actor : actors) actor->PreReceive();
+	net.Dispatch();
+	for (auto actor : actors) actor->PostReceive();
+	for (auto actor : actors) actor->EndIteration();
+	simState->Increment();
+	unfusedState.Increment();
+	fusedState.Increment();
+
+	// Each check's result is applied on the step after it was
+	// made, and the fused one compares the velocities from a step
+	// further back.
+	INFO("Step " << step);
+	if (step >= 2) {
+	  REQUIRE(fusedState.GetStability() == lastUnfusedStability);
+	}
+	lastUnfusedStability = unfusedState.GetStability();
+	REQUIRE(lastUnfusedStability != lb::Unstable);
+	if (lastUnfusedStability == lb::Stable) {
+	  ++stepsStable;
+	} else if (lastUnfusedStability == lb::StableAndConverged) {
+	  ++stepsConverged;
+	}
+      }
+
+      // The flow must have taken a while to settle, then settled, so
+      // both results have been compared.
+      REQUIRE(stepsStable > 10);
+      REQUIRE(stepsConverged > 10);
+    }
+  }
+}
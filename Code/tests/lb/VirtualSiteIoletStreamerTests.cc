@@ -23,7 +23,8 @@ namespace hemelb
 {
   namespace tests
   {
-    constexpr distribn_t allowedError = 1e-10;
+    // Distributions stored in single precision only keep about seven significant figures.
+    constexpr distribn_t allowedError = geometry::DistributionStorage::IsNative ? 1e-10 : 1e-5;
     static Approx apprx(double x) {
       return Approx(x).margin(allowedError);
     }
@@ -133,11 +134,15 @@ namespace hemelb
 	      LatticeVector pos(i, j, k);
 	      site_t siteIdx = latDat->GetContiguousSiteId(pos);
 	      //geometry::Site < geometry::LatticeData > site = latDat->GetSite(siteIdx);
-	      distribn_t* fOld = latDat->GetFNew(siteIdx * Lattice::NUMVECTORS);
+	      distribn_t fOld[Lattice::NUMVECTORS];
 	      LatticeDensity rho = GetDensity(pos);
 	      LatticeVelocity u = GetVelocity(pos);
 	      u *= rho;
 	      Lattice::CalculateFeq(rho, u.x, u.y, u.z, fOld);
+	      for (Direction direction = 0; direction < Lattice::NUMVECTORS; ++direction)
+		latDat->SetFNew(latDat->GetDistributionIndex<Lattice>(siteIdx, direction),
+				direction,
+				fOld[direction]);
 	    }
 	  }
 	}
@@ -294,6 +299,10 @@ namespace hemelb
       }
 
       SECTION("TestStreamerInitialisation") {
+	// Virtual site iolets are not available with in-place streaming.
+	if (geometry::StreamingPattern::InPlace)
+	  return;
+
 	initParams.boundaryObject = &outletBoundary;
 	// Set up the ranges to cover Mid 3 (pure outlet) and Mid 5 (outlet/wall)
 	initParams.siteRanges.resize(2);
@@ -341,6 +350,10 @@ namespace hemelb
       }
 
       SECTION("TestStep") {
+	// Virtual site iolets are not available with in-place streaming.
+	if (geometry::StreamingPattern::InPlace)
+	  return;
+
 	initParams.boundaryObject = &inletBoundary;
 	lb::streamers::VirtualSiteIolet<Collision> inletStreamer(initParams);
 	initParams.boundaryObject = &outletBoundary;
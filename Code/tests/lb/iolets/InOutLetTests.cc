@@ -6,9 +6,17 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <complex>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
 #include "lb/iolets/InOutLets.h"
+#include "lb/iolets/VelocityWeightsTable.h"
 #include "configuration/SimConfig.h"
 #include "resources/Resource.h"
+#include "util/Bessel.h"
 
 #include "tests/helpers/ApproxVector.h"
 #include "tests/helpers/FolderTestFixture.h"
@@ -240,6 +248,62 @@ namespace hemelb
 
       }
 
+      SECTION("TestWomersleyVelocityHarmonics") {
+	InOutLetWomersleyVelocity womersVel;
+	womersVel.SetRadius(10.0);
+	womersVel.SetPosition(LatticePosition(0, 0, 0));
+	womersVel.SetNormal(util::Vector3D<Dimensionless>(0, 0, 1));
+	womersVel.SetPressureGradientAmplitude(1e-5);
+	womersVel.SetPeriod(1000.0);
+	womersVel.SetWomersleyNumber(4.0);
+
+	// The direct evaluation of a single harmonic.
+	auto analytical = [&](unsigned multiple, double amplitude, double phase, double r, LatticeTimeStep t) {
+	  std::complex<double> i(0, 1);
+	  std::complex<double> arg = std::pow(i, 1.5) * 4.0 * std::sqrt(double(multiple));
+	  double omega = multiple * 2.0 * PI / 1000.0;
+	  return -std::real(amplitude / omega
+			    * (1.0 - util::BesselJ0ComplexArgument(arg * r / 10.0) / util::BesselJ0ComplexArgument(arg))
+			    * std::exp(i * (omega * double(t) + phase)));
+	};
+
+	for (double r : { 0.0, 3.3, 7.77, 9.9 })
+	  for (LatticeTimeStep t : { 0, 130, 620 })
+	  {
+	    LatticeVelocity velocity = womersVel.GetVelocity(LatticePosition(r, 0, 5), t);
+	    REQUIRE(velocity.z == Approx(analytical(1, 1e-5, 0.0, r, t)).margin(1e-9));
+	  }
+
+	// Harmonics add up.
+	womersVel.AddHarmonic(3, 4e-6, 0.5);
+	womersVel.AddHarmonic(2, 2e-6, -1.0);
+	REQUIRE(womersVel.GetHarmonics().size() == 2);
+	for (double r : { 0.0, 5.5, 8.25 })
+	  for (LatticeTimeStep t : { 0, 310, 777 })
+	  {
+	    LatticeVelocity velocity = womersVel.GetVelocity(LatticePosition(0, r, -2), t);
+	    double expected = analytical(1, 1e-5, 0.0, r, t) + analytical(3, 4e-6, 0.5, r, t)
+	      + analytical(2, 2e-6, -1.0, r, t);
+	    REQUIRE(velocity.z == Approx(expected).margin(1e-9));
+	  }
+
+	// A steady gradient gives Poiseuille flow, with the viscosity set
+	// by the Womersley number and period.
+	InOutLetWomersleyVelocity steady;
+	steady.SetRadius(10.0);
+	steady.SetPosition(LatticePosition(0, 0, 0));
+	steady.SetNormal(util::Vector3D<Dimensionless>(0, 0, 1));
+	steady.SetPressureGradientAmplitude(0.0);
+	steady.SetPeriod(1000.0);
+	steady.SetWomersleyNumber(4.0);
+	steady.AddHarmonic(0, 1e-6, 0.0);
+	double nu = 100.0 * (2.0 * PI / 1000.0) / 16.0;
+	for (LatticeTimeStep t : { 0, 310 })
+	{
+	  REQUIRE(steady.GetVelocity(LatticePosition(0, 5, 0), t).z == Approx(1e-6 * 75.0 / (4.0 * nu)));
+	}
+      }
+
       SECTION("TestFileVelocityConstruct") {
 	// We have to move to a tempdir, as the path specified in the
 	// xml file is a relative path
@@ -291,6 +355,53 @@ namespace hemelb
 
       }
 
+      SECTION("TestVelocityWeightsTable") {
+	CopyResourceToTempdir("velocity_inlet.txt.weights.txt");
+	MoveToTempdir();
+
+	std::unique_ptr<VelocityWeightsTable> text(VelocityWeightsTable::FromText("velocity_inlet.txt.weights.txt"));
+	REQUIRE(text->GetSize() == 16);
+
+	// Write the entries in reverse, so the binary writer has to sort them.
+	std::vector<VelocityWeightsTable::Entry> entries;
+	for (int x = 4; x > 0; --x)
+	  for (int y = 4; y > 0; --y)
+	  {
+	    VelocityWeightsTable::Entry entry = { x, y, 1, 0, *text->Find(x, y, 1) };
+	    entries.push_back(entry);
+	  }
+	VelocityWeightsTable::WriteBinary("velocity_inlet.txt.weights.bin", entries);
+	std::unique_ptr<VelocityWeightsTable> binary(VelocityWeightsTable::FromBinary("velocity_inlet.txt.weights.bin"));
+	REQUIRE(binary->GetSize() == 16);
+
+	for (const VelocityWeightsTable* table : { text.get(), binary.get() })
+	{
+	  REQUIRE(*table->Find(1, 1, 1) == Approx(0.1));
+	  REQUIRE(*table->Find(2, 2, 1) == Approx(1.0));
+	  REQUIRE(*table->Find(4, 3, 1) == Approx(0.3));
+	  REQUIRE(table->Find(2, 2, 2) == NULL);
+	  REQUIRE(table->Find(0, 0, 0) == NULL);
+	}
+
+	REQUIRE_THROWS_AS(VelocityWeightsTable::FromBinary("velocity_inlet.txt.weights.txt"), Exception);
+
+	// Swap the first two entries of the binary file, so it is no longer sorted.
+	std::string bytes;
+	{
+	  std::ifstream in("velocity_inlet.txt.weights.bin", std::ios::binary);
+	  bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	const std::size_t firstEntry = bytes.size() - 16 * sizeof(VelocityWeightsTable::Entry);
+	std::swap_ranges(bytes.begin() + firstEntry,
+			 bytes.begin() + firstEntry + sizeof(VelocityWeightsTable::Entry),
+			 bytes.begin() + firstEntry + sizeof(VelocityWeightsTable::Entry));
+	{
+	  std::ofstream out("velocity_inlet.txt.weights.bin", std::ios::binary);
+	  out.write(bytes.data(), bytes.size());
+	}
+	REQUIRE_THROWS_AS(VelocityWeightsTable::FromBinary("velocity_inlet.txt.weights.bin"), Exception);
+      }
+
       SECTION("TestIoletCoordinates") {
 	// unit converter - make physical and lattice units the same
 	util::UnitConverter units(1, 1, PhysicalPosition::Zero());
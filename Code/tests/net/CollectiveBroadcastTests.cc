@@ -0,0 +1,115 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <vector>
+#include <catch2/catch.hpp>
+
+#include "net/CollectiveBroadcast.h"
+#include "net/net.h"
+#include "lb/SimulationState.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    // Reduces the sum and maximum of a step counter.
+    class CountingBroadcast : public net::CollectiveBroadcast
+    {
+      public:
+	CountingBroadcast(net::Net* net, const lb::SimulationState* simState) :
+	  net::CollectiveBroadcast(net, simState, 10), step(0)
+	{
+	}
+
+	int step;
+	int upwards[2];
+	int downwards[2];
+	std::vector<int> effects;
+
+      protected:
+	Reduction GetReduction()
+	{
+	  Reduction reduction;
+	  reduction.upwards = upwards;
+	  reduction.downwards = downwards;
+	  reduction.count = 2;
+	  reduction.type = MPI_INT;
+	  reduction.function = &Combine;
+	  return reduction;
+	}
+
+	void PostSendToParent(unsigned long splayNumber)
+	{
+	  ++step;
+	  upwards[0] = step;
+	  upwards[1] = step;
+	}
+
+	void Effect()
+	{
+	  effects.push_back(downwards[0]);
+	}
+
+      private:
+	static void Combine(void* in, void* inOut, int* count, MPI_Datatype* type)
+	{
+	  const int* values = static_cast<const int*>(in);
+	  int* combined = static_cast<int*>(inOut);
+	  combined[0] += values[0];
+	  combined[1] = std::max(combined[1], values[1]);
+	}
+    };
+
+    TEST_CASE("CollectiveBroadcastTests") {
+      auto world = net::MpiCommunicator::World();
+      net::Net net(world);
+      const int size = world.Size();
+
+      SECTION("Reduces once per round trip of the tree it replaces") {
+	REQUIRE(net::CollectiveBroadcast::GetReductionPeriod(1, 10) == 1);
+	REQUIRE(net::CollectiveBroadcast::GetReductionPeriod(2, 10) == 2);
+	REQUIRE(net::CollectiveBroadcast::GetReductionPeriod(11, 10) == 2);
+	REQUIRE(net::CollectiveBroadcast::GetReductionPeriod(12, 10) == 4);
+	REQUIRE(net::CollectiveBroadcast::GetReductionPeriod(111, 10) == 4);
+	REQUIRE(net::CollectiveBroadcast::GetReductionPeriod(112, 10) == 6);
+      }
+
+      SECTION("Applies each reduction on the step after it") {
+	lb::SimulationState simState(0.0001, 100);
+	CountingBroadcast broadcast(&net, &simState);
+	const unsigned long period = net::CollectiveBroadcast::GetReductionPeriod(size, 10);
+
+	int reductions = 0;
+	for (int step = 0; step < 8; ++step)
+	{
+	  const bool reduces = broadcast.SendsToParentOnStep(step);
+	  REQUIRE(reduces == (step % period == 0));
+
+	  broadcast.RequestComms();
+	  broadcast.PreSend();
+	  broadcast.PreReceive();
+	  broadcast.PostReceive();
+	  broadcast.EndIteration();
+	  simState.Increment();
+
+	  // The local value is only worked out on the reducing steps...
+	  REQUIRE(broadcast.step == reductions + (reduces ? 1 : 0));
+	  // ...and each step sees the result of any reduction started on the one before.
+	  REQUIRE(broadcast.effects.size() == std::size_t(reductions));
+	  if (reductions > 0)
+	  {
+	    REQUIRE(broadcast.effects.back() == reductions * size);
+	    REQUIRE(broadcast.downwards[1] == reductions);
+	  }
+	  if (reduces)
+	  {
+	    ++reductions;
+	  }
+	}
+      }
+    }
+  }
+}
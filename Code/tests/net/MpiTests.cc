@@ -45,6 +45,67 @@ namespace hemelb
 	// Same ranks, but different context.
 	REQUIRE(commWorld2 != commWorld);
       }
+
+      SECTION("Sparse exchange only delivers what was sent") {
+	const int rank = commWorld.Rank();
+	const int size = commWorld.Size();
+	// Send our rank to the next rank round, and twice to ourself.
+	std::map<int, std::vector<int> > sends;
+	sends[(rank + 1) % size].push_back(rank);
+	sends[rank].push_back(rank);
+	sends[rank].push_back(rank);
+	// Nothing is sent for an empty entry.
+	sends[(rank + 2) % size];
+
+	std::map<int, std::vector<int> > received = commWorld.SparseExchange(sends, 30);
+
+	const int previous = (rank + size - 1) % size;
+	std::vector<int> expectedFromSelf(size == 1 ? 3 : 2, rank);
+	REQUIRE(received[rank] == expectedFromSelf);
+	if (size > 1)
+	{
+	  REQUIRE(received.size() == 2);
+	  REQUIRE(received[previous] == std::vector<int>(1, previous));
+	}
+	else
+	{
+	  REQUIRE(received.size() == 1);
+	}
+      }
+
+      SECTION("Variable gather concatenates in rank order") {
+	const int rank = commWorld.Rank();
+	const int size = commWorld.Size();
+	// Each rank contributes its rank, that many times.
+	std::vector<int> mine(rank, rank);
+	std::vector<int> gathered = commWorld.GatherV(mine, size - 1);
+
+	if (rank == size - 1)
+	{
+	  std::vector<int> expected;
+	  for (int source = 0; source < size; ++source)
+	  {
+	    expected.insert(expected.end(), source, source);
+	  }
+	  REQUIRE(gathered == expected);
+	}
+	else
+	{
+	  REQUIRE(gathered.empty());
+	}
+      }
+
+      SECTION("Splitting by shared memory keeps the rank order") {
+	MpiCommunicator node = commWorld.SplitShared();
+	REQUIRE(node.Size() <= commWorld.Size());
+	// Every rank on the node has a lower world rank than the ones after it.
+	std::vector<int> worldRanks = node.AllGather(commWorld.Rank());
+	REQUIRE(worldRanks[node.Rank()] == commWorld.Rank());
+	for (std::size_t i = 1; i < worldRanks.size(); ++i)
+	{
+	  REQUIRE(worldRanks[i - 1] < worldRanks[i]);
+	}
+      }
     }
   }
 }
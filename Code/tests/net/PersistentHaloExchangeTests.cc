@@ -0,0 +1,130 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <algorithm>
+#include <vector>
+#include <catch2/catch.hpp>
+
+#include "net/PersistentHaloExchange.h"
+#include "net/MpiCommunicator.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    TEST_CASE("PersistentHaloExchangeTests") {
+      auto world = net::MpiCommunicator::World();
+      const int rank = world.Rank();
+      const int size = world.Size();
+      const int next = (rank + 1) % size;
+      const int previous = (rank + size - 1) % size;
+
+      SECTION("Contiguous blocks") {
+	// Two values each way with the ranks either side (which are the same rank, or this one,
+	// on small runs).
+	net::PersistentHaloExchange exchange(world, { next, previous }, { 2, 2 }, MPI_INT);
+
+	// Alternate between two pairs of buffers, as LatticeData does.
+	std::vector<int> first(4), second(4);
+	for (int step = 0; step < 4; ++step)
+	{
+	  std::vector<int>& receive = step % 2 ? first : second;
+	  std::vector<int>& send = step % 2 ? second : first;
+	  std::fill(receive.begin(), receive.end(), -1);
+	  std::fill(send.begin(), send.end(), 100 * step + rank);
+
+	  exchange.StartReceives(receive.data());
+	  exchange.StartSends(send.data());
+	  exchange.Wait();
+
+	  const std::vector<int> expected = { 100 * step + next, 100 * step + next,
+					      100 * step + previous, 100 * step + previous };
+	  REQUIRE(receive == expected);
+	}
+      }
+
+      // Each value says which rank sent it, to which, and where it was in the block.
+      auto payload = [](int from, int to, int i) {
+	return 10000 * from + 100 * to + i;
+      };
+      // The block exchanged between two ranks is the same length each way, but each pair's
+      // is different.
+      auto count = [](int one, int other) {
+	return 1 + (one + other) % 3;
+      };
+
+      // Exchange with each of the neighbours, over two steps with alternating buffers.
+      auto exchangeWith = [&](const std::vector<proc_t>& neighbours) {
+	std::vector<int> counts;
+	for (proc_t neighbour: neighbours)
+	  counts.push_back(count(rank, neighbour));
+	net::PersistentHaloExchange exchange(world, neighbours, counts, MPI_INT);
+
+	std::vector<int> first, second;
+	for (int step = 0; step < 2; ++step)
+	{
+	  std::vector<int>& receive = step % 2 ? first : second;
+	  std::vector<int>& send = step % 2 ? second : first;
+	  std::vector<int> expected;
+	  send.clear();
+	  for (proc_t neighbour: neighbours)
+	  {
+	    for (int i = 0; i < count(rank, neighbour); ++i)
+	    {
+	      send.push_back(payload(rank, neighbour, i) + step);
+	      expected.push_back(payload(neighbour, rank, i) + step);
+	    }
+	  }
+	  receive.assign(send.size(), -1);
+
+	  exchange.StartReceives(receive.data());
+	  exchange.StartSends(send.data());
+	  exchange.Wait();
+	  REQUIRE(receive == expected);
+	}
+      };
+
+      SECTION("Different payloads for each neighbour") {
+	std::vector<proc_t> neighbours;
+	for (int other = size - 1; other >= 0; --other)
+	  if (other != rank)
+	    neighbours.push_back(other);
+	exchangeWith(neighbours);
+      }
+
+      SECTION("A rank with no neighbours") {
+	// Rank 0 (like a steering rank with no sites) exchanges with nobody, but still has
+	// to take part in creating the exchange.
+	std::vector<proc_t> neighbours;
+	if (rank != 0)
+	  for (int other = 1; other < size; ++other)
+	    if (other != rank)
+	      neighbours.push_back(other);
+	exchangeWith(neighbours);
+      }
+
+      SECTION("Scattered receives") {
+	// Receive the values from the next rank into 5 and 1, and from the previous into 0 and 3.
+	const int nextDisplacements[] = { 5, 1 };
+	const int previousDisplacements[] = { 0, 3 };
+	std::vector<MPI_Datatype> receiveTypes(2);
+	MPI_Type_create_indexed_block(2, 1, nextDisplacements, MPI_INT, &receiveTypes[0]);
+	MPI_Type_create_indexed_block(2, 1, previousDisplacements, MPI_INT, &receiveTypes[1]);
+	MPI_Type_commit(&receiveTypes[0]);
+	MPI_Type_commit(&receiveTypes[1]);
+	net::PersistentHaloExchange exchange(world, { next, previous }, { 2, 2 }, MPI_INT, receiveTypes);
+
+	std::vector<int> receive(6, -1);
+	const std::vector<int> send = { rank, rank + 1000, rank, rank + 1000 };
+	exchange.StartReceives(receive.data());
+	exchange.StartSends(send.data());
+	exchange.Wait();
+
+	const std::vector<int> expected = { previous, next + 1000, -1, previous + 1000, -1, next };
+	REQUIRE(receive == expected);
+      }
+    }
+  }
+}
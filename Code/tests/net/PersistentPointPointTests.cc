@@ -0,0 +1,71 @@
+// This file is part of HemeLB and is Copyright (C)
+// the HemeLB team and/or their institutions, as detailed in the
+// file AUTHORS. This software is provided under the terms of the
+// license in the file LICENSE.
+
+#include <vector>
+#include <catch2/catch.hpp>
+
+#include "net/mixins/mixins.h"
+
+namespace hemelb
+{
+  namespace tests
+  {
+    // A net that is a Net except for using persistent point-to-point comms.
+    class PersistentNet : public net::PersistentPointPoint,
+                          public net::InterfaceDelegationNet,
+                          public net::SeparatedAllToAll,
+                          public net::SeparatedGathers
+    {
+      public:
+	PersistentNet(const net::MpiCommunicator& communicator) :
+	  net::BaseNet(communicator), net::StoringNet(communicator),
+	  net::PersistentPointPoint(communicator), net::InterfaceDelegationNet(communicator),
+	  net::SeparatedAllToAll(communicator), net::SeparatedGathers(communicator)
+	{
+	}
+    };
+
+    TEST_CASE("PersistentPointPointTests") {
+      auto world = net::MpiCommunicator::World();
+      const int rank = world.Rank();
+      const int size = world.Size();
+      const int next = (rank + 1) % size;
+      const int previous = (rank + size - 1) % size;
+      PersistentNet net(world);
+
+      // Send to the next rank round and receive from the previous, alternating between two
+      // pairs of buffers, with another exchange on every third step. So patterns are seen
+      // for the first time, replayed, and interleaved.
+      std::vector<int> first(2), second(2);
+      int extraSend, extraReceive;
+      for (int step = 0; step < 9; ++step)
+      {
+	std::vector<int>& send = step % 2 ? first : second;
+	std::vector<int>& receive = step % 2 ? second : first;
+	send = { step, rank };
+	receive = { -1, -1 };
+	net.RequestSend(send.data(), 2, next);
+	net.RequestReceive(receive.data(), 2, previous);
+
+	const bool extra = step % 3 == 2;
+	if (extra)
+	{
+	  extraSend = 1000 * step + rank;
+	  extraReceive = -1;
+	  net.RequestSendR(extraSend, previous);
+	  net.RequestReceiveR(extraReceive, next);
+	}
+
+	net.Dispatch();
+
+	REQUIRE(receive == std::vector<int>({ step, previous }));
+	if (extra)
+	{
+	  REQUIRE(extraReceive == 1000 * step + next);
+	}
+      }
+    }
+  }
+}
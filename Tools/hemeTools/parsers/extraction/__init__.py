@@ -6,6 +6,7 @@
 
 import os.path
 import xdrlib
+import zlib
 import numpy as np
 
 from .. import HemeLbMagicNumber
@@ -13,6 +14,11 @@ from .. import HemeLbMagicNumber
 ExtractionMagicNumber = 0x78747204
 MainHeaderLength = 60
 TimeStepDataLength = 8
+GeometryHeaderLength = 4
+LittleEndianFieldsFlag = 0x1
+CompressedFieldsFlag = 0x2
+OffsetMagicNumber = 0x6f666604
+OffsetHeaderLength = 16
 
 class FieldSpec(object):
     """Represent the data type of a single record in both XDR format and
@@ -30,9 +36,11 @@ class FieldSpec(object):
          
     """
 
-    def __init__(self, memspec):
+    def __init__(self, memspec, filespec=None):
         # name, XDR dtype, in-memory dtype, length, offset
-        self._filespec = [('grid', '>i4', np.uint32, (3,), 0)]
+        if filespec is None:
+            filespec = [('grid', '>i4', np.uint32, (3,), 0)]
+        self._filespec = filespec
         
         self._memspec = memspec
         return
@@ -72,6 +80,8 @@ class FieldSpec(object):
     pass
 
 class ExtractedPropertyV3Parser(object):
+    compressed = False
+
     def __init__(self, fieldCount, siteCount):
         self._fieldCount = fieldCount
         self._siteCount = siteCount
@@ -98,7 +108,12 @@ class ExtractedPropertyV3Parser(object):
     def GetRecordLength(self):
         return self._fieldSpec.GetRecordLength()
 
+    def ParseGeometry(self, filename, offset):
+        return 0
+
 class ExtractedPropertyV4Parser(object):
+    compressed = False
+
     def __init__(self, fieldCount, siteCount):
         self._fieldCount = fieldCount
         self._siteCount = siteCount
@@ -125,6 +140,9 @@ class ExtractedPropertyV4Parser(object):
             continue
         return self._fieldSpec
 
+    def ParseGeometry(self, filename, offset):
+        return 0
+
     def _recursiveAdd(self, data, operand):
         try:
             return [self._recursiveAdd(datum, operand) for datum in data]
@@ -132,11 +150,55 @@ class ExtractedPropertyV4Parser(object):
             return data + operand
         pass
 
+class ExtractedPropertyV5Parser(ExtractedPropertyV4Parser):
+    """The geometry-once variant of version 4: the grid coordinates are stored
+    once, after the field header, and each timestep only has the fields.
+    """
+    def ParseFieldHeader(self, decoder):
+        # The grid is in memory, but not in the timestep records.
+        self._fieldSpec = FieldSpec([('id', None, np.uint64, 1, None),
+                                     ('position', None, np.float32, (3,), None),
+                                     ('grid', None, np.uint32, (3,), None)],
+                                    [])
+        self._dataOffset = []
+
+        for iField in xrange(self._fieldCount):
+            name = decoder.unpack_string()
+            length = decoder.unpack_uint()
+            self._dataOffset.append(decoder.unpack_double())
+            self._fieldSpec.Append(name, length, '>f4', np.float32)
+            continue
+        return self._fieldSpec
+
+    def ParseGeometry(self, filename, offset):
+        """Read the geometry header and coordinates starting at offset, and
+        return their length.
+        """
+        with open(filename, 'rb') as f:
+            f.seek(offset)
+            flags = xdrlib.Unpacker(f.read(GeometryHeaderLength)).unpack_uint()
+
+        self.compressed = bool(flags & CompressedFieldsFlag)
+        if flags & LittleEndianFieldsFlag:
+            # Swap the field dtypes over to the byte order they were written in.
+            self._fieldSpec = FieldSpec(self._fieldSpec._memspec,
+                                        [(name, '<f4', memType, length, fieldOffset)
+                                         for name, xdrType, memType, length, fieldOffset in self._fieldSpec])
+
+        self._grid = np.memmap(filename, dtype=np.dtype(('>u4', (3,))), mode='r',
+                               offset=offset + GeometryHeaderLength, shape=(self._siteCount,))
+        return GeometryHeaderLength + self._grid.nbytes
+
+    def parse(self, memoryMappedData):
+        result = ExtractedPropertyV4Parser.parse(self, memoryMappedData)
+        result.grid = self._grid
+        return result
+
 class ExtractedProperty(object):
     """Represent the contents of a HemeLB property extraction file.
     
     """
-    HandledVersions = [3,4]
+    HandledVersions = [3,4,5]
 
     def __init__(self, filename):
         """Read the file's headers and determine how many times and which times
@@ -182,6 +244,8 @@ class ExtractedProperty(object):
             self.parser = ExtractedPropertyV3Parser(self.fieldCount, self.siteCount)
         elif version == 4:
             self.parser = ExtractedPropertyV4Parser(self.fieldCount, self.siteCount)
+        elif version == 5:
+            self.parser = ExtractedPropertyV5Parser(self.fieldCount, self.siteCount)
         return
 
     def _ReadFieldHeader(self):
@@ -200,6 +264,12 @@ class ExtractedProperty(object):
         decoder = xdrlib.Unpacker(fieldHeader)
 
         self._fieldSpec = self.parser.ParseFieldHeader(decoder)
+        self._totalHeaderLength = MainHeaderLength + self._fieldHeaderLength
+
+        # The geometry-once format has the coordinates next.
+        self._totalHeaderLength += self.parser.ParseGeometry(self.filename,
+                                                             self._totalHeaderLength)
+        self._fieldSpec = self.parser._fieldSpec
 
         self._rowLength = self._fieldSpec.GetRecordLength()
         self._recordLength = TimeStepDataLength + self._rowLength * self.siteCount
@@ -210,8 +280,10 @@ class ExtractedProperty(object):
         """Examine the file to find out how many time steps worth of data and
         which times are contained within it.
         """
+        if self.parser.compressed:
+            return self._DetermineCompressedTimes()
+
         filesize = os.path.getsize(self.filename)
-        self._totalHeaderLength = MainHeaderLength + self._fieldHeaderLength
         bodysize = filesize - self._totalHeaderLength
         assert bodysize % self._recordLength == 0, \
             "Extraction file appears to have partial record(s), residual %s / %s , bodysize %s"%(bodysize % self._recordLength,self._recordLength,bodysize)
@@ -231,6 +303,34 @@ class ExtractedProperty(object):
 
         return
 
+    def _DetermineCompressedTimes(self):
+        """Compressed timesteps vary in length, so read where each rank's chunk
+        of each one is from the offset file.
+        """
+        offsetFilename = os.path.splitext(self.filename)[0] + '.off'
+        with open(offsetFilename, 'rb') as f:
+            decoder = xdrlib.Unpacker(f.read(OffsetHeaderLength))
+            assert decoder.unpack_uint() == HemeLbMagicNumber, "Incorrect HemeLB magic number"
+            assert decoder.unpack_uint() == OffsetMagicNumber, "Incorrect offset magic number"
+            assert decoder.unpack_uint() == 2, "Compressed extraction needs a per-timestep offset file"
+            nRanks = decoder.unpack_uint()
+            offsets = np.fromfile(f, dtype='>u8')
+
+        assert offsets.size % (nRanks + 1) == 0, \
+            "Offset file '{}' appears to have partial record(s)".format(offsetFilename)
+        self._chunkOffsets = offsets.reshape((-1, nRanks + 1)).astype(np.int64)
+
+        times = np.zeros(len(self._chunkOffsets), dtype=int)
+        for iT, row in enumerate(self._chunkOffsets):
+            self._file.seek(row[0])
+            times[iT] = xdrlib.Unpacker(self._file.read(TimeStepDataLength)).unpack_uhyper()
+            continue
+
+        assert np.alltrue(np.argsort(times) == np.arange(len(times))), \
+            "Times in extraction file are not monotonically increasing!"
+        self.times = times
+        return
+
     def GetByIndex(self, idx):
         """Get the fields by time index. 
         """
@@ -267,12 +367,34 @@ class ExtractedProperty(object):
         return np.memmap(self.filename, dtype=self._fieldSpec.GetXdr(),
                          mode='r', offset=start, shape=(self.siteCount,))
 
+    def _Decompress(self, idx):
+        """Read and inflate each rank's chunk of a compressed timestep, into
+        an array like _MemMap's.
+        """
+        row = self._chunkOffsets[idx]
+        with open(self.filename, 'rb') as f:
+            f.seek(row[0])
+            data = f.read(row[-1] - row[0])
+
+        values = []
+        for rank in xrange(len(row) - 1):
+            # The first rank's chunk starts with the timestep.
+            start = row[rank] - row[0] + (TimeStepDataLength if rank == 0 else 0)
+            stop = row[rank + 1] - row[0]
+            if stop > start:
+                values.append(zlib.decompress(data[start:stop]))
+            continue
+        return np.frombuffer(b''.join(values), dtype=self._fieldSpec.GetXdr())
+
     def _LoadByIndex(self, idx):
         """Create a numpy record array with a single timestep of data.
         
         Fields are as specified in the file with the addition of 
         """
-        mapped = self._MemMap(idx)
+        if self.parser.compressed:
+            mapped = self._Decompress(idx)
+        else:
+            mapped = self._MemMap(idx)
 
         answer = self.parser.parse(mapped)
         
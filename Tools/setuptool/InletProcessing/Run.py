@@ -5,6 +5,7 @@
 # license in the file LICENSE.
 
 import os.path
+import struct
 import numpy as np
 import vtk
 
@@ -149,11 +150,31 @@ def CreateInletWeightsFile(fname):
 
     vels = vels * (1.0 / vels.max()) 
 
+    weights = {}
     f = open("%s.weights.txt" % (fname[:-4]),'w')
     for i in xrange(0, len(vels)):
         # take out faulty data points at the origin or with -1,-1,-1 coordinates.
         if sum(coords[i])>0.5:
-            f.write("%i %i %i %f\n" % (int(coords[i][0]), int(coords[i][1]), int(coords[i][2]), vels[i]))
+            f.write("%i %i %i %.17g\n" % (int(coords[i][0]), int(coords[i][1]), int(coords[i][2]), vels[i]))
+            weights[(int(coords[i][0]), int(coords[i][1]), int(coords[i][2]))] = vels[i]
+    f.close()
+
+    CreateBinaryWeightsFile("%s.weights.bin" % (fname[:-4]), weights)
+
+def CreateBinaryWeightsFile(fname, weights):
+    """ Write the weights, a dictionary from lattice coordinates to weight,
+    in the binary form that HemeLB memory-maps (see
+    lb/iolets/VelocityWeightsTable.h): an 8 byte magic number, the number
+    of entries as a uint64 and then the entries sorted by coordinate, each
+    three int32 coordinates, 4 bytes of padding and the float64 weight.
+    All values are in native byte order.
+    """
+    f = open(fname, 'wb')
+    f.write(b'HLBVWT1\0')
+    f.write(struct.pack('=Q', len(weights)))
+    for key in sorted(weights):
+        f.write(struct.pack('=iiiid', key[0], key[1], key[2], 0, weights[key]))
+    f.close()
 
 if __name__ == "__main__":
     import sys